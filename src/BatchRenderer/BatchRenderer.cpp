@@ -0,0 +1,603 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * BatchRenderer.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#include "BatchRenderer.h"
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+#include <algorithm>
+#include <map>
+#include <set>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// Externals
+
+// Other libraries
+#include "animated.h"
+#include "Attachment.h"
+#include "ExporterPlugin.h"
+#include "Game.h"
+#include "GameFile.h"
+#include "OutfitLoader.h"
+#include "PluginManager.h"
+#include "RaceInfos.h"
+#include "video.h"
+#include "WoWItem.h"
+#include "WoWModel.h"
+
+#include "logger/Logger.h"
+
+// Current library
+#include "OffscreenContext.h"
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+// Beginning of implementation
+//====================================================================
+
+// Constructors
+//--------------------------------------------------------------------
+BatchRenderer::BatchRenderer(OffscreenContext & context)
+  : m_context(context), m_root(new Attachment(NULL, NULL, -1, -1)),
+    m_fbo(0), m_colorBuffer(0), m_depthBuffer(0), m_fboWidth(0), m_fboHeight(0)
+{
+}
+
+// Destructor
+//--------------------------------------------------------------------
+BatchRenderer::~BatchRenderer()
+{
+  clear();
+  delete m_root;
+
+  if (m_fbo)
+  {
+    glDeleteFramebuffersEXT(1, &m_fbo);
+    glDeleteRenderbuffersEXT(1, &m_colorBuffer);
+    glDeleteRenderbuffersEXT(1, &m_depthBuffer);
+  }
+}
+
+// Public methods
+//--------------------------------------------------------------------
+bool BatchRenderer::loadJobs(const QString & file, int worker, int nbWorkers)
+{
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly))
+  {
+    LOG_ERROR << "Cannot open job list" << file;
+    return false;
+  }
+
+  QJsonParseError error;
+  QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &error);
+  if (doc.isNull())
+  {
+    LOG_ERROR << "Invalid job list" << file << ":" << error.errorString();
+    return false;
+  }
+
+  QJsonObject defaults;
+  QJsonArray jobs;
+
+  if (doc.isArray())
+  {
+    jobs = doc.array();
+  }
+  else
+  {
+    defaults = doc.object().value("defaults").toObject();
+    jobs = doc.object().value("jobs").toArray();
+  }
+
+  for (int i = 0; i < jobs.size(); i++)
+  {
+    if (i % nbWorkers != worker)
+      continue;
+
+    QJsonObject values = defaults;
+    QJsonObject job = jobs[i].toObject();
+    for (auto it = job.begin(); it != job.end(); ++it)
+      values.insert(it.key(), it.value());
+
+    m_jobs.push_back(readJob(values, i));
+  }
+
+  LOG_INFO << "Worker" << worker << "/" << nbWorkers << ":" << m_jobs.size() << "jobs out of" << jobs.size();
+
+  return true;
+}
+
+int BatchRenderer::run()
+{
+  int nbFailed = 0;
+
+  for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it)
+  {
+    if (!process(*it))
+    {
+      LOG_ERROR << "Job" << it->index << "failed (" << it->output << ")";
+      nbFailed++;
+    }
+    else
+    {
+      LOG_INFO << "Job" << it->index << "done (" << it->output << ")";
+    }
+  }
+
+  clear();
+
+  return nbFailed;
+}
+
+// Protected methods
+//--------------------------------------------------------------------
+
+// Private methods
+//--------------------------------------------------------------------
+BatchRenderer::Job BatchRenderer::readJob(const QJsonObject & values, int index)
+{
+  Job job;
+  job.index = index;
+
+  QJsonValue model = values.value("model");
+  job.fileId = model.isDouble() ? model.toInt() : 0;
+  job.file = model.toString();
+  job.displayId = values.value("displayId").toInt();
+
+  QJsonValue anim = values.value("animation");
+  job.animation = anim.isDouble() ? QString::number(anim.toInt()) : anim.toString();
+  job.time = values.value("time").toInt();
+
+  QJsonObject camera = values.value("camera").toObject();
+  job.yaw = camera.value("yaw").toDouble();
+  job.pitch = camera.value("pitch").toDouble();
+  job.distance = camera.value("distance").toDouble();
+
+  job.width = values.value("width").toInt(512);
+  job.height = values.value("height").toInt(512);
+
+  QJsonArray bg = values.value("background").toArray();
+  for (int i = 0; i < 4; i++)
+    job.background[i] = (i < bg.size()) ? bg[i].toDouble() : 0.0f;
+
+  job.output = values.value("output").toString();
+
+  return job;
+}
+
+bool BatchRenderer::process(const Job & job)
+{
+  if (job.output.isEmpty())
+  {
+    LOG_ERROR << "No output defined";
+    return false;
+  }
+
+  if (!loadModel(job))
+    return false;
+
+  setAnimation(job);
+
+  QDir().mkpath(QFileInfo(job.output).absolutePath());
+
+  // image formats are rendered, other ones are delegated to exporter plugins
+  QString ext = QFileInfo(job.output).suffix().toLower();
+  if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp" || ext == "tif" || ext == "tiff")
+    return render(job);
+
+  return exportModel(job);
+}
+
+bool BatchRenderer::loadModel(const Job & job)
+{
+  clear();
+
+  if (job.displayId != 0)
+    return loadCreatureDisplay(job.displayId);
+
+  GameFile * file = job.fileId ? GAMEDIRECTORY.getFile(job.fileId) : GAMEDIRECTORY.getFile(job.file);
+  if (!file)
+  {
+    LOG_ERROR << "Model file not found" << (job.fileId ? QString::number(job.fileId) : job.file);
+    return false;
+  }
+
+  bool isChar = (file->fullname().startsWith("char", Qt::CaseInsensitive) ||
+                 file->fullname().startsWith("alternate\\char", Qt::CaseInsensitive));
+
+  return loadFile(file, isChar) != 0;
+}
+
+// same logic as ModelViewer::LoadNPC, starting from display info instead of creature
+bool BatchRenderer::loadCreatureDisplay(int displayId)
+{
+  QString query = QString("SELECT CreatureModelData.FileID, CreatureDisplayInfo.Texture1, "
+                          "CreatureDisplayInfo.Texture2, CreatureDisplayInfo.Texture3, "
+                          "CreatureDisplayInfo.ExtendedDisplayInfoID FROM CreatureDisplayInfo "
+                          "LEFT JOIN CreatureModelData ON CreatureDisplayInfo.modelID = CreatureModelData.ID "
+                          "WHERE CreatureDisplayInfo.ID = %1;").arg(displayId);
+
+  sqlResult r = GAMEDATABASE.sqlQuery(query);
+
+  if (!r.valid || r.empty())
+  {
+    LOG_ERROR << "Unknown display id" << displayId;
+    return false;
+  }
+
+  int extraId = r.values[0][4].toInt();
+
+  // simple creature : model + skin
+  if (extraId == 0)
+  {
+    WoWModel * m = loadFile(GAMEDIRECTORY.getFile(r.values[0][0].toInt()), false);
+    if (!m)
+      return false;
+
+    m->modelType = MT_NORMAL;
+
+    for (int i = 0; i < 3; i++)
+    {
+      if (!r.values[0][i + 1].isEmpty() && r.values[0][i + 1] != "0")
+        m->updateTextureList(GAMEDIRECTORY.getFile(r.values[0][i + 1].toInt()), TEXTURE_GAMEOBJECT1 + i);
+    }
+
+    // geosets enabled only for this display id (see AnimControl::UpdateCreatureModel)
+    std::set<GeosetNum> cgd;
+    if (GAMEDIRECTORY.version().contains("7.3"))
+    {
+      r = GAMEDATABASE.sqlQuery(QString("SELECT CreatureGeosetData FROM CreatureDisplayInfo WHERE ID = %1").arg(displayId));
+      int data = (r.valid && !r.empty()) ? r.values[0][0].toInt() : 0;
+      for (int i = 0; i < 8; i++)
+      {
+        int geoid = (data >> (i * 4)) & 0x0F;
+        if (geoid > 0)
+          cgd.insert(100 * (i + 1) + geoid);
+      }
+    }
+    else
+    {
+      r = GAMEDATABASE.sqlQuery(QString("SELECT GeosetType, GeosetID FROM CreatureDisplayInfoGeosetData "
+                                        "WHERE DisplayID = %1").arg(displayId));
+      for (size_t i = 0; r.valid && i < r.values.size(); i++)
+      {
+        int geoid = r.values[i][1].toInt();
+        if (geoid > 0)
+          cgd.insert(100 * (r.values[i][0].toInt() + 1) + geoid);
+      }
+    }
+    m->setCreatureGeosetData(cgd);
+
+    return true;
+  }
+
+  // character like creature : customizations + equipment
+  WoWModel * m = loadFile(GAMEDIRECTORY.getFile(RaceInfos::getHDModelForFileID(r.values[0][0].toInt())), true);
+  if (!m)
+    return false;
+
+  query = QString("SELECT Skin, Face, HairStyle, HairColor, FacialHair FROM CreatureDisplayInfoExtra WHERE ID = %1").arg(extraId);
+  r = GAMEDATABASE.sqlQuery(query);
+
+  if (r.valid && !r.empty())
+  {
+    m->cd.set(CharDetails::SKIN_COLOR, r.values[0][0].toInt());
+    m->cd.set(CharDetails::FACE, r.values[0][1].toInt());
+    m->cd.set(CharDetails::FACIAL_CUSTOMIZATION_COLOR, r.values[0][2].toInt());
+    m->cd.set(CharDetails::FACIAL_CUSTOMIZATION_STYLE, r.values[0][3].toInt());
+    m->cd.set(CharDetails::ADDITIONAL_FACIAL_CUSTOMIZATION, r.values[0][4].toInt());
+  }
+
+  query = QString("SELECT ItemDisplayInfoID, ItemType FROM NpcModelItemSlotDisplayInfo WHERE CreatureDisplayInfoExtraID = %1").arg(extraId);
+  r = GAMEDATABASE.sqlQuery(query);
+
+  if (r.valid && !r.empty())
+  {
+    static std::map<int, CharSlots> ItemTypeToInternal = { { 0, CS_HEAD }, { 1, CS_SHOULDER }, { 2, CS_SHIRT }, { 3, CS_CHEST }, { 4, CS_BELT }, { 5, CS_PANTS },
+    { 6, CS_BOOTS }, { 7, CS_BRACERS }, { 8, CS_GLOVES }, { 9, CS_TABARD }, { 10, CS_CAPE } };
+    OutfitLoader outfit(m);
+    for (size_t i = 0; i < r.values.size(); i++)
+      outfit.setDisplay(ItemTypeToInternal[r.values[i][1].toInt()], r.values[i][0].toInt());
+    outfit.apply();
+  }
+
+  m->cd.isNPC = true;
+  m->refresh();
+
+  return true;
+}
+
+WoWModel * BatchRenderer::loadFile(GameFile * file, bool isChar)
+{
+  if (!file)
+  {
+    LOG_ERROR << "Model file not found";
+    return 0;
+  }
+
+  WoWModel * m = new WoWModel(file, true);
+  setModel(m);
+
+  if (!m->ok)
+  {
+    LOG_ERROR << "Failed to load the model" << file->fullname();
+    setModel(NULL);
+    return 0;
+  }
+
+  m_root->addChild(m, 0, -1);
+
+  // children to manage equipped items, as in ModelViewer::LoadModel
+  if (isChar)
+  {
+    static const CharSlots slots[] = { CS_SHIRT, CS_HEAD, CS_SHOULDER, CS_PANTS, CS_BOOTS, CS_CHEST, CS_TABARD,
+                                       CS_BELT, CS_BRACERS, CS_GLOVES, CS_HAND_RIGHT, CS_HAND_LEFT, CS_CAPE, CS_QUIVER };
+    for (size_t i = 0; i < sizeof(slots) / sizeof(slots[0]); i++)
+      m->addChild(new WoWItem(slots[i]));
+
+    m->modelType = MT_CHAR;
+    m->cd.reset(m);
+  }
+  else
+  {
+    m->addChild(new WoWItem(CS_HAND_RIGHT));
+    m->addChild(new WoWItem(CS_HAND_LEFT));
+  }
+
+  return m;
+}
+
+void BatchRenderer::setAnimation(const Job & job)
+{
+  WoWModel * m = const_cast<WoWModel *>(model());
+
+  if (!m || !m->animated || !m->animManager || m->anims.empty())
+    return;
+
+  // animation is given by id or by name, "Stand" being the default one
+  bool isId = false;
+  int animId = job.animation.toInt(&isId);
+  QString animName = job.animation.isEmpty() ? QString("Stand") : job.animation;
+
+  if (!isId)
+  {
+    animId = -1;
+    std::map<int, std::wstring> animsMap = m->getAnimsMap();
+    for (auto it = animsMap.begin(); it != animsMap.end(); ++it)
+    {
+      if (QString::fromStdWString(it->second).compare(animName, Qt::CaseInsensitive) == 0)
+      {
+        animId = it->first;
+        break;
+      }
+    }
+  }
+
+  size_t anim = 0;
+  for (size_t i = 0; i < m->anims.size(); i++)
+  {
+    if ((int)m->anims[i].animID == animId)
+    {
+      anim = i;
+      break;
+    }
+  }
+
+  m->currentAnim = anim;
+  m->animManager->SetAnim(0, anim, 0);
+  m->animManager->Play();
+
+  // advance by small steps so that particles are emitted as they would be on screen
+  static const int step = 33;
+  for (int t = 0; t < job.time; t += step)
+  {
+    int dt = std::min(step, job.time - t);
+    globalTime += dt;
+    m_root->tick(dt);
+  }
+}
+
+bool BatchRenderer::render(const Job & job)
+{
+  int width = job.width;
+  int height = job.height;
+
+  if (video.supportFBO)
+  {
+    if (!setupFramebuffer(width, height))
+      return false;
+  }
+  else if (m_context.hasDefaultFramebuffer())
+  {
+    width = std::min(width, m_context.width());
+    height = std::min(height, m_context.height());
+  }
+  else
+  {
+    LOG_ERROR << "Frame buffer objects are needed to render with" << m_context.backendName();
+    return false;
+  }
+
+  WoWModel * m = const_cast<WoWModel *>(model());
+
+  video.InitGL();
+  video.ResizeGLScene(width, height);
+
+  glEnable(GL_TEXTURE_2D);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LEQUAL);
+  glDepthMask(GL_TRUE);
+  glAlphaFunc(GL_GEQUAL, 0.8f);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDisable(GL_BLEND);
+  glDisable(GL_ALPHA_TEST);
+
+  glClearColor(job.background[0], job.background[1], job.background[2], job.background[3]);
+  glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+
+  // one white light coming from camera, plus ambient
+  GLfloat ambient[] = { 0.4f, 0.4f, 0.4f, 1.0f };
+  GLfloat diffuse[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  GLfloat position[] = { 0.0f, 1.0f, 1.0f, 0.0f };
+  glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
+  glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+  glLightfv(GL_LIGHT0, GL_POSITION, position);
+  glEnable(GL_LIGHT0);
+  glEnable(GL_LIGHTING);
+
+  // same framing as ModelCanvas::ResetView when no distance is given
+  float distance = job.distance;
+  if (distance <= 0.0f)
+    distance = std::max(3.0f, std::min(64.0f, m->rad * 1.6f));
+  float targetHeight = std::max(-50.0f, std::min(50.0f, m->rad * 0.5f));
+
+  glTranslatef(0.0f, -targetHeight, -distance);
+  glRotatef(job.pitch, 1.0f, 0.0f, 0.0f);
+  glRotatef(job.yaw - 90.0f, 0.0f, 1.0f, 0.0f);
+
+  m_root->draw(this);
+
+  // particles are drawn afterwards, as in ModelCanvas::RenderObjects
+  glDisable(GL_LIGHTING);
+  glDepthMask(GL_FALSE);
+  glEnable(GL_BLEND);
+  m_root->drawParticles();
+  glDisable(GL_BLEND);
+  glDepthMask(GL_TRUE);
+
+  glFinish();
+
+  // read back, bottom up BGRA matches QImage ARGB32 layout once flipped
+  QImage image(width, height, QImage::Format_ARGB32);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  for (int y = 0; y < height; y++)
+    glReadPixels(0, height - 1 - y, width, 1, GL_BGRA, GL_UNSIGNED_BYTE, image.scanLine(y));
+
+  if (!image.save(job.output))
+  {
+    LOG_ERROR << "Cannot write" << job.output;
+    return false;
+  }
+
+  return true;
+}
+
+bool BatchRenderer::exportModel(const Job & job)
+{
+  QString ext = QFileInfo(job.output).suffix().toLower();
+  WoWModel * m = const_cast<WoWModel *>(model());
+
+  // exporters are matched on the extension of their save filter ("OBJ files (*.obj)|*.obj")
+  for (PluginManager::iterator it = PLUGINMANAGER.begin(); it != PLUGINMANAGER.end(); ++it)
+  {
+    ExporterPlugin * plugin = dynamic_cast<ExporterPlugin *>(*it);
+
+    if (!plugin || !QString::fromStdWString(plugin->fileSaveFilter()).endsWith("*." + ext, Qt::CaseInsensitive))
+      continue;
+
+    if (plugin->canExportAnimation())
+    {
+      std::vector<int> animsToExport;
+      if (job.animation.isEmpty())
+      {
+        for (size_t i = 0; i < m->anims.size(); i++)
+          animsToExport.push_back(m->anims[i].Index);
+      }
+      else if (m->currentAnim < m->anims.size())
+      {
+        animsToExport.push_back(m->anims[m->currentAnim].Index);
+      }
+      plugin->setAnimationsToExport(animsToExport);
+    }
+
+    return plugin->exportModel(m, QDir::toNativeSeparators(job.output).toStdWString());
+  }
+
+  LOG_ERROR << "No exporter plugin found for" << ext << "files";
+  return false;
+}
+
+bool BatchRenderer::setupFramebuffer(int width, int height)
+{
+  if (m_fbo && width == m_fboWidth && height == m_fboHeight)
+  {
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+    return true;
+  }
+
+  if (!m_fbo)
+  {
+    glGenFramebuffersEXT(1, &m_fbo);
+    glGenRenderbuffersEXT(1, &m_colorBuffer);
+    glGenRenderbuffersEXT(1, &m_depthBuffer);
+  }
+
+  glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+
+  glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, m_colorBuffer);
+  glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, width, height);
+  glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, m_colorBuffer);
+
+  glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, m_depthBuffer);
+  glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, width, height);
+  glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, m_depthBuffer);
+
+  glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+  if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) != GL_FRAMEBUFFER_COMPLETE_EXT)
+  {
+    LOG_ERROR << "Incomplete frame buffer" << width << "x" << height;
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+    m_fboWidth = m_fboHeight = 0;
+    return false;
+  }
+
+  m_fboWidth = width;
+  m_fboHeight = height;
+
+  // with a surfaceless context there is no default draw/read buffer to fall back to
+  glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+  glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+
+  return true;
+}
+
+void BatchRenderer::clear()
+{
+  m_root->delChildren();
+  setModel(NULL);
+}
@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * BatchRenderer.h
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#ifndef _BATCHRENDERER_H_
+#define _BATCHRENDERER_H_
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+#include <vector>
+
+// Qt
+#include <QString>
+
+// Externals
+
+// Other libraries
+#include "BaseCanvas.h"
+#include "OpenGLHeaders.h"
+
+class Attachment;
+class QJsonObject;
+
+// Current library
+class OffscreenContext;
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+
+// Class Declaration
+//--------------------------------------------------------------------
+
+// Renders or exports models described in a json job list, without any user interface.
+// Job list is either an array of jobs, or an object { "defaults" : {...}, "jobs" : [...] }
+// where defaults apply to every job. A job is :
+//  {
+//    "model" : 123456 or "creature/bear/bear.m2",  // file data id or file name
+//    "displayId" : 1234,                            // or CreatureDisplayInfo id (NPC)
+//    "animation" : "Stand" or 0,                    // animation name or id (optional)
+//    "time" : 500,                                  // animation time in ms (optional)
+//    "camera" : { "yaw" : 0, "pitch" : 0, "distance" : 0 }, // degrees, 0 distance = auto
+//    "width" : 512, "height" : 512,
+//    "background" : [ 0, 0, 0, 0 ],                 // rgba in [0, 1]
+//    "output" : "out/bear.png"                      // png/jpg/bmp... rendered, other
+//  }                                                //  extensions go to exporter plugins
+class BatchRenderer : public BaseCanvas
+{
+  public :
+    BatchRenderer(OffscreenContext & context);
+    ~BatchRenderer();
+
+    // reads job list, keeping only jobs assigned to given worker
+    // (job i is processed by worker i % nbWorkers)
+    bool loadJobs(const QString & file, int worker = 0, int nbWorkers = 1);
+
+    size_t nbJobs() const { return m_jobs.size(); }
+
+    // processes all jobs, returns number of failed ones
+    int run();
+
+  private :
+    struct Job
+    {
+      int index;
+      int fileId;
+      QString file;
+      int displayId;
+      QString animation;
+      int time;
+      float yaw, pitch, distance;
+      int width, height;
+      float background[4];
+      QString output;
+    };
+
+    static Job readJob(const QJsonObject & values, int index);
+
+    bool process(const Job & job);
+    bool loadModel(const Job & job);
+    bool loadCreatureDisplay(int displayId);
+    WoWModel * loadFile(GameFile * file, bool isChar);
+    void setAnimation(const Job & job);
+    bool render(const Job & job);
+    bool exportModel(const Job & job);
+    bool setupFramebuffer(int width, int height);
+    void clear();
+
+    OffscreenContext & m_context;
+    Attachment * m_root;
+    std::vector<Job> m_jobs;
+
+    GLuint m_fbo, m_colorBuffer, m_depthBuffer;
+    int m_fboWidth, m_fboHeight;
+};
+
+#endif /* _BATCHRENDERER_H_ */
@@ -0,0 +1,321 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * OffscreenContext.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#include "OffscreenContext.h"
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+
+// Qt
+#if !defined(GLEW_OSMESA) && !defined(GLEW_EGL)
+#  include <QOffscreenSurface>
+#  include <QOpenGLContext>
+#  include <QSurfaceFormat>
+#endif
+
+// Externals
+// glew is voluntarily not included here, see header
+#if defined(GLEW_OSMESA)
+#  include <GL/osmesa.h>
+#elif defined(GLEW_EGL)
+#  include <EGL/egl.h>
+#  include <EGL/eglext.h>
+#  ifndef EGL_PLATFORM_SURFACELESS_MESA
+#    define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#  endif
+#endif
+
+// Other libraries
+#include "logger/Logger.h"
+
+// Current library
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+// Beginning of implementation
+//====================================================================
+
+// Constructors
+//--------------------------------------------------------------------
+OffscreenContext::OffscreenContext()
+  : m_width(0), m_height(0), m_context(0), m_display(0)
+{
+}
+
+// Destructor
+//--------------------------------------------------------------------
+OffscreenContext::~OffscreenContext()
+{
+  destroy();
+}
+
+// Public methods
+//--------------------------------------------------------------------
+#if defined(GLEW_OSMESA)
+
+bool OffscreenContext::create(int width, int height)
+{
+  destroy();
+
+  OSMesaContext context = OSMesaCreateContextExt(OSMESA_BGRA, 24, 8, 0, NULL);
+  if (!context)
+  {
+    LOG_ERROR << "OSMesa context creation failed";
+    return false;
+  }
+
+  m_context = context;
+  m_width = width;
+  m_height = height;
+  m_buffer.resize(width * height * 4);
+
+  return makeCurrent();
+}
+
+bool OffscreenContext::makeCurrent()
+{
+  if (!m_context)
+    return false;
+
+  if (!OSMesaMakeCurrent((OSMesaContext)m_context, &m_buffer[0], GL_UNSIGNED_BYTE, m_width, m_height))
+  {
+    LOG_ERROR << "OSMesa context cannot be made current";
+    return false;
+  }
+
+  return true;
+}
+
+void OffscreenContext::destroy()
+{
+  if (m_context)
+    OSMesaDestroyContext((OSMesaContext)m_context);
+
+  m_context = 0;
+  m_buffer.clear();
+}
+
+bool OffscreenContext::hasDefaultFramebuffer() const
+{
+  return true;
+}
+
+QString OffscreenContext::backendName() const
+{
+  return "OSMesa";
+}
+
+#elif defined(GLEW_EGL)
+
+bool OffscreenContext::create(int width, int height)
+{
+  destroy();
+
+  // prefer Mesa surfaceless platform, so that no display server is ever contacted
+  EGLDisplay display = EGL_NO_DISPLAY;
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+  if (getPlatformDisplay)
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+  {
+    LOG_ERROR << "EGL display initialization failed";
+    return false;
+  }
+
+  m_display = display;
+  LOG_INFO << "EGL version" << major << "." << minor << "-" << eglQueryString(display, EGL_VENDOR);
+
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    LOG_ERROR << "EGL implementation does not support desktop OpenGL";
+    destroy();
+    return false;
+  }
+
+  const EGLint configAttribs[] = {
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_ALPHA_SIZE, 8,
+    EGL_DEPTH_SIZE, 24,
+    EGL_NONE
+  };
+
+  EGLConfig config = 0;
+  EGLint nbConfigs = 0;
+  if (!eglChooseConfig(display, configAttribs, &config, 1, &nbConfigs) || nbConfigs == 0)
+  {
+    LOG_ERROR << "No suitable EGL config found";
+    destroy();
+    return false;
+  }
+
+  // no version requested : we get a compatibility profile, needed by fixed pipeline rendering
+  EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+  if (context == EGL_NO_CONTEXT)
+  {
+    LOG_ERROR << "EGL context creation failed:" << eglGetError();
+    destroy();
+    return false;
+  }
+
+  m_context = context;
+  m_width = width;
+  m_height = height;
+
+  return makeCurrent();
+}
+
+bool OffscreenContext::makeCurrent()
+{
+  if (!m_context)
+    return false;
+
+  // surfaceless : everything is rendered in frame buffer objects
+  if (!eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)m_context))
+  {
+    LOG_ERROR << "EGL context cannot be made current (EGL_KHR_surfaceless_context needed):" << eglGetError();
+    return false;
+  }
+
+  return true;
+}
+
+void OffscreenContext::destroy()
+{
+  if (m_display)
+  {
+    eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (m_context)
+      eglDestroyContext((EGLDisplay)m_display, (EGLContext)m_context);
+
+    eglTerminate((EGLDisplay)m_display);
+  }
+
+  m_context = 0;
+  m_display = 0;
+}
+
+bool OffscreenContext::hasDefaultFramebuffer() const
+{
+  return false;
+}
+
+QString OffscreenContext::backendName() const
+{
+  return "EGL";
+}
+
+#else
+
+bool OffscreenContext::create(int width, int height)
+{
+  destroy();
+
+  QSurfaceFormat format;
+  format.setRenderableType(QSurfaceFormat::OpenGL);
+  format.setProfile(QSurfaceFormat::CompatibilityProfile);
+  format.setDepthBufferSize(24);
+  format.setAlphaBufferSize(8);
+
+  QOffscreenSurface * surface = new QOffscreenSurface();
+  surface->setFormat(format);
+  surface->create();
+  m_display = surface;
+
+  QOpenGLContext * context = new QOpenGLContext();
+  context->setFormat(format);
+  m_context = context;
+
+  if (!surface->isValid() || !context->create())
+  {
+    LOG_ERROR << "OpenGL offscreen context creation failed";
+    destroy();
+    return false;
+  }
+
+  m_width = width;
+  m_height = height;
+
+  return makeCurrent();
+}
+
+bool OffscreenContext::makeCurrent()
+{
+  if (!m_context)
+    return false;
+
+  if (!((QOpenGLContext *)m_context)->makeCurrent((QOffscreenSurface *)m_display))
+  {
+    LOG_ERROR << "OpenGL offscreen context cannot be made current";
+    return false;
+  }
+
+  return true;
+}
+
+void OffscreenContext::destroy()
+{
+  if (m_context)
+  {
+    ((QOpenGLContext *)m_context)->doneCurrent();
+    delete (QOpenGLContext *)m_context;
+  }
+
+  delete (QOffscreenSurface *)m_display;
+
+  m_context = 0;
+  m_display = 0;
+}
+
+bool OffscreenContext::hasDefaultFramebuffer() const
+{
+  return false;
+}
+
+QString OffscreenContext::backendName() const
+{
+  return "Qt offscreen surface";
+}
+
+#endif
+
+// Protected methods
+//--------------------------------------------------------------------
+
+// Private methods
+//--------------------------------------------------------------------
@@ -0,0 +1,88 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * OffscreenContext.h
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#ifndef _OFFSCREENCONTEXT_H_
+#define _OFFSCREENCONTEXT_H_
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+#include <vector>
+
+// Qt
+#include <QString>
+
+// Externals
+
+// Other libraries
+
+// Current library
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+
+// Class Declaration
+//--------------------------------------------------------------------
+
+// OpenGL (compatibility profile) context not bound to any window.
+// Backend depends on the way glew has been built (see WMV_HEADLESS_GL):
+//  - GLEW_OSMESA : software rendering in a memory buffer, no display nor GPU needed
+//  - GLEW_EGL : EGL surfaceless context (Mesa), uses GPU without any display
+//  - otherwise : Qt offscreen surface, requires a running windowing system
+// Default framebuffer is only meaningful with OSMesa, other backends have to render
+// in a frame buffer object.
+// Backend handles are kept opaque : EGL headers cannot be mixed with glew ones, and
+// context has to exist before glew resolves any EGL entry point.
+class OffscreenContext
+{
+  public :
+    OffscreenContext();
+    ~OffscreenContext();
+
+    bool create(int width, int height);
+    bool makeCurrent();
+    void destroy();
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    // true if default framebuffer can be rendered to and read back
+    bool hasDefaultFramebuffer() const;
+
+    QString backendName() const;
+
+  private :
+    int m_width, m_height;
+
+    void * m_context;
+    void * m_display; // EGLDisplay or QOffscreenSurface
+
+    // OSMesa color buffer
+    std::vector<unsigned char> m_buffer;
+};
+
+#endif /* _OFFSCREENCONTEXT_H_ */
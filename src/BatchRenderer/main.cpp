@@ -0,0 +1,179 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * main.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+// Headless batch renderer :
+//   BatchRenderer --game <wow folder> --jobs <jobs.json> [--worker i/n] [--db-cache <file>]
+//                 [--model-cache <folder>] [--profile-queries]
+// Several workers can be started on the same job list (one per process, --worker 0/4,
+// --worker 1/4...), each one handling its share of jobs. Using the same --db-cache
+// file, database is only built by the first worker and then opened read only by all.
+// Models baked in --model-cache folder are reused by next runs (and by other workers).
+
+#include <iostream>
+
+// Qt
+#include <QCommandLineParser>
+#include <QStringList>
+#if defined(GLEW_OSMESA) || defined(GLEW_EGL)
+#  include <QCoreApplication>
+#else
+#  include <QGuiApplication>
+#endif
+
+// Other libraries
+#include "CharSectionsTable.h"
+#include "CharTexture.h"
+#include "Game.h"
+#include "ModelCache.h"
+#include "OpenGLHeaders.h"
+#include "PluginManager.h"
+#include "RaceInfos.h"
+#include "video.h"
+#include "WoWDatabase.h"
+#include "WoWFolder.h"
+
+#include "logger/Logger.h"
+#include "logger/LogOutputConsole.h"
+
+// Current library
+#include "BatchRenderer.h"
+#include "OffscreenContext.h"
+
+int main(int argc, char ** argv)
+{
+#if defined(GLEW_OSMESA) || defined(GLEW_EGL)
+  QCoreApplication app(argc, argv);
+#else
+  QGuiApplication app(argc, argv);
+#endif
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Renders or exports World of Warcraft models described in a json job list");
+  parser.addHelpOption();
+  parser.addOption(QCommandLineOption("game", "World of Warcraft folder.", "folder"));
+  parser.addOption(QCommandLineOption("jobs", "Json job list.", "file"));
+  parser.addOption(QCommandLineOption("worker", "Only process jobs of worker i among n.", "i/n", "0/1"));
+  parser.addOption(QCommandLineOption("db-cache", "Database file shared between runs and workers.", "file"));
+  parser.addOption(QCommandLineOption("model-cache", "Folder of baked model files shared between runs and workers.", "folder"));
+  parser.addOption(QCommandLineOption("locale", "Game locale to use (first one found by default).", "locale"));
+  parser.addOption(QCommandLineOption("plugins", "Plugins folder.", "folder", "./plugins"));
+  parser.addOption(QCommandLineOption("profile-queries", "Logs a database query profile at exit."));
+  parser.process(app);
+
+  if (!parser.isSet("game") || !parser.isSet("jobs"))
+  {
+    std::cout << parser.helpText().toStdString() << std::endl;
+    return 1;
+  }
+
+  QStringList worker = parser.value("worker").split('/');
+  int workerId = worker[0].toInt();
+  int nbWorkers = (worker.size() > 1) ? worker[1].toInt() : 1;
+  if (nbWorkers < 1 || workerId < 0 || workerId >= nbWorkers)
+  {
+    std::cout << "Invalid worker " << parser.value("worker").toStdString() << std::endl;
+    return 1;
+  }
+
+  LOGGER.addChild(new WMVLog::LogOutputConsole());
+
+  PLUGINMANAGER.init(parser.value("plugins").toStdString());
+
+  // game init, as done by ModelViewer::LoadWoW
+  core::Game::instance().init(new wow::WoWFolder(parser.value("game")), new wow::WoWDatabase());
+
+  std::vector<core::GameConfig> configsFound = GAMEDIRECTORY.configsFound();
+  if (configsFound.empty())
+  {
+    LOG_ERROR << "Could not find any locale in" << parser.value("game");
+    return 2;
+  }
+
+  core::GameConfig config = configsFound[0];
+  for (size_t i = 0; i < configsFound.size(); i++)
+  {
+    if (configsFound[i].locale == parser.value("locale"))
+      config = configsFound[i];
+  }
+
+  if (!GAMEDIRECTORY.setConfig(config))
+  {
+    LOG_ERROR << "Could not load game folder (error" << GAMEDIRECTORY.lastError() << ")";
+    return 2;
+  }
+
+  QStringList ver = GAMEDIRECTORY.version().split('.');
+  core::Game::instance().setConfigFolder("games/wow/" + ver[0] + "." + ver[1] + "/");
+
+  GAMEDIRECTORY.initFromListfile("listfile.csv");
+
+  if (parser.isSet("db-cache"))
+    GAMEDATABASE.setCacheFile(parser.value("db-cache"));
+
+  if (parser.isSet("model-cache"))
+    ModelCache::instance().setFolder(parser.value("model-cache"));
+
+  if (parser.isSet("profile-queries"))
+    GAMEDATABASE.setProfiling(true);
+
+  if (!GAMEDATABASE.initFromXML("database.xml"))
+  {
+    LOG_ERROR << "Database initialization failed";
+    return 3;
+  }
+
+  CharTexture::initRegions();
+  RaceInfos::init();
+  CharSectionsTable::init();
+
+  // GL init, glew needs a current context
+  OffscreenContext context;
+  if (!context.create(1024, 1024))
+    return 4;
+
+  LOG_INFO << "Offscreen context created using" << context.backendName();
+
+  if (!video.Init())
+    return 4;
+
+  // this executable embeds its own copy of glew (see use_glew), resolve its entry points too
+  glewExperimental = GL_TRUE;
+  if (glewInit() != GLEW_OK)
+    return 4;
+
+  BatchRenderer renderer(context);
+  if (!renderer.loadJobs(parser.value("jobs"), workerId, nbWorkers))
+    return 5;
+
+  int nbFailed = renderer.run();
+
+  if (GAMEDATABASE.profiling())
+    GAMEDATABASE.logProfilingReport();
+
+  LOG_INFO << renderer.nbJobs() - nbFailed << "jobs succeeded," << nbFailed << "failed";
+
+  return (nbFailed == 0) ? 0 : 6;
+}
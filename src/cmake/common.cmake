@@ -26,6 +26,12 @@ SET(ENV{WMV_SDK_BASEDIR} ${WMV_SDK_BASEDIR})
 # init cmake with our qt install directory
 set(CMAKE_PREFIX_PATH $ENV{WMV_SDK_BASEDIR}/Qt/lib/cmake)
 
+# headless OpenGL : glew (and thus the whole build) is bound to OSMesa or EGL instead of
+# the windowing system, so that rendering can be done on machines without any display.
+# GUI is not built in that case, only BatchRenderer can create a context. wxWidgets is not
+# required either : plugins depending on it (FBX exporter, wowhead importer) are not built.
+set(WMV_HEADLESS_GL "" CACHE STRING "OpenGL backend for headless builds: OSMESA, EGL or empty for windowing system")
+
 #############################
 #  platform specific part   #
 #############################
@@ -45,11 +51,19 @@ macro(use_glew)
   list(APPEND src ${WMV_BASE_PATH}/src/glew/src/glew.c)
   add_definitions(-DGLEW_STATIC)
   
-  # temporary solution, glew needs opengl lib, and right now, wx one is used...
-  set(wxWidgets_USE_UNICODE ON)
-  find_package(wxWidgets REQUIRED gl core base)
+  if(WMV_HEADLESS_GL STREQUAL "OSMESA")
+    add_definitions(-DGLEW_OSMESA)
+    list(APPEND extralibs OSMesa GLU)
+  elseif(WMV_HEADLESS_GL STREQUAL "EGL")
+    add_definitions(-DGLEW_EGL)
+    list(APPEND extralibs EGL GL GLU)
+  else()
+    # temporary solution, glew needs opengl lib, and right now, wx one is used...
+    set(wxWidgets_USE_UNICODE ON)
+    find_package(wxWidgets REQUIRED gl core base)
   
-  list(APPEND extralibs ${wxWidgets_LIBRARIES})
+    list(APPEND extralibs ${wxWidgets_LIBRARIES})
+  endif()
 endmacro()
 
 macro(use_wxwidgets)
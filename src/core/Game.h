@@ -12,7 +12,7 @@
 #include "GameDatabase.h"
 
 #define GAMEDIRECTORY core::Game::instance().folder()
-#define GAMEDATABASE core::Game::instance().database()
+#define GAMEDATABASE core::Game::instance().database().from(__FILE__, __LINE__)
 
 #ifdef _WIN32
 #    ifdef BUILDING_CORE_DLL
@@ -10,27 +10,74 @@
 #include "dbfile.h"
 #include "CSVFile.h"
 
+#include <algorithm>
+#include <map>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDomElement>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStringList>
 
 #include "logger/Logger.h"
 #include "Game.h"
+#include "QueryProfiler.h"
+
+// table storing game build and structure (XML file hash) a database cache file was built from
+static const char * CACHE_INFO_TABLE = "DatabaseCacheInfo";
+
+// call site of next query, set through GAMEDATABASE macro. Entry points other than sqlQuery
+// reset it, so that it is never left for a later query issued without the macro
+static thread_local const char * s_siteFile = 0;
+static thread_local int s_siteLine = 0;
 
 core::GameDatabase::~GameDatabase()
 {
   if(m_db)
     sqlite3_close(m_db);
+
+  for (auto it : m_dbStruct)
+    delete it;
+
+  delete m_profiler;
 }
 
 
 core::GameDatabase::GameDatabase()
-: m_db(NULL), m_fastMode(false)
+: m_db(NULL), m_fastMode(false), m_profiler(0)
 {
 
 }
 
+bool core::GameDatabase::readStructure(const QString & file)
+{
+  clearSite();
+
+  if (!m_dbStruct.empty())
+    return true;
+
+  if (!readStructureFromXML(core::Game::instance().configFolder() + file) || m_dbStruct.empty())
+  {
+    LOG_ERROR << "Reading database structure from XML file failed ! Impossible to create database.";
+    return false;
+  }
+
+  return true;
+}
+
 bool core::GameDatabase::initFromXML(const QString & file)
 {
+   clearSite();
+
+   if (!readStructure(file))
+     return false;
+
+   if (!m_cacheFile.isEmpty())
+     return openCacheFile();
+
    int rc = 1;
 
    if(m_fastMode)
@@ -49,15 +96,139 @@ bool core::GameDatabase::initFromXML(const QString & file)
    }
 
    sqlite3_profile(m_db, GameDatabase::logQueryTime, m_db);
-   return createDatabaseFromXML(core::Game::instance().configFolder() + file);
+   return createDatabase();
+}
+
+bool core::GameDatabase::openCacheFile()
+{
+  if (QFile::exists(m_cacheFile) && openExistingCacheFile(false))
+    return true;
+
+  // only one process builds cache, others wait for it then use it. Building takes more
+  // than default stale time, lock is only considered stale if its process is gone
+  QLockFile lock(m_cacheFile + ".lock");
+  lock.setStaleLockTime(0);
+  if (!lock.lock())
+  {
+    LOG_ERROR << "Can't lock database cache" << m_cacheFile << "- error" << lock.error();
+    return false;
+  }
+
+  // cache built from another game build or structure (or by a previous version) is built
+  // again, unless another process did it while waiting for lock
+  if (QFile::exists(m_cacheFile))
+  {
+    if (openExistingCacheFile(false))
+      return true;
+
+    LOG_INFO << "Database cache" << m_cacheFile << "is outdated";
+  }
+
+  return buildCacheFile() && openExistingCacheFile(true);
+}
+
+bool core::GameDatabase::buildCacheFile()
+{
+  // called with cache lock held. Database is built in a temporary file, then moved in
+  // place once complete so that processes not waiting for lock never open a partially
+  // filled database
+  QString tmpFile = m_cacheFile + QString(".%1.tmp").arg(QCoreApplication::applicationPid());
+
+  if (sqlite3_open(tmpFile.toStdString().c_str(), &m_db))
+  {
+    LOG_ERROR << "Can't create database cache" << tmpFile << ":" << sqlite3_errmsg(m_db);
+    sqlite3_close(m_db);
+    m_db = NULL;
+    return false;
+  }
+
+  LOG_INFO << "Building database cache" << m_cacheFile;
+  sqlite3_exec(m_db, "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF;", NULL, NULL, NULL);
+  bool result = createDatabase();
+
+  // game build and structure database was read from, checked by openExistingCacheFile
+  if (result)
+  {
+    QString build = GAMEDIRECTORY.version().replace("'", "''");
+    QString query = QString("CREATE TABLE %1 (build TEXT, structure TEXT); INSERT INTO %1 VALUES('%2', '%3');")
+                    .arg(CACHE_INFO_TABLE).arg(build).arg(QString::fromLatin1(m_structureHash));
+    result = (sqlite3_exec(m_db, query.toStdString().c_str(), NULL, NULL, NULL) == SQLITE_OK);
+  }
+
+  sqlite3_close(m_db);
+  m_db = NULL;
+
+  if (!result)
+  {
+    QFile::remove(tmpFile);
+    return false;
+  }
+
+  // outdated file replaced. No other process builds it meanwhile, as lock is held
+  QFile::remove(m_cacheFile);
+  if (!QFile::rename(tmpFile, m_cacheFile))
+  {
+    LOG_ERROR << "Can't replace database cache" << m_cacheFile;
+    QFile::remove(tmpFile);
+    return false;
+  }
+
+  return true;
+}
+
+bool core::GameDatabase::openExistingCacheFile(bool logErrors)
+{
+  if (sqlite3_open_v2(m_cacheFile.toStdString().c_str(), &m_db, SQLITE_OPEN_READONLY, NULL))
+  {
+    LOG_ERROR << "Can't open database cache" << m_cacheFile << ":" << sqlite3_errmsg(m_db);
+    sqlite3_close(m_db);
+    m_db = NULL;
+    return false;
+  }
+
+  sqlResult info;
+  QString query = QString("SELECT build, structure FROM %1").arg(CACHE_INFO_TABLE);
+  sqlite3_exec(m_db, query.toStdString().c_str(), core::GameDatabase::treatQuery, (void *)&info, NULL);
+
+  bool hasInfo = !info.values.empty() && (info.values[0].size() >= 2);
+  QString build = hasInfo ? info.values[0][0] : QString();
+  QString structure = hasInfo ? info.values[0][1] : QString();
+  if (build != GAMEDIRECTORY.version() || structure != QString::fromLatin1(m_structureHash))
+  {
+    if (logErrors)
+      LOG_ERROR << "Database cache" << m_cacheFile << "built from game build" << build << "and structure" << structure
+                << "instead of" << GAMEDIRECTORY.version() << "and" << QString::fromLatin1(m_structureHash);
+
+    sqlite3_close(m_db);
+    m_db = NULL;
+    return false;
+  }
+
+  LOG_INFO << "Opened database cache" << m_cacheFile;
+  sqlite3_profile(m_db, GameDatabase::logQueryTime, m_db);
+  return true;
 }
 
 sqlResult core::GameDatabase::sqlQuery(const QString & query)
 {
   sqlResult result;
 
+  const char * siteFile = s_siteFile;
+  int siteLine = s_siteLine;
+  s_siteFile = 0;
+
+  QElapsedTimer timer;
+  if (m_profiler)
+    timer.start();
+
   char *zErrMsg = 0;
   int rc = sqlite3_exec(m_db, query.toStdString().c_str(), core::GameDatabase::treatQuery, (void *)&result, &zErrMsg);
+
+  if (m_profiler)
+  {
+    QString site = siteFile ? QString("%1:%2").arg(QFileInfo(siteFile).fileName()).arg(siteLine) : QString("unknown");
+    m_profiler->record(query, site, timer.nsecsElapsed(), result.values.size());
+  }
   if( rc != SQLITE_OK )
   {
     LOG_ERROR << "Querying in database" << query;
@@ -73,8 +244,113 @@ sqlResult core::GameDatabase::sqlQuery(const QString & query)
   return result;
 }
 
+core::GameDatabase & core::GameDatabase::from(const char * file, int line)
+{
+  s_siteFile = file;
+  s_siteLine = line;
+  return *this;
+}
+
+void core::GameDatabase::clearSite()
+{
+  s_siteFile = 0;
+}
+
+void core::GameDatabase::setProfiling(bool enable)
+{
+  clearSite();
+
+  if (enable && !m_profiler)
+  {
+    m_profiler = new QueryProfiler();
+  }
+  else if (!enable && m_profiler)
+  {
+    delete m_profiler;
+    m_profiler = 0;
+  }
+}
+
+QString core::GameDatabase::profilingReport(unsigned int nbEntries, unsigned int nbPlans)
+{
+  clearSite();
+
+  if (!m_profiler)
+    return "Query profiling is disabled";
+
+  std::vector<QueryProfiler::Entry> entries = m_profiler->entries();
+
+  unsigned int nbQueries = 0;
+  qint64 totalNs = 0;
+  for (auto & e : entries)
+  {
+    nbQueries += e.count;
+    totalNs += e.totalNs;
+  }
+
+  QStringList report;
+  report << QString("Database query profile : %1 queries, %2 statements, %3 ms")
+              .arg(nbQueries).arg((int)entries.size()).arg(totalNs / 1000000.0, 0, 'f', 1);
+
+  // query plans are retrieved through database, don't profile them
+  QueryProfiler * profiler = m_profiler;
+  m_profiler = 0;
+
+  for (unsigned int i = 0; i < entries.size() && i < nbEntries; i++)
+  {
+    const QueryProfiler::Entry & e = entries[i];
+
+    report << QString("#%1 %2 ms total | %3 calls | p50 %4 ms | p99 %5 ms | %6 rows/call")
+                .arg(i + 1)
+                .arg(e.totalNs / 1000000.0, 0, 'f', 1)
+                .arg(e.count)
+                .arg(e.percentile(0.5) / 1000000.0, 0, 'f', 2)
+                .arg(e.percentile(0.99) / 1000000.0, 0, 'f', 2)
+                .arg((double)e.rows / e.count, 0, 'f', 1);
+    report << "   " + e.statement.left(500);
+
+    // most frequent call sites first
+    std::vector<std::pair<unsigned int, QString> > sites;
+    for (auto & s : e.sites)
+      sites.push_back(std::make_pair(s.second, s.first));
+    std::sort(sites.rbegin(), sites.rend());
+
+    QStringList siteList;
+    for (size_t s = 0; s < sites.size() && s < 5; s++)
+      siteList << QString("%1 (%2)").arg(sites[s].second).arg(sites[s].first);
+    report << "   from " + siteList.join(", ");
+
+    if (i < nbPlans && !e.example.isEmpty() && e.example.trimmed().startsWith("SELECT", Qt::CaseInsensitive))
+    {
+      sqlResult plan = sqlQuery("EXPLAIN QUERY PLAN " + e.example);
+      for (auto & step : plan.values)
+      {
+        QString detail = step.back();
+        // a full scan on a joined or filtered table usually means a missing createIndex in database.xml
+        if (detail.startsWith("SCAN") && !detail.contains("USING"))
+          detail += "  <-- full table scan";
+        report << "   plan: " + detail;
+      }
+    }
+  }
+
+  m_profiler = profiler;
+
+  return report.join("\n");
+}
+
+void core::GameDatabase::logProfilingReport()
+{
+  clearSite();
+
+  for (auto & line : profilingReport().split('\n'))
+    LOG_INFO << line;
+}
+
 void core::GameDatabase::addTable(TableStructure * tbl)
 {
+  clearSite();
+
   m_dbStruct.push_back(tbl);
 }
 
@@ -97,14 +373,8 @@ int core::GameDatabase::treatQuery(void *resultPtr, int nbcols, char ** vals , c
   return 0;
 }
 
-bool core::GameDatabase::createDatabaseFromXML(const QString & file)
+bool core::GameDatabase::createDatabase()
 {
-  if (!readStructureFromXML(file))
-  {
-    LOG_ERROR << "Reading database structure from XML file failed ! Impossible to create database.";
-    return false;
-  }
-
   bool result = true; // ok until we found an issue
 
   for (auto it = m_dbStruct.begin(), itEnd = m_dbStruct.end(); it != itEnd; ++it)
@@ -124,10 +394,84 @@ bool core::GameDatabase::createDatabaseFromXML(const QString & file)
     }
   }
 
+  return result; 
+}
+
+bool core::GameDatabase::readTable(const QString & table, const QStringList & columns,
+                                   std::function<void (const std::vector<std::string> &)> callback) const
+{
+  clearSite();
+
+  TableStructure * structure = 0;
   for (auto it : m_dbStruct)
-    delete it;
+  {
+    if (it->name == table)
+    {
+      structure = it;
+      break;
+    }
+  }
 
-  return result; 
+  if (!structure)
+  {
+    LOG_ERROR << "Reading unknown table" << table;
+    return false;
+  }
+
+  // position of each column in decoded records (same layout as sql insertion, see TableStructure::fill)
+  std::map<QString, int> positions;
+  int nbValues = 0;
+  for (auto it : structure->fields)
+  {
+    if (it->arraySize == 1)
+    {
+      positions[it->name] = nbValues++;
+    }
+    else
+    {
+      for (unsigned int i = 1; i <= it->arraySize; i++)
+        positions[it->name + QString::number(i)] = nbValues++;
+    }
+  }
+
+  std::vector<int> indexes;
+  for (auto & column : columns)
+  {
+    auto it = positions.find(column);
+    if (it == positions.end())
+    {
+      LOG_ERROR << "Reading unknown column" << column << "from table" << table;
+      return false;
+    }
+    indexes.push_back(it->second);
+  }
+
+  DBFile * dbc = structure->createDBFile();
+  if (!dbc || !dbc->open())
+  {
+    LOG_ERROR << "Unable to open game file for table" << table;
+    delete dbc;
+    return false;
+  }
+
+  std::vector<std::string> values(indexes.size());
+  for (DBFile::Iterator it = dbc->begin(), itEnd = dbc->end(); it != itEnd; ++it)
+  {
+    std::vector<std::string> record = it.get(structure);
+
+    // incomplete record, would have been rejected by sql insertion too
+    if ((int)record.size() != nbValues)
+      continue;
+
+    for (size_t i = 0; i < indexes.size(); i++)
+      values[i] = record[indexes[i]];
+
+    callback(values);
+  }
+
+  delete dbc;
+
+  return true;
 }
 
 void core::GameDatabase::logQueryTime(void* aDb, const char* aQueryStr, sqlite3_uint64 aTimeInNs)
@@ -147,9 +491,13 @@ bool core::GameDatabase::readStructureFromXML(const QString & file)
 
   QFile f(file);
   f.open(QIODevice::ReadOnly);
-  doc.setContent(&f);
+  QByteArray content = f.readAll();
   f.close();
 
+  // cache files built from another structure are built again
+  m_structureHash = QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex();
+  doc.setContent(content);
+
   QDomElement docElem = doc.documentElement();
 
   QDomElement e = docElem.firstChildElement();
@@ -8,14 +8,23 @@
 #ifndef _GAMEDATABASE_H_
 #define _GAMEDATABASE_H_
 
+#include <functional>
+#include <string>
 #include <vector>
 #include "sqlite3.h"
 
 class DBFile;
 class GameFile;
 
+namespace core
+{
+  class QueryProfiler;
+}
+
 class QDomElement;
+#include <QByteArray>
 #include <QString>
+#include <QStringList>
 
 #ifdef _WIN32
 #    ifdef BUILDING_CORE_DLL
@@ -90,11 +99,38 @@ namespace core
     GameDatabase();
     GameDatabase(GameDatabase &);
 
+    // reads tables structure (done by initFromXML if not already done), allowing
+    // readTable calls while database is being built
+    bool readStructure(const QString & file);
+
     bool initFromXML(const QString & file);
 
     sqlResult sqlQuery(const QString &query);
 
-    void setFastMode() { m_fastMode = true; }
+    // call site of next query issued by current thread, for profiling (see GAMEDATABASE).
+    // Other entry points reset it
+    GameDatabase & from(const char * file, int line);
+
+    // query profiling : timings are aggregated by statement shape, report lists most
+    // expensive ones (with their query plan for the first nbPlans ones)
+    void setProfiling(bool enable);
+    bool profiling() const { clearSite(); return m_profiler != 0; }
+    QString profilingReport(unsigned int nbEntries = 20, unsigned int nbPlans = 5);
+    void logProfilingReport();
+
+    // reads a table straight from game file, without any sql round-trip. For each record,
+    // callback gets values of requested columns, named as in database (array fields being
+    // suffixed by their index, starting at 1). Can be called from any thread once
+    // structure is read.
+    bool readTable(const QString & table, const QStringList & columns,
+                   std::function<void (const std::vector<std::string> &)> callback) const;
+
+    void setFastMode() { clearSite(); m_fastMode = true; }
+
+    // database is stored in given file and reused (read only) if it already exists and was
+    // built from current game build and structure, allowing several processes to share the same database
+    // without rebuilding it
+    void setCacheFile(const QString & file) { clearSite(); m_cacheFile = file; }
 
     virtual ~GameDatabase();
 
@@ -110,16 +146,24 @@ namespace core
 
   private:
     static int treatQuery(void *NotUsed, int nbcols, char ** values, char ** cols);
+    static void clearSite();
     static void logQueryTime(void* aDb, const char* aQueryStr, sqlite3_uint64 aTimeInNs);
 
-    bool createDatabaseFromXML(const QString & file);
+    bool createDatabase();
     bool readStructureFromXML(const QString & file);
+    bool openCacheFile();
+    bool buildCacheFile();
+    bool openExistingCacheFile(bool logErrors);
 
     sqlite3 *m_db;
 
     std::vector<TableStructure * > m_dbStruct;
 
     bool m_fastMode;
+    QString m_cacheFile;
+    QByteArray m_structureHash; // of XML file structure was read from
+
+    QueryProfiler * m_profiler;
   };
 
 }
@@ -10,8 +10,19 @@
 
 #include <cstring> // memcpy
 
+#include <QMutex>
+#include <QWaitCondition>
+
 #include "logger\Logger.h"
 
+// files can be opened by worker threads (WMO groups streaming, outfit files prefetching...)
+// while GL thread opens or closes the same ones, so open / close of a file must not overlap.
+// Mutex only guards busy flags (see lockOpenClose) : files are read without holding it, so
+// that different files are opened in parallel (storage accesses being serialized by
+// implementations, see CASCFile)
+static QMutex s_openCloseMutex;
+static QWaitCondition s_openCloseDone;
+
 size_t GameFile::read(void* dest, size_t bytes)
 {
   if (eof)
@@ -48,11 +59,68 @@ void GameFile::seekRelative(size_t offset)
 
 bool GameFile::open(bool useMemoryBuffer /* = true */)
 {
-  if (isAlreadyOpened())
+  lockOpenClose();
+  bool result = openUnlocked(useMemoryBuffer);
+  unlockOpenClose();
+  return result;
+}
+
+bool GameFile::close()
+{
+  lockOpenClose();
+  bool result = closeUnlocked();
+  unlockOpenClose();
+  return result;
+}
+
+void GameFile::setCachedContent(const unsigned char * data, unsigned long long s)
+{
+  lockOpenClose();
+
+  if (openedFromCache())
+    closeUnlocked();
+
+  m_cachedContent = data;
+  m_cachedSize = s;
+
+  unlockOpenClose();
+}
+
+void GameFile::lockOpenClose()
+{
+  QMutexLocker locker(&s_openCloseMutex);
+  while (m_busy)
+    s_openCloseDone.wait(&s_openCloseMutex);
+  m_busy = true;
+}
+
+void GameFile::unlockOpenClose()
+{
+  QMutexLocker locker(&s_openCloseMutex);
+  m_busy = false;
+  s_openCloseDone.wakeAll();
+}
+
+bool GameFile::openUnlocked(bool useMemoryBuffer)
+{
+  if (isAlreadyOpened() || openedFromCache())
     return true;
 
   eof = true;
 
+  if (m_cachedContent)
+  {
+    // contents are only pointed to, file itself is not opened
+    originalBuffer = const_cast<unsigned char *>(m_cachedContent);
+    buffer = originalBuffer;
+    size = m_contentSize = m_cachedSize;
+    pointer = 0;
+    m_useMemoryBuffer = true;
+    eof = (size == 0);
+    doPostOpenOperation();
+    return true;
+  }
+
   if (!openFile())
     return false;
 
@@ -74,9 +142,10 @@ bool GameFile::open(bool useMemoryBuffer /* = true */)
   return true;
 }
 
-bool GameFile::close()
+bool GameFile::closeUnlocked()
 {
-  delete[] originalBuffer;
+  if (!openedFromCache())
+    delete[] originalBuffer;
   originalBuffer = 0;
   buffer = 0;
   eof = true;
@@ -86,10 +155,10 @@ bool GameFile::close()
 
 void GameFile::allocate(unsigned long long s)
 {
-  if (originalBuffer)
+  if (originalBuffer && !openedFromCache())
     delete[] originalBuffer;
 
-  size = s;
+  size = m_contentSize = s;
 
   originalBuffer = new unsigned char[size];
   buffer = originalBuffer;
@@ -29,7 +29,8 @@ class _GAMEFILE_API_ GameFile : public Component
     GameFile(QString path, int id = -1) 
       : eof(true), buffer(nullptr), pointer(0), size(0), 
         filepath(path), m_useMemoryBuffer(true), m_fileDataId(id),
-        originalBuffer(nullptr), curChunk("")
+        originalBuffer(nullptr), curChunk(""),
+        m_cachedContent(nullptr), m_cachedSize(0), m_contentSize(0), m_busy(false)
     {}
 
     virtual ~GameFile() {}
@@ -53,6 +54,14 @@ class _GAMEFILE_API_ GameFile : public Component
     bool setChunk(std::string chunkName, bool resetToStart = true);
     bool isChunked() { return chunks.size() > 0; }
 
+    // whole file contents, whatever chunk is selected (valid while file is opened)
+    const unsigned char * content() const { return originalBuffer; }
+    unsigned long long contentSize() const { return m_contentSize; }
+
+    // contents to use instead of reading file when opening it (see ModelCache). They must
+    // stay valid until reset (null), which closes file if it was opened from them
+    void setCachedContent(const unsigned char * data, unsigned long long size);
+
     virtual void dumpStructure();
 
   protected:
@@ -93,6 +102,19 @@ class _GAMEFILE_API_ GameFile : public Component
     void operator=(const GameFile &);
     unsigned char * originalBuffer;
     std::string curChunk;
+    const unsigned char * m_cachedContent;
+    unsigned long long m_cachedSize;
+    unsigned long long m_contentSize;
+
+    bool m_busy; // being opened or closed by a thread
+
+    bool openedFromCache() const { return originalBuffer && originalBuffer == m_cachedContent; }
+
+    // marks file as busy, waiting for any other thread opening or closing it
+    void lockOpenClose();
+    void unlockOpenClose();
+    bool openUnlocked(bool useMemoryBuffer);
+    bool closeUnlocked();
 };
 
 
@@ -12,7 +12,7 @@
 #include "logger/Logger.h"
 
 core::GameFolder::GameFolder(const QString & path)
-  : m_path(path)
+  : m_mutex(QMutex::Recursive), m_path(path)
 {
 }
 
@@ -31,14 +31,16 @@ QString core::GameFolder::getFullPathForFile(QString file)
 
 void core::GameFolder::getFilesForFolder(std::vector<GameFile *> &fileNames, QString folderPath, QString extension)
 {
-  for(GameFolder::iterator it = begin() ; it != end() ; ++it)
+  // file names are stored lower case and sorted in name map : files of a given
+  // folder are contiguous, no need to go through the whole file list
+  folderPath = folderPath.toLower().replace('\\', '/');
+
+  QMutexLocker locker(&m_mutex);
+
+  for(auto it = m_nameMap.lower_bound(folderPath) ; it != m_nameMap.end() && it->first.startsWith(folderPath) ; ++it)
   {
-    GameFile * file = *it;
-    if(file->fullname().startsWith(folderPath, Qt::CaseInsensitive) &&
-       (!extension.size() || file->fullname().endsWith(extension, Qt::CaseInsensitive)))
-    {
-      fileNames.push_back(file);
-    }
+    if(!extension.size() || it->first.endsWith(extension, Qt::CaseInsensitive))
+      fileNames.push_back(it->second);
   }
 }
 
@@ -66,6 +68,7 @@ GameFile * core::GameFolder::getFile(QString filename)
 
   GameFile * result = 0;
 
+  QMutexLocker locker(&m_mutex);
   auto it = m_nameMap.find(filename);
   if (it != m_nameMap.end())
     result = it->second;
@@ -75,11 +78,13 @@ GameFile * core::GameFolder::getFile(QString filename)
 
 void core::GameFolder::onChildAdded(GameFile * child)
 {
+  QMutexLocker locker(&m_mutex);
   m_nameMap[child->fullname()] = child;
 }
 
 void core::GameFolder::onChildRemoved(GameFile * child)
 {
+  QMutexLocker locker(&m_mutex);
   m_nameMap.erase(child->fullname());
 }
 
@@ -11,6 +11,8 @@
 #include <map>
 #include <set>
 
+#include <QMutex>
+
 #include "GameFile.h"
 
 #include "metaclasses/Container.h"
@@ -70,6 +72,11 @@ namespace core
 
       QString path() { return m_path; }
 
+    protected:
+      // guards file maps : files missing from listfile are added on the fly when
+      // requested by id, possibly from worker threads (see ModelLoader)
+      mutable QMutex m_mutex;
+
     private:
       std::map<QString, GameFile *> m_nameMap;
       QString m_path;
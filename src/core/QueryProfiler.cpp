@@ -0,0 +1,120 @@
+/*
+ * QueryProfiler.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "QueryProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+// longer queries (mostly table filling inserts) are not kept as examples
+#define MAX_EXAMPLE_LENGTH 4096
+
+qint64 core::QueryProfiler::Entry::percentile(double p) const
+{
+  if (durations.empty())
+    return 0;
+
+  std::vector<qint64> sorted = durations;
+  std::sort(sorted.begin(), sorted.end());
+
+  size_t index = (size_t)std::ceil(p * sorted.size());
+  return sorted[(index > 0) ? index - 1 : 0];
+}
+
+void core::QueryProfiler::record(const QString & query, const QString & site, qint64 ns, size_t rows)
+{
+  QString statement = normalize(query);
+
+  QMutexLocker locker(&m_mutex);
+
+  Entry & entry = m_entries[statement];
+  if (entry.count == 0)
+  {
+    entry.statement = statement;
+    if (query.size() <= MAX_EXAMPLE_LENGTH)
+      entry.example = query;
+  }
+
+  entry.count++;
+  entry.totalNs += ns;
+  entry.rows += rows;
+  entry.durations.push_back(ns);
+  entry.sites[site]++;
+}
+
+void core::QueryProfiler::clear()
+{
+  QMutexLocker locker(&m_mutex);
+  m_entries.clear();
+}
+
+std::vector<core::QueryProfiler::Entry> core::QueryProfiler::entries() const
+{
+  std::vector<Entry> result;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    for (auto & it : m_entries)
+      result.push_back(it.second);
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const Entry & a, const Entry & b) { return a.totalNs > b.totalNs; });
+
+  return result;
+}
+
+QString core::QueryProfiler::normalize(const QString & query)
+{
+  QString result;
+  result.reserve(query.size());
+
+  for (int i = 0, n = query.size(); i < n;)
+  {
+    QChar c = query[i];
+    QChar previous = result.isEmpty() ? QChar(' ') : result[result.size() - 1];
+
+    if (c == '\'' || c == '"') // string literal
+    {
+      int end = query.indexOf(c, i + 1);
+      i = (end == -1) ? n : end + 1;
+      result += '?';
+    }
+    else if (c.isDigit() && !previous.isLetterOrNumber() && previous != '_') // number, not part of a name
+    {
+      while (i < n && (query[i].isLetterOrNumber() || query[i] == '.'))
+        i++;
+      result += '?';
+    }
+    else if (c.isSpace())
+    {
+      if (previous != ' ')
+        result += ' ';
+      i++;
+    }
+    else
+    {
+      result += c;
+      i++;
+    }
+  }
+
+  // value lists : "IN (?, ?, ?)" -> "IN (?)", "VALUES (?,?),(?,?)" -> "VALUES (?)"
+  static const QRegularExpression list("\\?(\\s*,\\s*\\?)+");
+  static const QRegularExpression tuples("\\(\\?\\)(\\s*,\\s*\\(\\?\\))+");
+  result.replace(list, "?");
+  result.replace(tuples, "(?)");
+
+  result = result.trimmed();
+  if (result.endsWith(';'))
+    result.chop(1);
+
+  return result;
+}
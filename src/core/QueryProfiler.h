@@ -0,0 +1,63 @@
+/*
+ * QueryProfiler.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _QUERYPROFILER_H_
+#define _QUERYPROFILER_H_
+
+#include <map>
+#include <vector>
+
+#include <QMutex>
+#include <QString>
+
+#ifdef _WIN32
+#    ifdef BUILDING_CORE_DLL
+#        define _QUERYPROFILER_API_ __declspec(dllexport)
+#    else
+#        define _QUERYPROFILER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _QUERYPROFILER_API_
+#endif
+
+namespace core
+{
+  // Aggregates sql query timings by statement shape (query with literals replaced by '?'),
+  // keeping calls count, latencies, rows returned and call sites of each shape.
+  class _QUERYPROFILER_API_ QueryProfiler
+  {
+  public:
+    struct Entry
+    {
+      Entry() : count(0), totalNs(0), rows(0) {}
+
+      QString statement;
+      QString example; // one actual query of this shape (empty if too long to keep)
+      unsigned int count;
+      qint64 totalNs;
+      quint64 rows;
+      std::vector<qint64> durations; // ns
+      std::map<QString, unsigned int> sites; // "file:line" -> calls count
+
+      qint64 percentile(double p) const;
+    };
+
+    void record(const QString & query, const QString & site, qint64 ns, size_t rows);
+    void clear();
+
+    // entries sorted by total time, most expensive first
+    std::vector<Entry> entries() const;
+
+    static QString normalize(const QString & query);
+
+  private:
+    mutable QMutex m_mutex;
+    std::map<QString, Entry> m_entries;
+  };
+}
+
+#endif /* _QUERYPROFILER_H_ */
@@ -0,0 +1,249 @@
+/*
+ * AnimationBaker.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "AnimationBaker.h"
+
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include "GameFile.h"
+#include "WoWModel.h"
+
+namespace
+{
+  class BakeTask : public QRunnable
+  {
+    public:
+      BakeTask(std::shared_ptr<AnimationSkeleton> skeleton, uint32 rate, AnimationBaker::BakedAnimationPtr * result)
+        : m_skeleton(skeleton), m_rate(rate), m_result(result)
+      {}
+
+      void run()
+      {
+        *m_result = std::make_shared<const BakedAnimation>(m_skeleton->bake(m_rate));
+      }
+
+    private:
+      std::shared_ptr<AnimationSkeleton> m_skeleton;
+      uint32 m_rate;
+      AnimationBaker::BakedAnimationPtr * m_result;
+  };
+}
+
+AnimationSkeleton::AnimationSkeleton(WoWModel * model, size_t anim)
+  : m_anim(anim), m_length(0)
+{
+  ssize_t slot = -1;
+  if (anim < model->anims.size())
+  {
+    slot = model->anims[anim].Index;
+    m_length = model->anims[anim].length;
+    model->loadAnimation(slot);
+  }
+
+  const size_t nbBones = model->bones.size();
+  m_bones.resize(nbBones);
+
+  for (size_t b = 0; b < nbBones; b++)
+  {
+    Bone & bone = model->bones[b];
+    BoneTracks & tracks = m_bones[b];
+
+    tracks.parent = ((bone.parent >= 0) && ((size_t)bone.parent < nbBones)) ? bone.parent : -1;
+    tracks.pivot = bone.pivot;
+
+    if (slot >= 0 && slot < MAX_ANIMATED)
+    {
+      tracks.trans.init(bone.trans, slot);
+      tracks.rot.init(bone.rot, slot);
+      tracks.scale.init(bone.scale, slot);
+    }
+  }
+
+  // evaluation order: each bone after its parent chain
+  std::vector<bool> visited(nbBones, false);
+  m_order.reserve(nbBones);
+  for (size_t b = 0; b < nbBones; b++)
+  {
+    std::vector<size_t> chain;
+    for (ssize_t c = b; c >= 0 && !visited[c]; c = m_bones[c].parent)
+    {
+      visited[c] = true;
+      chain.push_back(c);
+    }
+    m_order.insert(m_order.end(), chain.rbegin(), chain.rend());
+  }
+}
+
+BakedAnimation AnimationSkeleton::bake(uint32 rate) const
+{
+  BakedAnimation result;
+  result.anim = m_anim;
+  result.rate = rate;
+  result.length = m_length;
+
+  for (auto & bone : m_bones)
+  {
+    BakedAnimation::BoneInfo info;
+    info.parent = bone.parent;
+    info.pivot = bone.pivot;
+    info.trans = bone.trans.used;
+    info.rot = bone.rot.used;
+    info.scale = bone.scale.used;
+    result.bones.push_back(info);
+  }
+
+  for (uint32 i = 0; rate > 0; i++)
+  {
+    uint32 t = (uint32)((uint64_t)i * 1000 / rate);
+    if (t >= m_length)
+      break;
+    result.times.push_back(t);
+  }
+  result.times.push_back(m_length);
+
+  const size_t size = result.times.size() * m_bones.size();
+  result.translations.resize(size);
+  result.rotations.resize(size);
+  result.scales.resize(size);
+  result.matrices.resize(size, Matrix::identity());
+
+  for (size_t f = 0; f < result.times.size(); f++)
+  {
+    const uint32 time = result.times[f];
+
+    for (auto b : m_order)
+    {
+      const BoneTracks & bone = m_bones[b];
+      const size_t i = result.index(f, b);
+
+      Vec3D tr = bone.trans.used ? bone.trans.value(time) : Vec3D();
+      Quaternion q = bone.rot.used ? bone.rot.value(time) : Quaternion();
+      Vec3D sc = bone.scale.used ? bone.scale.value(time) : Vec3D(1.0f, 1.0f, 1.0f);
+
+      result.translations[i] = tr + bone.pivot;
+      if (bone.parent != -1)
+        result.translations[i] -= m_bones[bone.parent].pivot;
+      result.rotations[i] = q;
+      result.scales[i] = sc;
+
+      // same composition as Bone::calcMatrix
+      Matrix m;
+      if (bone.trans.used || bone.rot.used || bone.scale.used)
+      {
+        m.translation(bone.pivot);
+        if (bone.trans.used)
+          m *= Matrix::newTranslation(tr);
+        if (bone.rot.used)
+          m *= Matrix::newQuatRotate(q);
+        if (bone.scale.used)
+          m *= Matrix::newScale(sc);
+        m *= Matrix::newTranslation(bone.pivot * -1.0f);
+      }
+      else
+        m.unit();
+
+      if (bone.parent != -1)
+        result.matrices[i] = result.matrices[result.index(f, bone.parent)] * m;
+      else
+        result.matrices[i] = m;
+    }
+  }
+
+  return result;
+}
+
+AnimationBaker & AnimationBaker::instance()
+{
+  static AnimationBaker baker;
+  return baker;
+}
+
+AnimationBaker::BakedAnimationPtr AnimationBaker::bake(WoWModel * model, size_t anim, uint32 rate)
+{
+  std::vector<int> anims(1, (int)anim);
+  return bake(model, anims, rate).front();
+}
+
+std::vector<AnimationBaker::BakedAnimationPtr> AnimationBaker::bake(WoWModel * model, const std::vector<int> & anims, uint32 rate)
+{
+  std::vector<BakedAnimationPtr> result(anims.size());
+
+  if (!model)
+    return result;
+
+  // no cache for models not coming from a game file
+  const int fileDataId = model->gamefile ? model->gamefile->fileDataId() : -1;
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+
+  std::vector<size_t> baked;
+  for (size_t i = 0; i < anims.size(); i++)
+  {
+    if (anims[i] < 0 || (size_t)anims[i] >= model->anims.size())
+      continue;
+
+    Key key = { fileDataId, (size_t)anims[i], rate };
+    if (fileDataId != -1)
+    {
+      result[i] = find(key);
+      if (result[i])
+        continue;
+    }
+
+    // track data is copied here, workers never touch the model
+    std::shared_ptr<AnimationSkeleton> skeleton = std::make_shared<AnimationSkeleton>(model, anims[i]);
+    pool.start(new BakeTask(skeleton, rate, &result[i]));
+    baked.push_back(i);
+  }
+
+  pool.waitForDone();
+
+  if (fileDataId != -1)
+  {
+    for (auto i : baked)
+    {
+      Key key = { fileDataId, (size_t)anims[i], rate };
+      store(key, result[i]);
+    }
+  }
+
+  return result;
+}
+
+void AnimationBaker::clear()
+{
+  QMutexLocker lock(&m_mutex);
+  m_cache.clear();
+  m_cacheOrder.clear();
+}
+
+AnimationBaker::BakedAnimationPtr AnimationBaker::find(const Key & key)
+{
+  QMutexLocker lock(&m_mutex);
+  auto it = m_cache.find(key);
+  return (it != m_cache.end()) ? it->second : BakedAnimationPtr();
+}
+
+void AnimationBaker::store(const Key & key, BakedAnimationPtr anim)
+{
+  QMutexLocker lock(&m_mutex);
+  if (!m_cache.insert(std::make_pair(key, anim)).second)
+    return;
+
+  m_cacheOrder.push_back(key);
+  while (m_cacheOrder.size() > CACHE_SIZE)
+  {
+    m_cache.erase(m_cacheOrder.front());
+    m_cacheOrder.pop_front();
+  }
+}
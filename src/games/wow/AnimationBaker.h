@@ -0,0 +1,178 @@
+/*
+ * AnimationBaker.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _ANIMATIONBAKER_H_
+#define _ANIMATIONBAKER_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+
+#include "animated.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "vec3d.h"
+
+class WoWModel;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _ANIMATIONBAKER_API_ __declspec(dllexport)
+#    else
+#        define _ANIMATIONBAKER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _ANIMATIONBAKER_API_
+#endif
+
+// Bone transforms of one animation sampled at a fixed rate.
+// Per frame arrays are frame major: value of bone b at frame f is at index(f, b)
+struct BakedAnimation
+{
+  struct BoneInfo
+  {
+    int16 parent;
+    Vec3D pivot;
+    // tracks animated by this animation
+    bool trans, rot, scale;
+  };
+
+  size_t anim;   // index in WoWModel::anims
+  uint32 rate;   // samples per second
+  uint32 length; // ms
+
+  std::vector<BoneInfo> bones;
+  std::vector<uint32> times; // ms, last sample is animation end
+
+  // local transforms: translation relative to parent bone (pivot offset included),
+  // rotation and scale as stored in model tracks
+  std::vector<Vec3D> translations;
+  std::vector<Quaternion> rotations;
+  std::vector<Vec3D> scales;
+
+  // model space bone matrices, as computed by Bone::calcMatrix
+  std::vector<Matrix> matrices;
+
+  size_t nbFrames() const { return times.size(); }
+  size_t index(size_t frame, size_t bone) const { return frame * bones.size() + bone; }
+};
+
+// Copy of a model skeleton and of the tracks of one of its animations.
+// Built on the thread owning the model, it can then be sampled from any thread.
+// Global sequences are evaluated from animation start, billboards are ignored.
+class _ANIMATIONBAKER_API_ AnimationSkeleton
+{
+  public:
+    AnimationSkeleton(WoWModel * model, size_t anim);
+
+    BakedAnimation bake(uint32 rate) const;
+
+  private:
+    template <class T>
+    struct Track
+    {
+      Track() : used(false), type(INTERPOLATION_NONE), globalLength(0), global(false) {}
+
+      template <class A>
+      void init(const A & animated, ssize_t anim)
+      {
+        used = animated.uses(anim);
+        type = animated.type;
+        global = (animated.seq >= 0 && animated.seq < (ssize_t)animated.globals.size());
+        if (global)
+        {
+          globalLength = animated.globals[animated.seq];
+          anim = 0;
+        }
+        times = animated.times[anim];
+        data = animated.data[anim];
+        in = animated.in[anim];
+        out = animated.out[anim];
+      }
+
+      T value(size_t time) const
+      {
+        if (global)
+        {
+          if (!globalLength)
+            return T();
+          time %= globalLength;
+        }
+        return interpolateKeys<T>(type, times, data, in, out, time);
+      }
+
+      bool used;
+      ssize_t type;
+      uint32 globalLength;
+      bool global;
+      std::vector<size_t> times;
+      std::vector<T> data, in, out;
+    };
+
+    struct BoneTracks
+    {
+      int16 parent;
+      Vec3D pivot;
+      Track<Vec3D> trans;
+      Track<Quaternion> rot;
+      Track<Vec3D> scale;
+    };
+
+    size_t m_anim;
+    uint32 m_length;
+    std::vector<BoneTracks> m_bones;
+    std::vector<size_t> m_order; // parents before children
+};
+
+// Bakes model animations on worker threads.
+// Results are shared and cached by (model fileDataId, animation, rate)
+class _ANIMATIONBAKER_API_ AnimationBaker
+{
+  public:
+    typedef std::shared_ptr<const BakedAnimation> BakedAnimationPtr;
+
+    static AnimationBaker & instance();
+
+    // must be called from the thread owning the model, only sampling runs in parallel
+    BakedAnimationPtr bake(WoWModel * model, size_t anim, uint32 rate);
+    std::vector<BakedAnimationPtr> bake(WoWModel * model, const std::vector<int> & anims, uint32 rate);
+
+    void clear();
+
+  private:
+    AnimationBaker() {}
+
+    struct Key
+    {
+      int fileDataId;
+      size_t anim;
+      uint32 rate;
+
+      bool operator<(const Key & k) const
+      {
+        if (fileDataId != k.fileDataId)
+          return fileDataId < k.fileDataId;
+        if (anim != k.anim)
+          return anim < k.anim;
+        return rate < k.rate;
+      }
+    };
+
+    static const size_t CACHE_SIZE = 64;
+
+    BakedAnimationPtr find(const Key & key);
+    void store(const Key & key, BakedAnimationPtr anim);
+
+    QMutex m_mutex;
+    std::map<Key, BakedAnimationPtr> m_cache;
+    std::list<Key> m_cacheOrder; // oldest first
+};
+
+#endif
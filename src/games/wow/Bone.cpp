@@ -94,3 +94,69 @@ void Bone::initV3(GameFile & f, ModelBoneDef &b, const modelAnimData & data)
 	scale.fix(fixCoordSystem2);
 }
 
+void Bone::loadAnimation(size_t anim, GameFile & animfile)
+{
+	trans.load(anim, animfile);
+	rot.load(anim, animfile);
+	scale.load(anim, animfile);
+}
+
+void Bone::unloadAnimation(size_t anim)
+{
+	trans.unload(anim);
+	rot.unload(anim);
+	scale.unload(anim);
+}
+
+
+size_t BoneLookup::key(int x, int y, int z, int32 unknown)
+{
+  return ((size_t)x * 73856093u) ^ ((size_t)y * 19349663u) ^ ((size_t)z * 83492791u) ^ ((size_t)unknown * 2654435761u);
+}
+
+void BoneLookup::build(const std::vector<Bone> & bones)
+{
+  m_cells.clear();
+  m_bones = &bones;
+
+  for (size_t i = 0; i < bones.size(); i++)
+  {
+    const Vec3D & p = bones[i].pivot;
+    m_cells[key((int)floor(p.x), (int)floor(p.y), (int)floor(p.z), bones[i].boneDef.unknown)].push_back((int16)i);
+  }
+}
+
+int16 BoneLookup::find(const Vec3D & pivot, int32 unknown) const
+{
+  if (!m_bones)
+    return -1;
+
+  int16 result = -1;
+  const int cx = (int)floor(pivot.x);
+  const int cy = (int)floor(pivot.y);
+  const int cz = (int)floor(pivot.z);
+
+  // pivot may be close to a cell border, look in neighbour cells as well
+  for (int x = cx - 1; x <= cx + 1; x++)
+  {
+    for (int y = cy - 1; y <= cy + 1; y++)
+    {
+      for (int z = cz - 1; z <= cz + 1; z++)
+      {
+        auto it = m_cells.find(key(x, y, z, unknown));
+        if (it == m_cells.end())
+          continue;
+
+        for (auto b : it->second)
+        {
+          const Bone & bone = (*m_bones)[b];
+          if ((result == -1 || b < result) &&
+              (bone.pivot == pivot) && (bone.boneDef.unknown == unknown))
+            result = b;
+        }
+      }
+    }
+  }
+
+  return result;
+}
@@ -8,6 +8,9 @@
 #ifndef _BONE_H_
 #define _BONE_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "animated.h"
 #include "matrix.h"
 #include "modelheaders.h" // ModelBoneDef
@@ -37,6 +40,29 @@ public:
 	bool calc;
 	void calcMatrix(std::vector<Bone> & allbones, ssize_t anim, size_t time, bool rotate=true);
   void initV3(GameFile & f, ModelBoneDef &b, const modelAnimData & data);
+
+  // keys of animations stored in external .anim files (see WoWModel::loadAnimation)
+  bool isExternal(size_t anim) const { return trans.isExternal(anim) || rot.isExternal(anim) || scale.isExternal(anim); }
+  void loadAnimation(size_t anim, GameFile & animfile);
+  void unloadAnimation(size_t anim);
+};
+
+// spatial index used to match bones between models (pivot + boneDef.unknown)
+// pivots are hashed in cells of one unit, final test still uses Vec3D operator==
+class BoneLookup {
+public:
+  void build(const std::vector<Bone> & bones);
+  void clear() { m_cells.clear(); m_bones = 0; }
+  bool empty() const { return m_bones == 0; }
+
+  // index of the first bone matching pivot and unknown value, -1 if none
+  int16 find(const Vec3D & pivot, int32 unknown) const;
+
+private:
+  static size_t key(int x, int y, int z, int32 unknown);
+
+  std::unordered_map<size_t, std::vector<int16> > m_cells;
+  const std::vector<Bone> * m_bones = 0;
 };
 
 
@@ -13,8 +13,11 @@
 #include "CascLib.h"
 
 #include "CASCChunks.h"
+#include "CASCFolder.h"
 #include "Game.h"
 #include "logger/Logger.h"
+
+#include <QMutex>
 // #define DEBUG_READ
 
 std::vector<std::string> KNOWN_CHUNKS =
@@ -105,6 +108,7 @@ size_t CASCFile::read(void* dest, size_t bytes)
   }
   else
   {
+    QMutexLocker locker(&CASCFolder::accessMutex());
     unsigned long result = 0;
     if (!CascReadFile(m_handle, dest, bytes, &result))
       LOG_ERROR << "Reading" << filepath << "failed." << "Error" << GetLastError();
@@ -121,6 +125,7 @@ void CASCFile::seek(size_t offset)
   }
   else
   {
+    QMutexLocker locker(&CASCFolder::accessMutex());
     if (CascSetFilePointer(m_handle, offset, 0, FILE_BEGIN) == CASC_INVALID_POS)
       LOG_ERROR << "Seek in file" << filepath << "to position" << offset << "failed. Error" << GetLastError();
   }
@@ -128,6 +133,7 @@ void CASCFile::seek(size_t offset)
 
 bool  CASCFile::openFile()
 {
+  // storage access is serialized by CASCFolder
   if ((m_fileDataId > 0 && GAMEDIRECTORY.openFile(m_fileDataId, &m_handle))
       || GAMEDIRECTORY.openFile(filepath.toStdString(), &m_handle))
   {
@@ -151,6 +157,7 @@ bool CASCFile::getFileSize(unsigned long long & s)
   
   if (m_handle)
   {
+    QMutexLocker locker(&CASCFolder::accessMutex());
     s = CascGetFileSize(m_handle, 0);
   
     if (s == CASC_INVALID_SIZE)
@@ -165,7 +172,8 @@ bool CASCFile::getFileSize(unsigned long long & s)
 unsigned long CASCFile::readFile()
 {
   unsigned long result = 0;
-  
+
+  QMutexLocker locker(&CASCFolder::accessMutex());
   if (!CascReadFile(m_handle, buffer, size, &result))
     LOG_ERROR << "Reading" << filepath << "failed." << "Error" << GetLastError();
   
@@ -217,6 +225,7 @@ bool CASCFile::doPostCloseOperation()
 #endif
   if(m_handle)
   {
+    QMutexLocker locker(&CASCFolder::accessMutex());
     HANDLE savedHandle = m_handle;
     m_handle = 0;
 
@@ -17,11 +17,14 @@
 #include <utility>
 
 #include <QFile>
+#include <QMutex>
 #include <QRegularExpression>
 
 #include "CASCFile.h"
 #include "logger/Logger.h"
 
+static QMutex s_cascAccessMutex(QMutex::Recursive);
+
 CASCFolder::CASCFolder()
  : m_currentCascLocale(CASC_LOCALE_NONE), m_folder(""), m_openError(ERROR_SUCCESS), hStorage(nullptr)
 {
@@ -178,6 +181,7 @@ bool CASCFolder::fileExists(int id)
   if(!hStorage)
     return false;
 
+  QMutexLocker locker(&s_cascAccessMutex);
   HANDLE dummy;
 
   if(CascOpenFile(hStorage, CASC_FILE_DATA_ID(id), m_currentCascLocale, CASC_OPEN_BY_FILEID, &dummy))
@@ -192,14 +196,21 @@ bool CASCFolder::fileExists(int id)
 
 bool CASCFolder::openFile(int id, HANDLE * result)
 {
+  QMutexLocker locker(&s_cascAccessMutex);
   return CascOpenFile(hStorage, CASC_FILE_DATA_ID(id), m_currentCascLocale, CASC_OPEN_BY_FILEID, result);
 }
 
 bool CASCFolder::closeFile(HANDLE file)
 {
+  QMutexLocker locker(&s_cascAccessMutex);
   return CascCloseFile(file);
 }
 
+QMutex & CASCFolder::accessMutex()
+{
+  return s_cascAccessMutex;
+}
+
 void CASCFolder::addExtraEncryptionKeys()
 {
   QFile tactKeys("extraEncryptionKeys.csv");
@@ -11,6 +11,7 @@
 #include <vector>
 
 typedef void* HANDLE;
+class QMutex;
 
 #include "GameFolder.h" // GameConfig
 
@@ -44,6 +45,10 @@ class _CASCFOLDER_API_ CASCFolder
     bool openFile(int id, HANDLE * result);
     bool closeFile(HANDLE file);
 
+    // CASC storage is shared by all files, accesses to it are serialized as files can be
+    // opened from worker threads (model loader, WMO groups streaming, etc.)
+    static QMutex & accessMutex();
+
     // int fileDataId(std::string & filename);
 
   private:
@@ -0,0 +1,51 @@
+/*
+ * CatalogueLoader.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "CatalogueLoader.h"
+
+#include <algorithm>
+
+#include <QThread>
+
+#include "CharTexture.h"
+#include "database.h"
+#include "RaceInfos.h"
+
+#include "logger/Logger.h"
+
+CatalogueLoader::CatalogueLoader()
+  : m_itemsFound(false), m_npcsFound(false)
+{
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+CatalogueLoader::~CatalogueLoader()
+{
+  m_pool.waitForDone();
+}
+
+void CatalogueLoader::start()
+{
+  // catalogues don't share any data, they can be built in any order
+  m_pool.start(new Worker([this]() { m_itemsFound = items.init(); }));
+  m_pool.start(new Worker([this]() { m_npcsFound = initNPCs(); }));
+  m_pool.start(new Worker([]() { RaceInfos::init(); }));
+  m_pool.start(new Worker([]() { CharTexture::initRegions(); }));
+}
+
+bool CatalogueLoader::wait()
+{
+  m_pool.waitForDone();
+
+  if (!m_npcsFound)
+    LOG_ERROR << "Error during NPC detection from database.";
+
+  if (!m_itemsFound)
+    LOG_ERROR << "Error during Item detection from database.";
+
+  return m_itemsFound && m_npcsFound;
+}
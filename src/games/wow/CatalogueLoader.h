@@ -0,0 +1,57 @@
+/*
+ * CatalogueLoader.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _CATALOGUELOADER_H_
+#define _CATALOGUELOADER_H_
+
+#include <functional>
+
+#include <QRunnable>
+#include <QThreadPool>
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _CATALOGUELOADER_API_ __declspec(dllexport)
+#    else
+#        define _CATALOGUELOADER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _CATALOGUELOADER_API_
+#endif
+
+// Builds startup catalogues (texture layouts, races, items and npcs) straight from
+// game database files, each one in a worker thread. As no sql query is involved,
+// this can run while sql database is being filled, once its structure is read
+// (see GameDatabase::readStructure).
+class _CATALOGUELOADER_API_ CatalogueLoader
+{
+  public:
+    CatalogueLoader();
+    ~CatalogueLoader();
+
+    void start();
+
+    // waits for all catalogues, false if items or npcs could not be found
+    bool wait();
+
+  private:
+    class Worker : public QRunnable
+    {
+      public:
+        explicit Worker(std::function<void()> job) : m_job(job) {}
+        void run() { m_job(); }
+
+      private:
+        std::function<void()> m_job;
+    };
+
+    QThreadPool m_pool;
+    bool m_itemsFound;
+    bool m_npcsFound;
+};
+
+#endif /* _CATALOGUELOADER_H_ */
@@ -9,6 +9,7 @@
 
 #include "animated.h" // randint
 #include "CharDetailsEvent.h"
+#include "CharSectionsTable.h"
 #include "Game.h"
 #include "WoWModel.h"
 #include "logger/Logger.h"
@@ -269,69 +270,46 @@ std::vector<int> CharDetails::getTextureForSection(SectionType section)
     type = getSectionType(type, infos.isHD);
   }
 
-  QString query = QString("SELECT TFD1.TextureID, TFD2.TextureID, TFD3.TextureID FROM CharSections "
-                          "LEFT JOIN TextureFileData AS TFD1 ON TextureName1 = TFD1.ID "
-                          "LEFT JOIN TextureFileData AS TFD2 ON TextureName2 = TFD2.ID "
-                          "LEFT JOIN TextureFileData AS TFD3 ON TextureName3 = TFD3.ID ");
+  // variation / color of the section to look for (-1 = any)
+  int variation = -1;
+  int color = -1;
+
   switch (section)
   {
     case SkinType:
     case UnderwearType:
-      query += QString("WHERE (RaceID=%1 AND SexID=%2 AND ColorIndex=%3 AND SectionType=%4)")
-        .arg(infos.raceid)
-        .arg(infos.sexid)
-        .arg(m_currentCustomization[SKIN_COLOR])
-        .arg(type);
+      color = m_currentCustomization[SKIN_COLOR];
       break;
     case FaceType:
-      query += QString("WHERE (RaceID=%1 AND SexID=%2 AND ColorIndex=%3 AND VariationIndex=%4 AND SectionType=%5)")
-        .arg(infos.raceid)
-        .arg(infos.sexid)
-        .arg(m_currentCustomization[SKIN_COLOR])
-        .arg(m_currentCustomization[FACE])
-        .arg(type);
+      color = m_currentCustomization[SKIN_COLOR];
+      variation = m_currentCustomization[FACE];
       break;
     case HairType:
-      query += QString("WHERE (RaceID=%1 AND SexID=%2 AND VariationIndex=%3 AND ColorIndex=%4 AND SectionType=%5)")
-        .arg(infos.raceid)
-        .arg(infos.sexid)
-        .arg((m_currentCustomization[FACIAL_CUSTOMIZATION_STYLE] == 0) ? 1 : m_currentCustomization[FACIAL_CUSTOMIZATION_STYLE]) // quick fix for bald characters... VariationIndex = 0 returns no result
-        .arg(m_currentCustomization[FACIAL_CUSTOMIZATION_COLOR])
-        .arg(type);
+      variation = (m_currentCustomization[FACIAL_CUSTOMIZATION_STYLE] == 0) ? 1 : m_currentCustomization[FACIAL_CUSTOMIZATION_STYLE]; // quick fix for bald characters... VariationIndex = 0 returns no result
+      color = m_currentCustomization[FACIAL_CUSTOMIZATION_COLOR];
       break;
     case FacialHairType:
-      query += QString("WHERE (RaceID=%1 AND SexID=%2 AND VariationIndex=%3 AND ColorIndex=%4 AND SectionType=%5)")
-        .arg(infos.raceid)
-        .arg(infos.sexid)
-        .arg(m_currentCustomization[ADDITIONAL_FACIAL_CUSTOMIZATION])
-        .arg(m_currentCustomization[FACIAL_CUSTOMIZATION_COLOR])
-        .arg(type);
+      variation = m_currentCustomization[ADDITIONAL_FACIAL_CUSTOMIZATION];
+      color = m_currentCustomization[FACIAL_CUSTOMIZATION_COLOR];
       break;
     case TattooType:
-      query += QString("WHERE (RaceID=%1 AND SexID=%2 AND VariationIndex=%3 AND SectionType=%4)")
-        .arg(infos.raceid)
-        .arg(infos.sexid)
-        .arg((m_customizationParamsMap[DH_TATTOO_STYLE].possibleValues.size() - 1) * m_currentCustomization[DH_TATTOO_COLOR] + m_currentCustomization[DH_TATTOO_STYLE])
-        .arg(type);
+      variation = (m_customizationParamsMap[DH_TATTOO_STYLE].possibleValues.size() - 1) * m_currentCustomization[DH_TATTOO_COLOR] + m_currentCustomization[DH_TATTOO_STYLE];
       break;
     default:
-      query = "";
+      return result;
   }
 
-  if (query != "")
+  const CharSectionsTable::Section * s = CharSectionsTable::find(infos.raceid, infos.sexid, type, variation, color);
+  if (s)
   {
-    sqlResult vals = GAMEDATABASE.sqlQuery(query);
-    if (vals.valid && !vals.values.empty())
-    {
-      for (size_t i = 0; i < vals.values[0].size(); i++)
-        if (!vals.values[0][i].isEmpty())
-          result.push_back(vals.values[0][i].toInt());
-    }
-    else
-    {
-      LOG_ERROR << "Unable to collect infos for model";
-      LOG_ERROR << query << vals.valid << vals.values.size();
-    }
+    for (size_t i = 0; i < 3; i++)
+      if (s->textures[i] != 0)
+        result.push_back(s->textures[i]);
+  }
+  else
+  {
+    LOG_ERROR << "Unable to collect infos for model";
+    LOG_ERROR << "race" << infos.raceid << "sex" << infos.sexid << "section" << type << "variation" << variation << "color" << color;
   }
 
   return result;
@@ -361,22 +339,10 @@ void CharDetails::fillCustomizationMap()
   CustomizationParam skin;
   skin.name = "Skin";
 
-  QString query = QString("SELECT ColorIndex FROM CharSections WHERE RaceID=%1 AND SexID=%2 AND SectionType=%3")
-    .arg(infos.raceid)
-    .arg(infos.sexid)
-    .arg(getSectionType(SkinType, infos.isHD));
+  skin.possibleValues = CharSectionsTable::colors(infos.raceid, infos.sexid, getSectionType(SkinType, infos.isHD));
 
-  sqlResult vals = GAMEDATABASE.sqlQuery(query);
-
-  if (vals.valid && !vals.values.empty())
-  {
-    for (uint i = 0; i < vals.values.size(); i++)
-      skin.possibleValues.push_back(vals.values[i][0].toInt());
-  }
-  else
-  {
+  if (skin.possibleValues.empty())
     LOG_ERROR << "Unable to collect skin parameters for model" << m_model->name();
-  }
 
   m_customizationParamsMap.insert({ SKIN_COLOR, skin });
 
@@ -384,27 +350,12 @@ void CharDetails::fillCustomizationMap()
   // face possible customization depends on current skin color. We fill m_multiCustomizationMap first
   for (auto it = skin.possibleValues.begin(), itEnd = skin.possibleValues.end(); it != itEnd; ++it)
   {
-    query = QString("SELECT DISTINCT VariationIndex FROM CharSections WHERE RaceID=%1 "
-                    "AND SexID=%2 AND ColorIndex=%3 AND SectionType=%4")
-                    .arg(infos.raceid)
-                    .arg(infos.sexid)
-                    .arg(*it)
-                    .arg(getSectionType(FaceType, infos.isHD));
-
-    sqlResult faces = GAMEDATABASE.sqlQuery(query);
-
     CustomizationParam face;
     face.name = "Face";
+    face.possibleValues = CharSectionsTable::variations(infos.raceid, infos.sexid, getSectionType(FaceType, infos.isHD), *it);
 
-    if (faces.valid && !faces.values.empty())
-    {
-      for (uint i = 0; i < faces.values.size(); i++)
-        face.possibleValues.push_back(faces.values[i][0].toInt());
-    }
-    else
-    {
+    if (face.possibleValues.empty())
       LOG_ERROR << "No face customization available for skin color" << *it << "for model" << m_model->name();
-    }
 
     m_multiCustomizationMap[FACE].insert({ *it, face });
   }
@@ -413,23 +364,15 @@ void CharDetails::fillCustomizationMap()
 
   // starting from here, customization may differ based on database values
   // get customization names
-  query = QString("SELECT HairCustomization, FacialHairCustomization%1 FROM ChrRacesCustomization WHERE ID = %2")
-    .arg(infos.sexid + 1)
-    .arg(infos.raceid);
-
-  sqlResult names = GAMEDATABASE.sqlQuery(query);
-
-  QString facialCustomizationBaseName;
-  QString additionalCustomizationName;
+  QString facialCustomizationBaseName = CharSectionsTable::hairCustomization(infos.raceid);
+  QString additionalCustomizationName = CharSectionsTable::facialHairCustomization(infos.raceid, infos.sexid);
 
-  if (names.valid && !names.values.empty())
+  if (!facialCustomizationBaseName.isEmpty() && !additionalCustomizationName.isEmpty())
   {
-    facialCustomizationBaseName = names.values[0][0];
     facialCustomizationBaseName = facialCustomizationBaseName.at(0).toUpper() + facialCustomizationBaseName.mid(1).toLower();
     if (facialCustomizationBaseName == "Normal")
       facialCustomizationBaseName = "Hair";
 
-    additionalCustomizationName = names.values[0][1];
     additionalCustomizationName = additionalCustomizationName.at(0).toUpper() + additionalCustomizationName.mid(1).toLower();
     if (additionalCustomizationName == "Normal")
       additionalCustomizationName = "Facial Hair";
@@ -440,25 +383,12 @@ void CharDetails::fillCustomizationMap()
   }
 
   // facial style customization
-  query = QString("SELECT DISTINCT VariationIndex FROM CharSections WHERE RaceID = %1 AND SexID = %2 AND SectionType = %3")
-    .arg(infos.raceid)
-    .arg(infos.sexid)
-    .arg(getSectionType(HairType, infos.isHD));
-
-  sqlResult styles = GAMEDATABASE.sqlQuery(query);
-
   CustomizationParam facialCustomizationStyle;
   facialCustomizationStyle.name = QString(facialCustomizationBaseName + " Style");
+  facialCustomizationStyle.possibleValues = CharSectionsTable::variations(infos.raceid, infos.sexid, getSectionType(HairType, infos.isHD));
 
-  if (styles.valid && !styles.values.empty())
-  {
-    for (uint i = 0; i < styles.values.size(); i++)
-      facialCustomizationStyle.possibleValues.push_back(styles.values[i][0].toInt());
-  }
-  else
-  {
+  if (facialCustomizationStyle.possibleValues.empty())
     LOG_ERROR << "Unable to facial style parameters for model" << m_model->name();
-  }
 
   m_customizationParamsMap.insert({ FACIAL_CUSTOMIZATION_STYLE, facialCustomizationStyle });
 
@@ -466,27 +396,12 @@ void CharDetails::fillCustomizationMap()
   // facial color customization depends on current facial style. We fill m_multiCustomizationMap first
   for (auto it = facialCustomizationStyle.possibleValues.begin(), itEnd = facialCustomizationStyle.possibleValues.end(); it != itEnd; ++it)
   {
-    query = QString("SELECT DISTINCT ColorIndex FROM CharSections WHERE RaceID = %1 AND SexID = %2 "
-                    "AND SectionType = %3 AND VariationIndex = %4")
-                    .arg(infos.raceid)
-                    .arg(infos.sexid)
-                    .arg(getSectionType(HairType, infos.isHD))
-                    .arg(*it);
-
-    sqlResult colors = GAMEDATABASE.sqlQuery(query);
-
     CustomizationParam facialColor;
     facialColor.name = QString(facialCustomizationBaseName + " Color");
+    facialColor.possibleValues = CharSectionsTable::colors(infos.raceid, infos.sexid, getSectionType(HairType, infos.isHD), *it);
 
-    if (colors.valid && !colors.values.empty())
-    {
-      for (uint i = 0; i < colors.values.size(); i++)
-        facialColor.possibleValues.push_back(colors.values[i][0].toInt());
-    }
-    else
-    {
+    if (facialColor.possibleValues.empty())
       LOG_ERROR << "No facial color available for facial customization style " << *it << "for model" << m_model->name();
-    }
 
     m_multiCustomizationMap[FACIAL_CUSTOMIZATION_COLOR].insert({ *it, facialColor });
   }
@@ -494,24 +409,12 @@ void CharDetails::fillCustomizationMap()
   m_customizationParamsMap.insert({ FACIAL_CUSTOMIZATION_COLOR, m_multiCustomizationMap[FACIAL_CUSTOMIZATION_COLOR][m_currentCustomization[FACIAL_CUSTOMIZATION_STYLE]] });
 
   // addtional facial customization
-  query = QString("SELECT DISTINCT VariationID FROM CharacterFacialHairStyles WHERE RaceID = %1 AND SexID = %2")
-    .arg(infos.raceid)
-    .arg(infos.sexid);
-
-  sqlResult additional = GAMEDATABASE.sqlQuery(query);
-
   CustomizationParam additionalCustomization;
   additionalCustomization.name = additionalCustomizationName;
+  additionalCustomization.possibleValues = CharSectionsTable::facialHairStyles(infos.raceid, infos.sexid);
 
-  if (additional.valid && !additional.values.empty())
-  {
-    for (uint i = 0; i < additional.values.size(); i++)
-      additionalCustomization.possibleValues.push_back(additional.values[i][0].toInt());
-  }
-  else
-  {
+  if (additionalCustomization.possibleValues.empty())
     LOG_ERROR << "Unable to collect additional facial customization parameters for model" << m_model->name();
-  }
 
   m_customizationParamsMap.insert({ ADDITIONAL_FACIAL_CUSTOMIZATION, additionalCustomization });
 
@@ -520,14 +423,7 @@ void CharDetails::fillCustomizationMap()
   CustomizationParam tattoos;
   tattoos.name = "Tattoo";
 
-  query = QString("SELECT ColorIndex FROM CharSections WHERE RaceID=%1 AND SexID=%2 AND SectionType=%3")
-    .arg(infos.raceid)
-    .arg(infos.sexid)
-    .arg(TattooType);
-
-  vals = GAMEDATABASE.sqlQuery(query);
-
-  if (vals.valid && (vals.values.size() > 1))
+  if (CharSectionsTable::sections(infos.raceid, infos.sexid, TattooType).size() > 1)
   {
     // harcoded for now (dh tattoos are 36 sequential values in CharSections table...)
     // tattoo style = 0 to 6 (0 = no tattoo)
@@ -0,0 +1,177 @@
+/*
+ * CharSectionsTable.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "CharSectionsTable.h"
+
+#include <algorithm>
+
+#include "Game.h"
+#include "WoWDatabase.h"
+
+#include "logger/Logger.h"
+
+std::map<int, CharSectionsTable::SectionList> CharSectionsTable::SECTIONS;
+std::map<int, std::vector<int> > CharSectionsTable::FACIAL_HAIR_STYLES;
+std::map<int, QString> CharSectionsTable::HAIR_CUSTOMIZATION;
+std::map<int, QString> CharSectionsTable::FACIAL_HAIR_CUSTOMIZATION;
+
+void CharSectionsTable::init()
+{
+  SECTIONS.clear();
+  FACIAL_HAIR_STYLES.clear();
+  HAIR_CUSTOMIZATION.clear();
+  FACIAL_HAIR_CUSTOMIZATION.clear();
+
+  sqlResult sections =
+    GAMEDATABASE.sqlQuery("SELECT RaceID, SexID, SectionType, VariationIndex, ColorIndex, "
+                          "TFD1.TextureID, TFD2.TextureID, TFD3.TextureID FROM CharSections "
+                          "LEFT JOIN TextureFileData AS TFD1 ON TextureName1 = TFD1.ID "
+                          "LEFT JOIN TextureFileData AS TFD2 ON TextureName2 = TFD2.ID "
+                          "LEFT JOIN TextureFileData AS TFD3 ON TextureName3 = TFD3.ID");
+
+  if (!sections.valid || sections.empty())
+  {
+    LOG_ERROR << "Unable to collect character sections from game database";
+  }
+  else
+  {
+    for (auto & value : sections.values)
+    {
+      Section s;
+      s.variation = value[3].toInt();
+      s.color = value[4].toInt();
+      for (size_t i = 0; i < 3; i++)
+        s.textures[i] = value[5 + i].toInt();
+
+      SectionList & list = SECTIONS[key(value[0].toInt(), value[1].toInt(), value[2].toInt())];
+
+      // several texture file data may match a section, keep first one as database queries did
+      if (list.index.insert({ { s.variation, s.color }, list.sections.size() }).second)
+        list.sections.push_back(s);
+    }
+  }
+
+  sqlResult styles = GAMEDATABASE.sqlQuery("SELECT RaceID, SexID, VariationID FROM CharacterFacialHairStyles");
+
+  if (!styles.valid || styles.empty())
+  {
+    LOG_ERROR << "Unable to collect facial hair styles from game database";
+  }
+  else
+  {
+    for (auto & value : styles.values)
+    {
+      std::vector<int> & list = FACIAL_HAIR_STYLES[key(value[0].toInt(), value[1].toInt())];
+      int variation = value[2].toInt();
+      if (std::find(list.begin(), list.end(), variation) == list.end())
+        list.push_back(variation);
+    }
+  }
+
+  sqlResult names = GAMEDATABASE.sqlQuery("SELECT ID, HairCustomization, FacialHairCustomization1, "
+                                          "FacialHairCustomization2 FROM ChrRacesCustomization");
+
+  if (!names.valid || names.empty())
+  {
+    LOG_ERROR << "Unable to collect customization names from game database";
+  }
+  else
+  {
+    for (auto & value : names.values)
+    {
+      int race = value[0].toInt();
+      HAIR_CUSTOMIZATION[race] = value[1];
+      FACIAL_HAIR_CUSTOMIZATION[key(race, 0)] = value[2];
+      FACIAL_HAIR_CUSTOMIZATION[key(race, 1)] = value[3];
+    }
+  }
+
+  LOG_INFO << "Character customization tables loaded -" << SECTIONS.size() << "section lists";
+}
+
+const std::vector<CharSectionsTable::Section> & CharSectionsTable::sections(int race, int sex, int type)
+{
+  static const std::vector<Section> empty;
+
+  auto it = SECTIONS.find(key(race, sex, type));
+  if (it == SECTIONS.end())
+    return empty;
+
+  return it->second.sections;
+}
+
+const CharSectionsTable::Section * CharSectionsTable::find(int race, int sex, int type, int variation, int color)
+{
+  auto it = SECTIONS.find(key(race, sex, type));
+  if (it == SECTIONS.end())
+    return 0;
+
+  const SectionList & list = it->second;
+
+  if (variation != -1 && color != -1)
+  {
+    auto index = list.index.find({ variation, color });
+    return (index != list.index.end()) ? &list.sections[index->second] : 0;
+  }
+
+  for (auto & s : list.sections)
+  {
+    if ((variation == -1 || s.variation == variation) && (color == -1 || s.color == color))
+      return &s;
+  }
+
+  return 0;
+}
+
+std::vector<int> CharSectionsTable::colors(int race, int sex, int type, int variation)
+{
+  std::vector<int> result;
+
+  for (auto & s : sections(race, sex, type))
+  {
+    if ((variation == -1 || s.variation == variation) &&
+        std::find(result.begin(), result.end(), s.color) == result.end())
+      result.push_back(s.color);
+  }
+
+  return result;
+}
+
+std::vector<int> CharSectionsTable::variations(int race, int sex, int type, int color)
+{
+  std::vector<int> result;
+
+  for (auto & s : sections(race, sex, type))
+  {
+    if ((color == -1 || s.color == color) &&
+        std::find(result.begin(), result.end(), s.variation) == result.end())
+      result.push_back(s.variation);
+  }
+
+  return result;
+}
+
+std::vector<int> CharSectionsTable::facialHairStyles(int race, int sex)
+{
+  auto it = FACIAL_HAIR_STYLES.find(key(race, sex));
+  if (it == FACIAL_HAIR_STYLES.end())
+    return std::vector<int>();
+
+  return it->second;
+}
+
+QString CharSectionsTable::hairCustomization(int race)
+{
+  auto it = HAIR_CUSTOMIZATION.find(race);
+  return (it != HAIR_CUSTOMIZATION.end()) ? it->second : QString();
+}
+
+QString CharSectionsTable::facialHairCustomization(int race, int sex)
+{
+  auto it = FACIAL_HAIR_CUSTOMIZATION.find(key(race, sex));
+  return (it != FACIAL_HAIR_CUSTOMIZATION.end()) ? it->second : QString();
+}
@@ -0,0 +1,75 @@
+/*
+ * CharSectionsTable.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _CHARSECTIONSTABLE_H_
+#define _CHARSECTIONSTABLE_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <QString>
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _CHARSECTIONSTABLE_API_ __declspec(dllexport)
+#    else
+#        define _CHARSECTIONSTABLE_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _CHARSECTIONSTABLE_API_
+#endif
+
+// In memory copy of character customization tables (CharSections, CharacterFacialHairStyles
+// and ChrRacesCustomization), read once (see init) and indexed by race / sex / section type,
+// so that customization options and textures are found without any database query.
+// Records keep database order, as options are displayed in this order.
+class _CHARSECTIONSTABLE_API_ CharSectionsTable
+{
+  public:
+    struct Section
+    {
+      int variation;
+      int color;
+      int textures[3]; // file data ids, 0 if none
+    };
+
+    static void init();
+
+    // all sections of given type for a race / sex
+    static const std::vector<Section> & sections(int race, int sex, int type);
+
+    // first section matching given variation and color (-1 matches any value), null if none
+    static const Section * find(int race, int sex, int type, int variation, int color);
+
+    // distinct colors (resp. variations) of a section type, optionally restricted
+    // to a given variation (resp. color)
+    static std::vector<int> colors(int race, int sex, int type, int variation = -1);
+    static std::vector<int> variations(int race, int sex, int type, int color = -1);
+
+    static std::vector<int> facialHairStyles(int race, int sex);
+
+    // customization names, as found in ChrRacesCustomization (empty if none)
+    static QString hairCustomization(int race);
+    static QString facialHairCustomization(int race, int sex);
+
+  private:
+    struct SectionList
+    {
+      std::vector<Section> sections;
+      std::map<std::pair<int, int>, size_t> index; // (variation, color) -> first section
+    };
+
+    static int key(int race, int sex, int type = 0) { return (race << 16) | (sex << 8) | type; }
+
+    static std::map<int, SectionList> SECTIONS;
+    static std::map<int, std::vector<int> > FACIAL_HAIR_STYLES;
+    static std::map<int, QString> HAIR_CUSTOMIZATION;
+    static std::map<int, QString> FACIAL_HAIR_CUSTOMIZATION;
+};
+
+#endif /* _CHARSECTIONSTABLE_H_ */
@@ -8,10 +8,13 @@
 #include "CharTexture.h"
 
 
+#include <cstdlib>
 #include <map>
 #include <string>
+#include <vector>
 
 #include <QPainter>
+#include <QStringList>
 
 #include "Game.h"
 #include "GameFile.h"
@@ -83,33 +86,57 @@ void CharTexture::compose(TextureID texID)
 
 void CharTexture::initRegions()
 {
-  sqlResult layouts = GAMEDATABASE.sqlQuery("SELECT ID, Width, Height FROM CharComponentTextureLayouts");
+  LAYOUTS.clear();
 
-  if(!layouts.valid || layouts.empty())
+  // read straight from game files, no sql round-trip needed
+  std::map<int, LayoutSize> layouts;
+  bool ok = GAMEDATABASE.readTable("CharComponentTextureLayouts", QStringList() << "ID" << "Width" << "Height",
+                                   [&](const std::vector<std::string> & value)
+  {
+    LayoutSize texLayout;
+    texLayout.width = atoi(value[1].c_str());
+    texLayout.height = atoi(value[2].c_str());
+    layouts[atoi(value[0].c_str())] = texLayout;
+  });
+
+  if(!ok || layouts.empty())
   {
     LOG_ERROR << "Fail to retrieve Texture Layout information from game database";
     return;
   }
 
-  // Iterate on layout to initialize our members (sections informations)
-  for(int i=0, imax=layouts.values.size() ; i < imax ; i++)
+  std::map<int, std::map<int, CharRegionCoords> > regions; // layout -> section -> coords
+  ok = GAMEDATABASE.readTable("CharComponentTextureSections", QStringList() << "LayoutID" << "Section" << "X" << "Y" << "Width" << "Height",
+                              [&](const std::vector<std::string> & value)
   {
-    LayoutSize texLayout;
-    int curLayout = layouts.values[i][0].toInt();
-    texLayout.width = layouts.values[i][1].toInt();
-    texLayout.height = layouts.values[i][2].toInt();
+    CharRegionCoords coords;
+    coords.xpos = atoi(value[2].c_str());
+    coords.ypos = atoi(value[3].c_str());
+    coords.width = atoi(value[4].c_str());
+    coords.height = atoi(value[5].c_str());
+    regions[atoi(value[0].c_str())][atoi(value[1].c_str())] = coords;
+  });
+
+  if (!ok)
+  {
+    LOG_ERROR << "Fail to retrieve Section Layout information from game database";
+    return;
+  }
 
-    // search all regions for this layout
-    QString query = QString("SELECT Section, X, Y, Width, Height  FROM CharComponentTextureSections WHERE LayoutID = %1").arg(curLayout);
-    sqlResult regions = GAMEDATABASE.sqlQuery(query);
+  // Iterate on layout to initialize our members (sections informations)
+  for (auto & layout : layouts)
+  {
+    int curLayout = layout.first;
+    const LayoutSize & texLayout = layout.second;
 
-    if(!regions.valid || regions.empty())
+    auto layoutRegions = regions.find(curLayout);
+    if(layoutRegions == regions.end())
     {
       LOG_ERROR << "Fail to retrieve Section Layout information from game database for layout" << curLayout;
       continue;
     }
 
-    std::map<int,CharRegionCoords> regionCoords;
+    std::map<int,CharRegionCoords> regionCoords = layoutRegions->second;
     CharRegionCoords base;
     base.xpos = 0;
     base.ypos = 0;
@@ -117,16 +144,6 @@ void CharTexture::initRegions()
     base.height = texLayout.height;
     regionCoords[LAYOUT_BASE_REGION] = base;
 
-    for(int r=0, rmax=regions.values.size() ; r < rmax ; r++)
-    {
-      CharRegionCoords coords;
-      coords.xpos = regions.values[r][1].toInt();
-      coords.ypos = regions.values[r][2].toInt();
-      coords.width = regions.values[r][3].toInt();
-      coords.height = regions.values[r][4].toInt();
-      //LOG_INFO << regions.values[r][0].toInt()+1 << " " << coords.xpos << " " << coords.ypos << " " << coords.width << " " << coords.height << std::endl;
-      regionCoords[regions.values[r][0].toInt()] = coords;
-    }
     LOG_INFO << "Found" << regionCoords.size() << "regions for layout" << curLayout;
     CharTexture::LAYOUTS[curLayout] = make_pair(texLayout,regionCoords);
   }
@@ -0,0 +1,390 @@
+/*
+ * FrameSequenceWriter.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "FrameSequenceWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QByteArray>
+#include <QFileInfo>
+#include <QImage>
+#include <QRunnable>
+#include <QThread>
+
+#include "TextureExporter.h"
+
+#include "logger/Logger.h"
+
+namespace
+{
+  void appendLE16(QByteArray & data, unsigned int value)
+  {
+    data.append((char)(value & 0xFF));
+    data.append((char)((value >> 8) & 0xFF));
+  }
+
+  void appendLE32(QByteArray & data, unsigned int value)
+  {
+    appendLE16(data, value & 0xFFFF);
+    appendLE16(data, value >> 16);
+  }
+
+  void appendChunkHeader(QByteArray & data, const char * fourcc, unsigned int size)
+  {
+    data.append(fourcc, 4);
+    appendLE32(data, size);
+  }
+
+  // fixed avi header layout: RIFF + hdrl list (avih, strl list (strh, strf)) + movi list header
+  const unsigned int AVI_HDRL_SIZE = 4 + (8 + 56) + (12 + (8 + 56) + (8 + 40));
+  const qint64 AVI_MOVI_OFFSET = 12 + 8 + AVI_HDRL_SIZE; // position of movi LIST chunk
+
+  unsigned int aviStride(int width)
+  {
+    return (3 * width + 3) & ~3u; // DIB rows are 4 bytes aligned
+  }
+}
+
+class FrameSequenceWriter::FrameJob : public QRunnable
+{
+  public:
+    FrameJob(FrameSequenceWriter & writer, std::shared_ptr<Frame> frame)
+      : m_writer(writer), m_frame(frame) {}
+
+    void run()
+    {
+      m_writer.encode(*m_frame);
+      m_writer.frameDone(m_frame);
+    }
+
+  private:
+    FrameSequenceWriter & m_writer;
+    std::shared_ptr<Frame> m_frame;
+};
+
+FrameSequenceWriter::FrameSequenceWriter(const QString & file, int width, int height, int fps)
+  : m_fileName(file), m_format(AVI), m_width(width), m_height(height), m_fps(std::max(1, fps)),
+  m_nbFrames(0), m_ok(false), m_moviSize(4)
+{
+  QString suffix = QFileInfo(file).suffix().toLower();
+  if (suffix == "y4m")
+    m_format = Y4M;
+  else if (suffix == "png")
+    m_format = PNG;
+
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+  m_maxQueuedFrames = 2 * m_pool.maxThreadCount();
+}
+
+FrameSequenceWriter::~FrameSequenceWriter()
+{
+  close();
+}
+
+bool FrameSequenceWriter::canWrite(const QString & file)
+{
+  QString suffix = QFileInfo(file).suffix().toLower();
+  return (suffix == "avi" || suffix == "y4m" || suffix == "png");
+}
+
+bool FrameSequenceWriter::open()
+{
+  if (!canWrite(m_fileName) || m_width <= 0 || m_height <= 0)
+  {
+    LOG_ERROR << "Unsupported video for frame sequence writer" << m_fileName << m_width << "x" << m_height;
+    return false;
+  }
+
+  m_nbFrames = 0;
+  m_ok = true;
+
+  // each png frame goes to its own file
+  if (m_format == PNG)
+    return true;
+
+  m_file.setFileName(m_fileName);
+  if (!m_file.open(QIODevice::WriteOnly))
+  {
+    LOG_ERROR << "Unable to open" << m_fileName << "for writing";
+    m_ok = false;
+    return false;
+  }
+
+  QByteArray header;
+  if (m_format == AVI)
+  {
+    // frame count and sizes are patched by close()
+    m_chunkSizes.clear();
+    m_moviSize = 4;
+    header = aviHeader();
+  }
+  else
+  {
+    header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C444\n").arg(m_width).arg(m_height).arg(m_fps).toLatin1();
+  }
+
+  if (m_file.write(header) != header.size())
+  {
+    LOG_ERROR << "Error while writing" << m_fileName;
+    m_ok = false;
+  }
+
+  return m_ok;
+}
+
+bool FrameSequenceWriter::addFrame(const unsigned char * pixels)
+{
+  std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+  frame->pixels.assign(pixels, pixels + 4 * (size_t)m_width * m_height);
+  frame->ok = true;
+  frame->done = false;
+
+  {
+    QMutexLocker lock(&m_mutex);
+
+    // render thread waits for encoders when queue is full
+    while (m_frames.size() >= m_maxQueuedFrames)
+      m_frameWritten.wait(&m_mutex);
+
+    if (!m_ok)
+      return false;
+
+    frame->index = m_nbFrames++;
+    m_frames.push_back(frame);
+  }
+
+  m_pool.start(new FrameJob(*this, frame));
+
+  return true;
+}
+
+bool FrameSequenceWriter::close()
+{
+  m_pool.waitForDone();
+
+  if (!m_file.isOpen())
+    return m_ok;
+
+  if (m_ok && m_format == AVI)
+  {
+    // index: chunk offsets are relative to 'movi' fourcc
+    QByteArray index;
+    appendChunkHeader(index, "idx1", 16 * (unsigned int)m_chunkSizes.size());
+    unsigned int offset = 4;
+    for (size_t i = 0; i < m_chunkSizes.size(); i++)
+    {
+      index.append("00db", 4);
+      appendLE32(index, 0x10); // AVIIF_KEYFRAME
+      appendLE32(index, offset);
+      appendLE32(index, m_chunkSizes[i]);
+      offset += 8 + m_chunkSizes[i];
+    }
+
+    QByteArray header = aviHeader();
+    m_ok = (m_file.write(index) == index.size()) &&
+           m_file.seek(0) && (m_file.write(header) == header.size());
+
+    if (!m_ok)
+      LOG_ERROR << "Error while writing" << m_fileName;
+  }
+
+  m_file.close();
+  return m_ok;
+}
+
+void FrameSequenceWriter::encode(Frame & frame) const
+{
+  const unsigned char * pixels = &frame.pixels[0];
+  const size_t lineSize = 4 * m_width;
+
+  switch (m_format)
+  {
+    case AVI:
+    {
+      // DIB rows are bottom up, like GL ones
+      const unsigned int stride = aviStride(m_width);
+      frame.data.assign(stride * m_height, 0);
+      for (int y = 0; y < m_height; y++)
+      {
+        const unsigned char * src = pixels + y * lineSize;
+        unsigned char * dst = &frame.data[y * stride];
+        for (int x = 0; x < m_width; x++, src += 4, dst += 3)
+        {
+          dst[0] = src[0];
+          dst[1] = src[1];
+          dst[2] = src[2];
+        }
+      }
+      break;
+    }
+    case Y4M:
+    {
+      static const char marker[] = "FRAME\n";
+      const size_t planeSize = (size_t)m_width * m_height;
+      frame.data.resize(6 + 3 * planeSize);
+      memcpy(&frame.data[0], marker, 6);
+
+      unsigned char * Y = &frame.data[6];
+      unsigned char * U = Y + planeSize;
+      unsigned char * V = U + planeSize;
+
+      // planes are top down, BT.601 limited range
+      for (int y = 0; y < m_height; y++)
+      {
+        const unsigned char * src = pixels + (m_height - 1 - y) * lineSize;
+        for (int x = 0; x < m_width; x++, src += 4)
+        {
+          const int b = src[0], g = src[1], r = src[2];
+          *Y++ = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+          *U++ = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+          *V++ = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+      }
+      break;
+    }
+    case PNG:
+    {
+      QImage image(m_width, m_height, QImage::Format_RGB32);
+      for (int y = 0; y < m_height; y++)
+        memcpy(image.scanLine(y), pixels + (m_height - 1 - y) * lineSize, lineSize);
+
+      frame.ok = TextureExporter::save(image, frameFile(frame.index));
+      break;
+    }
+  }
+
+  std::vector<unsigned char>().swap(frame.pixels);
+}
+
+void FrameSequenceWriter::frameDone(std::shared_ptr<Frame> frame)
+{
+  QMutexLocker lock(&m_mutex);
+  frame->done = true;
+
+  // whichever encoder completes the oldest frame appends all the ready ones
+  while (!m_frames.empty() && m_frames.front()->done)
+  {
+    if (m_ok && !writeFrame(*m_frames.front()))
+      m_ok = false;
+    m_frames.pop_front();
+  }
+
+  m_frameWritten.wakeAll();
+}
+
+bool FrameSequenceWriter::writeFrame(const Frame & frame)
+{
+  if (!frame.ok)
+  {
+    LOG_ERROR << "Unable to write frame" << frame.index << "of" << m_fileName;
+    return false;
+  }
+
+  if (m_format == PNG)
+    return true;
+
+  QByteArray chunk;
+  if (m_format == AVI)
+  {
+    if (m_moviSize + 8 + frame.data.size() + 16 * (m_chunkSizes.size() + 1) + AVI_MOVI_OFFSET > 0xFFFFFFFFLL)
+    {
+      LOG_ERROR << "Video" << m_fileName << "exceeds AVI 4GB limit";
+      return false;
+    }
+
+    appendChunkHeader(chunk, "00db", (unsigned int)frame.data.size());
+    m_chunkSizes.push_back((unsigned int)frame.data.size());
+    m_moviSize += 8 + frame.data.size();
+  }
+  chunk.append((const char *)&frame.data[0], (int)frame.data.size());
+
+  if (m_file.write(chunk) != chunk.size())
+  {
+    LOG_ERROR << "Error while writing" << m_fileName;
+    return false;
+  }
+
+  return true;
+}
+
+QByteArray FrameSequenceWriter::aviHeader() const
+{
+  const unsigned int nbFrames = (unsigned int)m_chunkSizes.size();
+  const unsigned int frameSize = aviStride(m_width) * m_height;
+  const unsigned int moviSize = (unsigned int)m_moviSize;
+  const unsigned int indexSize = 8 + 16 * nbFrames;
+
+  QByteArray data;
+  appendChunkHeader(data, "RIFF", (unsigned int)(AVI_MOVI_OFFSET - 8 + 8 + moviSize + indexSize));
+  data.append("AVI ", 4);
+
+  appendChunkHeader(data, "LIST", AVI_HDRL_SIZE);
+  data.append("hdrl", 4);
+
+  // MainAVIHeader
+  appendChunkHeader(data, "avih", 56);
+  appendLE32(data, 1000000 / m_fps);       // dwMicroSecPerFrame
+  appendLE32(data, frameSize * m_fps);     // dwMaxBytesPerSec
+  appendLE32(data, 0);                     // dwPaddingGranularity
+  appendLE32(data, 0x10);                  // dwFlags : AVIF_HASINDEX
+  appendLE32(data, nbFrames);              // dwTotalFrames
+  appendLE32(data, 0);                     // dwInitialFrames
+  appendLE32(data, 1);                     // dwStreams
+  appendLE32(data, frameSize + 8);         // dwSuggestedBufferSize
+  appendLE32(data, m_width);               // dwWidth
+  appendLE32(data, m_height);              // dwHeight
+  for (size_t i = 0; i < 4; i++)
+    appendLE32(data, 0);                   // dwReserved
+
+  appendChunkHeader(data, "LIST", 4 + (8 + 56) + (8 + 40));
+  data.append("strl", 4);
+
+  // AVIStreamHeader
+  appendChunkHeader(data, "strh", 56);
+  data.append("vids", 4);                  // fccType
+  data.append("DIB ", 4);                  // fccHandler
+  appendLE32(data, 0);                     // dwFlags
+  appendLE16(data, 0);                     // wPriority
+  appendLE16(data, 0);                     // wLanguage
+  appendLE32(data, 0);                     // dwInitialFrames
+  appendLE32(data, 1);                     // dwScale
+  appendLE32(data, m_fps);                 // dwRate
+  appendLE32(data, 0);                     // dwStart
+  appendLE32(data, nbFrames);              // dwLength
+  appendLE32(data, frameSize + 8);         // dwSuggestedBufferSize
+  appendLE32(data, 0xFFFFFFFF);            // dwQuality
+  appendLE32(data, 0);                     // dwSampleSize
+  appendLE16(data, 0);                     // rcFrame
+  appendLE16(data, 0);
+  appendLE16(data, m_width);
+  appendLE16(data, m_height);
+
+  // BITMAPINFOHEADER
+  appendChunkHeader(data, "strf", 40);
+  appendLE32(data, 40);                    // biSize
+  appendLE32(data, m_width);               // biWidth
+  appendLE32(data, m_height);              // biHeight (bottom up)
+  appendLE16(data, 1);                     // biPlanes
+  appendLE16(data, 24);                    // biBitCount
+  appendLE32(data, 0);                     // biCompression : BI_RGB
+  appendLE32(data, frameSize);             // biSizeImage
+  for (size_t i = 0; i < 4; i++)
+    appendLE32(data, 0);                   // resolution and palette
+
+  appendChunkHeader(data, "LIST", moviSize);
+  data.append("movi", 4);
+
+  return data;
+}
+
+QString FrameSequenceWriter::frameFile(size_t index) const
+{
+  QFileInfo info(m_fileName);
+  return QString("%1/%2_%3.%4").arg(info.path()).arg(info.completeBaseName())
+                               .arg((qulonglong)index, 4, 10, QChar('0')).arg(info.suffix());
+}
@@ -0,0 +1,100 @@
+/*
+ * FrameSequenceWriter.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _FRAMESEQUENCEWRITER_H_
+#define _FRAMESEQUENCEWRITER_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _FRAMESEQUENCEWRITER_API_ __declspec(dllexport)
+#    else
+#        define _FRAMESEQUENCEWRITER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _FRAMESEQUENCEWRITER_API_
+#endif
+
+// Portable video / frame sequence writer, format being chosen from file extension:
+//  - avi : uncompressed 24 bits RGB AVI
+//  - y4m : YUV4MPEG2 stream, 4:4:4 BT.601
+//  - png : numbered png files (name_0000.png, name_0001.png...)
+// Frames are queued by the render thread and converted by worker threads, which also
+// append them to the file in order. Queue is bounded: addFrame() blocks when encoders
+// are late, so memory used does not depend on the number of frames.
+class _FRAMESEQUENCEWRITER_API_ FrameSequenceWriter
+{
+  public:
+    FrameSequenceWriter(const QString & file, int width, int height, int fps);
+    ~FrameSequenceWriter();
+
+    // true if file extension is one of the supported formats
+    static bool canWrite(const QString & file);
+
+    bool open();
+
+    // pixels are 32 bits BGRA, bottom up (as read back from OpenGL), alpha is ignored
+    bool addFrame(const unsigned char * pixels);
+
+    // waits for queued frames and finishes the file, returns false if a frame failed
+    bool close();
+
+    size_t frameCount() const { return m_nbFrames; }
+
+  private:
+    enum Format
+    {
+      AVI,
+      Y4M,
+      PNG
+    };
+
+    struct Frame
+    {
+      size_t index;
+      std::vector<unsigned char> pixels;
+      std::vector<unsigned char> data;
+      bool ok;
+      bool done;
+    };
+
+    class FrameJob;
+
+    void encode(Frame & frame) const;
+    void frameDone(std::shared_ptr<Frame> frame);
+    bool writeFrame(const Frame & frame);
+    QByteArray aviHeader() const;
+    QString frameFile(size_t index) const;
+
+    QString m_fileName;
+    QFile m_file;
+    Format m_format;
+    int m_width, m_height, m_fps;
+    size_t m_nbFrames;
+    bool m_ok;
+
+    QThreadPool m_pool;
+    size_t m_maxQueuedFrames;
+    std::deque<std::shared_ptr<Frame> > m_frames;
+    QMutex m_mutex;
+    QWaitCondition m_frameWritten;
+
+    // avi
+    std::vector<unsigned int> m_chunkSizes;
+    qint64 m_moviSize;
+};
+
+#endif
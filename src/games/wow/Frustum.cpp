@@ -0,0 +1,154 @@
+#include "Frustum.h"
+
+#include "matrix.h"
+
+#include "GL/glew.h"
+
+void Frustum::fromGLMatrices()
+{
+  GLfloat mv[16], proj[16], clip[16];
+  glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+  glGetFloatv(GL_PROJECTION_MATRIX, proj);
+
+  // clip = proj * mv (column major storage)
+  for (size_t col = 0; col < 4; col++)
+  {
+    for (size_t row = 0; row < 4; row++)
+    {
+      clip[col * 4 + row] = proj[row] * mv[col * 4] +
+                            proj[4 + row] * mv[col * 4 + 1] +
+                            proj[8 + row] * mv[col * 4 + 2] +
+                            proj[12 + row] * mv[col * 4 + 3];
+    }
+  }
+
+  // Gribb / Hartmann extraction : plane = row3 +/- row(0|1|2)
+  static const float signs[2] = { 1.0f, -1.0f };
+  m_planes.clear();
+  for (size_t row = 0; row < 3; row++)
+  {
+    for (size_t s = 0; s < 2; s++)
+    {
+      FrustumPlane p;
+      p.normal = Vec3D(clip[3] + signs[s] * clip[row],
+                       clip[7] + signs[s] * clip[4 + row],
+                       clip[11] + signs[s] * clip[8 + row]);
+      p.d = clip[15] + signs[s] * clip[12 + row];
+
+      float len = p.normal.length();
+      if (len > 0.0f)
+      {
+        p.normal *= 1.0f / len;
+        p.d /= len;
+      }
+      m_planes.push_back(p);
+    }
+  }
+
+  // camera position is the translation part of the inverted modelview
+  Matrix m;
+  for (size_t j = 0; j < 4; j++)
+    for (size_t i = 0; i < 4; i++)
+      m.m[j][i] = mv[i * 4 + j];
+  m.invert();
+  eye = m.GetTranslation();
+}
+
+bool Frustum::fromPortal(const Vec3D & e, const Vec3D * verts, size_t nVerts)
+{
+  if (nVerts < 3)
+    return false;
+
+  Vec3D center;
+  for (size_t i = 0; i < nVerts; i++)
+    center += verts[i];
+  center *= 1.0f / nVerts;
+
+  m_planes.clear();
+  eye = e;
+
+  for (size_t i = 0; i < nVerts; i++)
+  {
+    const Vec3D & v1 = verts[i];
+    const Vec3D & v2 = verts[(i + 1) % nVerts];
+
+    FrustumPlane p;
+    p.normal = (v1 - e) % (v2 - e);
+    float len = p.normal.length();
+    if (len < 0.0001f) // eye is (almost) on the portal edge
+    {
+      m_planes.clear();
+      return false;
+    }
+    p.normal *= 1.0f / len;
+    p.d = -(p.normal * e);
+
+    // make plane face portal center, whatever the winding order is
+    if (p.distance(center) < 0.0f)
+    {
+      p.normal *= -1.0f;
+      p.d = -p.d;
+    }
+
+    m_planes.push_back(p);
+  }
+
+  return true;
+}
+
+void Frustum::clip(const Frustum & other)
+{
+  m_planes.insert(m_planes.end(), other.m_planes.begin(), other.m_planes.end());
+}
+
+bool Frustum::contains(const Vec3D & p) const
+{
+  for (auto & plane : m_planes)
+  {
+    if (plane.distance(p) < 0.0f)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const Vec3D & min, const Vec3D & max) const
+{
+  for (auto & plane : m_planes)
+  {
+    // test box corner the most in the direction of the plane normal
+    Vec3D p((plane.normal.x >= 0.0f) ? max.x : min.x,
+            (plane.normal.y >= 0.0f) ? max.y : min.y,
+            (plane.normal.z >= 0.0f) ? max.z : min.z);
+
+    if (plane.distance(p) < 0.0f)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const Vec3D & center, float radius) const
+{
+  for (auto & plane : m_planes)
+  {
+    if (plane.distance(center) < -radius)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const Vec3D * verts, size_t nVerts) const
+{
+  for (auto & plane : m_planes)
+  {
+    bool allOutside = true;
+    for (size_t i = 0; i < nVerts && allOutside; i++)
+    {
+      if (plane.distance(verts[i]) >= 0.0f)
+        allOutside = false;
+    }
+
+    if (allOutside)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+#ifndef _FRUSTUM_H_
+#define _FRUSTUM_H_
+
+#include <vector>
+
+#include "vec3d.h"
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _FRUSTUM_API_ __declspec(dllexport)
+#    else
+#        define _FRUSTUM_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _FRUSTUM_API_
+#endif
+
+// plane in the form normal * p + d = 0, positive side is "inside"
+struct FrustumPlane {
+  Vec3D normal;
+  float d;
+
+  float distance(const Vec3D & p) const { return normal * p + d; }
+};
+
+// Convex volume made of inward facing planes.
+// Built either from current OpenGL matrices (view frustum) or from
+// a camera position and a portal polygon (portal frustum).
+class _FRUSTUM_API_ Frustum
+{
+  public:
+    Frustum() {}
+
+    // extract the 6 view planes from current GL_PROJECTION * GL_MODELVIEW matrices
+    // planes are expressed in the current model space
+    void fromGLMatrices();
+
+    // planes going through eye and each edge of the given convex polygon
+    // returns false if polygon is degenerated as seen from eye
+    bool fromPortal(const Vec3D & eye, const Vec3D * verts, size_t nVerts);
+
+    // add all planes of another frustum to this one (intersection of both volumes)
+    void clip(const Frustum & other);
+
+    bool contains(const Vec3D & p) const;
+    bool intersects(const Vec3D & min, const Vec3D & max) const;
+    bool intersects(const Vec3D & center, float radius) const;
+    bool intersects(const Vec3D * verts, size_t nVerts) const;
+
+    // camera position in current model space (computed by fromGLMatrices)
+    Vec3D eye;
+
+  private:
+    std::vector<FrustumPlane> m_planes;
+};
+
+#endif
@@ -0,0 +1,390 @@
+/*
+ * ImageStripWriter.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "ImageStripWriter.h"
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QFileInfo>
+
+#include "logger/Logger.h"
+
+namespace
+{
+  void appendLE16(QByteArray & data, unsigned int value)
+  {
+    data.append((char)(value & 0xFF));
+    data.append((char)((value >> 8) & 0xFF));
+  }
+
+  void appendLE32(QByteArray & data, unsigned int value)
+  {
+    appendLE16(data, value & 0xFFFF);
+    appendLE16(data, value >> 16);
+  }
+
+  void appendBE32(QByteArray & data, unsigned int value)
+  {
+    data.append((char)((value >> 24) & 0xFF));
+    data.append((char)((value >> 16) & 0xFF));
+    data.append((char)((value >> 8) & 0xFF));
+    data.append((char)(value & 0xFF));
+  }
+
+  // TIFF directory entry, value is stored inline when it fits in 4 bytes
+  void appendTIFFEntry(QByteArray & data, unsigned int tag, unsigned int type, unsigned int count, unsigned int value)
+  {
+    appendLE16(data, tag);
+    appendLE16(data, type);
+    appendLE32(data, count);
+    appendLE32(data, value);
+  }
+
+  const unsigned int TIFF_SHORT = 3;
+  const unsigned int TIFF_LONG = 4;
+
+  struct CRCTable
+  {
+    CRCTable()
+    {
+      for (unsigned int n = 0; n < 256; n++)
+      {
+        unsigned int c = n;
+        for (size_t k = 0; k < 8; k++)
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        values[n] = c;
+      }
+    }
+
+    unsigned int values[256];
+  };
+
+  unsigned int crc32(unsigned int crc, const unsigned char * data, size_t size)
+  {
+    static const CRCTable table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+      crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+  }
+
+  unsigned int adler32(unsigned int adler, const unsigned char * data, size_t size)
+  {
+    unsigned int s1 = adler & 0xFFFF;
+    unsigned int s2 = adler >> 16;
+
+    while (size > 0)
+    {
+      // largest block for which s2 cannot overflow before modulo
+      size_t block = std::min(size, (size_t)5552);
+      size -= block;
+      while (block--)
+      {
+        s1 += *data++;
+        s2 += s1;
+      }
+      s1 %= 65521;
+      s2 %= 65521;
+    }
+
+    return (s2 << 16) | s1;
+  }
+
+  const size_t MAX_STORED_BLOCK = 65535;
+}
+
+ImageStripWriter::ImageStripWriter(const QString & file, int width, int height, int rowsPerStrip)
+  : m_file(file), m_format(TIFF), m_width(width), m_height(height), m_rowsPerStrip(rowsPerStrip),
+  m_rowsWritten(0), m_ok(false), m_adler(1), m_deflateRemaining(0)
+{
+  if (QFileInfo(file).suffix().toLower() == "png")
+    m_format = PNG;
+}
+
+ImageStripWriter::~ImageStripWriter()
+{
+  if (m_file.isOpen())
+    m_file.close();
+}
+
+bool ImageStripWriter::canWrite(const QString & file)
+{
+  QString suffix = QFileInfo(file).suffix().toLower();
+  return (suffix == "tif" || suffix == "tiff" || suffix == "png");
+}
+
+bool ImageStripWriter::open()
+{
+  if (!canWrite(m_file.fileName()) || m_width <= 0 || m_height <= 0 || m_rowsPerStrip <= 0)
+  {
+    LOG_ERROR << "Unsupported image for strip writer" << m_file.fileName() << m_width << "x" << m_height;
+    return false;
+  }
+
+  if (!m_file.open(QIODevice::WriteOnly))
+  {
+    LOG_ERROR << "Unable to open" << m_file.fileName() << "for writing";
+    return false;
+  }
+
+  m_ok = true;
+  m_rowsWritten = 0;
+  m_row.resize(3 * m_width + 1);
+
+  QByteArray header;
+  if (m_format == TIFF)
+  {
+    // little endian, first directory offset is patched by close()
+    header.append("II");
+    appendLE16(header, 42);
+    appendLE32(header, 0);
+    m_ok = write(header.constData(), header.size());
+  }
+  else
+  {
+    header.append("\x89PNG\r\n\x1a\n", 8);
+    m_ok = write(header.constData(), header.size());
+
+    QByteArray ihdr;
+    appendBE32(ihdr, m_width);
+    appendBE32(ihdr, m_height);
+    ihdr.append((char)8); // bit depth
+    ihdr.append((char)2); // truecolor
+    ihdr.append((char)0); // deflate
+    ihdr.append((char)0); // adaptive filtering
+    ihdr.append((char)0); // no interlace
+    m_ok = m_ok && writePNGChunk("IHDR", ihdr);
+
+    m_adler = 1;
+    m_deflateRemaining = (size_t)m_height * (3 * m_width + 1);
+  }
+
+  return m_ok;
+}
+
+bool ImageStripWriter::writeRows(const unsigned char * pixels, int rows, int bytesPerLine)
+{
+  if (!m_ok)
+    return false;
+
+  if (rows <= 0 || m_rowsWritten + rows > m_height ||
+      (rows != m_rowsPerStrip && m_rowsWritten + rows != m_height))
+  {
+    LOG_ERROR << "Invalid strip of" << rows << "rows for" << m_file.fileName();
+    m_ok = false;
+    return false;
+  }
+
+  if (m_format == TIFF)
+    m_ok = writeTIFFStrip(pixels, rows, bytesPerLine);
+  else
+    m_ok = writePNGRows(pixels, rows, bytesPerLine);
+
+  m_rowsWritten += rows;
+  return m_ok;
+}
+
+bool ImageStripWriter::close()
+{
+  if (!m_file.isOpen())
+    return false;
+
+  if (m_ok && m_rowsWritten != m_height)
+  {
+    LOG_ERROR << "Image" << m_file.fileName() << "is incomplete:" << m_rowsWritten << "rows written out of" << m_height;
+    m_ok = false;
+  }
+
+  if (m_ok)
+    m_ok = (m_format == TIFF) ? closeTIFF() : closePNG();
+
+  m_file.close();
+  return m_ok;
+}
+
+bool ImageStripWriter::writeTIFFStrip(const unsigned char * pixels, int rows, int bytesPerLine)
+{
+  QByteArray strip;
+  strip.reserve(3 * m_width * rows);
+
+  for (int y = 0; y < rows; y++)
+  {
+    const unsigned char * src = pixels + (ptrdiff_t)y * bytesPerLine;
+    unsigned char * dst = &m_row[0];
+
+    // horizontal predictor: each sample is stored as difference with left pixel
+    unsigned char prev[3] = { 0, 0, 0 };
+    for (int x = 0; x < m_width; x++, src += 4, dst += 3)
+    {
+      const unsigned char rgb[3] = { src[2], src[1], src[0] };
+      for (size_t c = 0; c < 3; c++)
+      {
+        dst[c] = rgb[c] - prev[c];
+        prev[c] = rgb[c];
+      }
+    }
+    strip.append((const char *)&m_row[0], 3 * m_width);
+  }
+
+  // qCompress output is a zlib stream prefixed by uncompressed size
+  QByteArray compressed = qCompress(strip, 6);
+  compressed.remove(0, 4);
+
+  qint64 offset = m_file.pos();
+  if (offset + compressed.size() > 0xFFFFFFFFLL)
+  {
+    LOG_ERROR << "Image" << m_file.fileName() << "exceeds TIFF 4GB limit";
+    return false;
+  }
+
+  m_stripOffsets.push_back((unsigned int)offset);
+  m_stripSizes.push_back((unsigned int)compressed.size());
+
+  return write(compressed.constData(), compressed.size());
+}
+
+bool ImageStripWriter::closeTIFF()
+{
+  const unsigned int nbStrips = (unsigned int)m_stripOffsets.size();
+
+  QByteArray data;
+  unsigned int pos = (unsigned int)m_file.pos();
+
+  // directory and arrays must start on word boundary
+  if (pos & 1)
+  {
+    data.append((char)0);
+    pos++;
+  }
+
+  const unsigned int bitsPerSampleOffset = pos;
+  for (size_t c = 0; c < 3; c++)
+    appendLE16(data, 8);
+  pos += 6;
+
+  unsigned int stripOffsetsValue = m_stripOffsets[0];
+  unsigned int stripSizesValue = m_stripSizes[0];
+  if (nbStrips > 1)
+  {
+    stripOffsetsValue = pos;
+    for (size_t i = 0; i < nbStrips; i++)
+      appendLE32(data, m_stripOffsets[i]);
+    pos += 4 * nbStrips;
+
+    stripSizesValue = pos;
+    for (size_t i = 0; i < nbStrips; i++)
+      appendLE32(data, m_stripSizes[i]);
+    pos += 4 * nbStrips;
+  }
+
+  const unsigned int directoryOffset = pos;
+
+  // entries sorted by tag
+  appendLE16(data, 11);
+  appendTIFFEntry(data, 256, TIFF_LONG, 1, m_width);                   // ImageWidth
+  appendTIFFEntry(data, 257, TIFF_LONG, 1, m_height);                  // ImageLength
+  appendTIFFEntry(data, 258, TIFF_SHORT, 3, bitsPerSampleOffset);      // BitsPerSample
+  appendTIFFEntry(data, 259, TIFF_SHORT, 1, 8);                        // Compression : deflate
+  appendTIFFEntry(data, 262, TIFF_SHORT, 1, 2);                        // PhotometricInterpretation : RGB
+  appendTIFFEntry(data, 273, TIFF_LONG, nbStrips, stripOffsetsValue);  // StripOffsets
+  appendTIFFEntry(data, 277, TIFF_SHORT, 1, 3);                        // SamplesPerPixel
+  appendTIFFEntry(data, 278, TIFF_LONG, 1, m_rowsPerStrip);            // RowsPerStrip
+  appendTIFFEntry(data, 279, TIFF_LONG, nbStrips, stripSizesValue);    // StripByteCounts
+  appendTIFFEntry(data, 284, TIFF_SHORT, 1, 1);                        // PlanarConfiguration : chunky
+  appendTIFFEntry(data, 317, TIFF_SHORT, 1, 2);                        // Predictor : horizontal
+  appendLE32(data, 0); // no next directory
+
+  if (!write(data.constData(), data.size()))
+    return false;
+
+  QByteArray header;
+  appendLE32(header, directoryOffset);
+  return m_file.seek(4) && write(header.constData(), header.size());
+}
+
+bool ImageStripWriter::writePNGRows(const unsigned char * pixels, int rows, int bytesPerLine)
+{
+  const size_t rowSize = 3 * m_width + 1;
+
+  QByteArray raw;
+  raw.reserve(rowSize * rows);
+
+  for (int y = 0; y < rows; y++)
+  {
+    const unsigned char * src = pixels + (ptrdiff_t)y * bytesPerLine;
+    unsigned char * dst = &m_row[0];
+
+    *dst++ = 0; // filter type : none
+    for (int x = 0; x < m_width; x++, src += 4, dst += 3)
+    {
+      dst[0] = src[2];
+      dst[1] = src[1];
+      dst[2] = src[0];
+    }
+    raw.append((const char *)&m_row[0], (int)rowSize);
+  }
+
+  m_adler = adler32(m_adler, (const unsigned char *)raw.constData(), raw.size());
+
+  QByteArray idat;
+  idat.reserve(raw.size() + 5 * (raw.size() / MAX_STORED_BLOCK + 1) + 2);
+
+  // zlib header : deflate, 32K window, no dictionary
+  if (m_rowsWritten == 0)
+  {
+    idat.append((char)0x78);
+    idat.append((char)0x01);
+  }
+
+  for (size_t pos = 0; pos < (size_t)raw.size();)
+  {
+    const size_t len = std::min(MAX_STORED_BLOCK, (size_t)raw.size() - pos);
+    m_deflateRemaining -= len;
+
+    idat.append((char)(m_deflateRemaining == 0 ? 1 : 0)); // BFINAL, BTYPE = stored
+    appendLE16(idat, (unsigned int)len);
+    appendLE16(idat, (unsigned int)(~len & 0xFFFF));
+    idat.append(raw.constData() + pos, (int)len);
+    pos += len;
+  }
+
+  return writePNGChunk("IDAT", idat);
+}
+
+bool ImageStripWriter::writePNGChunk(const char * type, const QByteArray & data)
+{
+  QByteArray chunk;
+  appendBE32(chunk, data.size());
+  chunk.append(type, 4);
+  chunk.append(data);
+
+  // crc covers type and data
+  unsigned int crc = crc32(0, (const unsigned char *)chunk.constData() + 4, chunk.size() - 4);
+  appendBE32(chunk, crc);
+
+  return write(chunk.constData(), chunk.size());
+}
+
+bool ImageStripWriter::closePNG()
+{
+  QByteArray adler;
+  appendBE32(adler, m_adler);
+
+  return writePNGChunk("IDAT", adler) && writePNGChunk("IEND", QByteArray());
+}
+
+bool ImageStripWriter::write(const void * data, size_t size)
+{
+  if (m_file.write((const char *)data, size) != (qint64)size)
+  {
+    LOG_ERROR << "Error while writing" << m_file.fileName();
+    return false;
+  }
+  return true;
+}
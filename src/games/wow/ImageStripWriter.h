@@ -0,0 +1,83 @@
+/*
+ * ImageStripWriter.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _IMAGESTRIPWRITER_H_
+#define _IMAGESTRIPWRITER_H_
+
+#include <vector>
+
+#include <QFile>
+#include <QString>
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _IMAGESTRIPWRITER_API_ __declspec(dllexport)
+#    else
+#        define _IMAGESTRIPWRITER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _IMAGESTRIPWRITER_API_
+#endif
+
+// Writes an RGB image to disk strip by strip, so that only one strip of pixels
+// has to be kept in memory whatever the size of the final image.
+// Format is chosen from file extension:
+//  - tif / tiff : each strip is deflate compressed (with horizontal predictor)
+//  - png : scanlines are written in stored (uncompressed) deflate blocks
+class _IMAGESTRIPWRITER_API_ ImageStripWriter
+{
+  public:
+    ImageStripWriter(const QString & file, int width, int height, int rowsPerStrip);
+    ~ImageStripWriter();
+
+    // true if file extension is one of the streamed formats
+    static bool canWrite(const QString & file);
+
+    bool open();
+
+    // appends rows to the image, top to bottom. pixels are 32 bits BGRA (alpha
+    // is ignored), bytesPerLine can be negative to feed bottom-up buffers.
+    // every call but the last one must provide rowsPerStrip rows.
+    bool writeRows(const unsigned char * pixels, int rows, int bytesPerLine);
+
+    // writes trailing data, returns false if image is incomplete or on write error
+    bool close();
+
+  private:
+    enum Format
+    {
+      TIFF,
+      PNG
+    };
+
+    bool writeTIFFStrip(const unsigned char * pixels, int rows, int bytesPerLine);
+    bool closeTIFF();
+
+    bool writePNGRows(const unsigned char * pixels, int rows, int bytesPerLine);
+    bool writePNGChunk(const char * type, const QByteArray & data);
+    bool closePNG();
+
+    bool write(const void * data, size_t size);
+
+    QFile m_file;
+    Format m_format;
+    int m_width, m_height, m_rowsPerStrip;
+    int m_rowsWritten;
+    bool m_ok;
+
+    std::vector<unsigned char> m_row;
+
+    // tiff
+    std::vector<unsigned int> m_stripOffsets;
+    std::vector<unsigned int> m_stripSizes;
+
+    // png
+    unsigned int m_adler;
+    size_t m_deflateRemaining;
+};
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * ModelCache.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "ModelCache.h"
+
+#include <cstring>
+
+#include <QDir>
+#include <QSaveFile>
+
+#include "CASCChunks.h"
+#include "Game.h"
+#include "GameFile.h"
+
+#include "logger/Logger.h"
+
+namespace
+{
+  // file layout : Header, Entry[nbEntries], then entries contents, each one aligned on ALIGNMENT bytes
+  struct Header
+  {
+    char magic[4];
+    quint32 version;
+    char build[32]; // game build contents were read from
+    quint32 nbEntries; // model files (first one is model file), then geometry
+    quint32 unused; // entries are 8 bytes aligned
+  };
+
+  struct Entry
+  {
+    qint32 fileDataId; // or one of geometry ids below
+    quint32 unused;
+    quint64 offset;
+    quint64 size;
+  };
+
+  // geometry entries ids
+  const qint32 GEOMETRY_VERTICES = -1;
+  const qint32 GEOMETRY_INDICES = -2;
+  const qint32 GEOMETRY_GEOSETS = -3;
+
+  const char CACHE_MAGIC[4] = { 'W', 'M', 'V', 'C' };
+  const quint32 CACHE_VERSION = 2;
+  const quint64 ALIGNMENT = 16;
+
+  quint64 align(quint64 offset)
+  {
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  QByteArray build()
+  {
+    return GAMEDIRECTORY.version().toLatin1().left(sizeof(Header::build) - 1);
+  }
+}
+
+ModelCache & ModelCache::instance()
+{
+  static ModelCache cache;
+  return cache;
+}
+
+void ModelCache::setFolder(const QString & folder)
+{
+  if (!folder.isEmpty() && !QDir().mkpath(folder))
+  {
+    LOG_ERROR << "Unable to create model cache folder" << folder;
+    return;
+  }
+
+  QMutexLocker locker(&m_mutex);
+  m_folder = folder;
+}
+
+QString ModelCache::folder() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_folder;
+}
+
+ModelCache::Scope::Scope(GameFile * model)
+  : m_data(0)
+{
+  memset(&m_geometry, 0, sizeof(m_geometry));
+
+  QString folder = ModelCache::instance().folder();
+  if (!model || folder.isEmpty() || model->fileDataId() <= 0)
+    return;
+
+  m_file.setFileName(QString("%1/%2.m2c").arg(folder).arg(model->fileDataId()));
+
+  if (!map())
+    read(model);
+}
+
+ModelCache::Scope::~Scope()
+{
+  for (auto file : m_files)
+    file->setCachedContent(0, 0);
+
+  if (m_data)
+    m_file.unmap(m_data);
+
+  m_file.close();
+}
+
+bool ModelCache::Scope::map()
+{
+  if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+    return false;
+
+  const quint64 size = m_file.size();
+  uchar * data = (size >= sizeof(Header)) ? m_file.map(0, size) : 0;
+  if (!data)
+  {
+    m_file.close();
+    return false;
+  }
+
+  const Header * header = (const Header *)data;
+  const Entry * entries = (const Entry *)(data + sizeof(Header));
+
+  bool valid = (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0) &&
+               (header->version == CACHE_VERSION) &&
+               (build() == QByteArray(header->build, (int)strnlen(header->build, sizeof(header->build)))) &&
+               (header->nbEntries > 0) &&
+               (sizeof(Header) + header->nbEntries * sizeof(Entry) <= size);
+
+  for (quint32 i = 0; valid && i < header->nbEntries; i++)
+    valid = (entries[i].offset <= size) && (entries[i].size <= size - entries[i].offset);
+
+  Geometry geometry;
+  memset(&geometry, 0, sizeof(geometry));
+
+  for (quint32 i = 0; valid && i < header->nbEntries; i++)
+  {
+    const uchar * content = data + entries[i].offset;
+    const quint64 s = entries[i].size;
+
+    switch (entries[i].fileDataId)
+    {
+      case GEOMETRY_VERTICES:
+        geometry.vertices = (const ModelVertex *)content;
+        geometry.nbVertices = s / sizeof(ModelVertex);
+        valid = (s % sizeof(ModelVertex) == 0);
+        break;
+      case GEOMETRY_INDICES:
+        geometry.indices = (const uint32 *)content;
+        geometry.nbIndices = s / sizeof(uint32);
+        valid = (s % sizeof(uint32) == 0);
+        break;
+      case GEOMETRY_GEOSETS:
+        geometry.geosets = (const ModelGeosetHD *)content;
+        geometry.nbGeosets = s / sizeof(ModelGeosetHD);
+        valid = (s % sizeof(ModelGeosetHD) == 0);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // outdated or broken : baked again
+  if (!valid || !geometry.vertices || !geometry.indices || !geometry.geosets)
+  {
+    m_file.unmap(data);
+    m_file.close();
+    return false;
+  }
+
+  // only pointers to mapped contents are set, files are opened from them on demand
+  for (quint32 i = 0; i < header->nbEntries; i++)
+  {
+    if (entries[i].fileDataId <= 0)
+      continue;
+
+    GameFile * file = GAMEDIRECTORY.getFile(entries[i].fileDataId);
+    if (!file)
+      continue;
+
+    file->setCachedContent(data + entries[i].offset, entries[i].size);
+    m_files.push_back(file);
+  }
+
+  m_data = data;
+  m_geometry = geometry;
+  return true;
+}
+
+void ModelCache::Scope::read(GameFile * model)
+{
+  if (!model->open() || !model->isChunked())
+    return;
+
+  std::vector<GameFile *> files(1, model);
+
+  if (model->setChunk("SKID"))
+  {
+    quint32 skelFileId;
+    model->read(&skelFileId, sizeof(skelFileId));
+    GameFile * skelFile = GAMEDIRECTORY.getFile(skelFileId);
+
+    if (skelFile && skelFile->open())
+    {
+      files.push_back(skelFile);
+
+      if (skelFile->setChunk("SKPD"))
+      {
+        SKPD skpd;
+        memcpy(&skpd, skelFile->getBuffer(), sizeof(SKPD));
+        GameFile * parentFile = GAMEDIRECTORY.getFile(skpd.parentFileId);
+
+        if (parentFile && parentFile->open())
+          files.push_back(parentFile);
+      }
+    }
+  }
+
+  if (model->setChunk("SFID") && !model->isEof())
+  {
+    quint32 skinFileId;
+    model->read(&skinFileId, sizeof(skinFileId));
+    GameFile * skinFile = GAMEDIRECTORY.getFile(skinFileId);
+
+    if (skinFile && skinFile->open())
+      files.push_back(skinFile);
+  }
+
+  model->setChunk("MD21");
+
+  // model closes and reopens these files while being built : they are opened from copies
+  // kept for store(), instead of being read again
+  m_contents.reserve(files.size());
+  for (auto file : files)
+    m_contents.push_back(QByteArray((const char *)file->content(), (int)file->contentSize()));
+
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    files[i]->setCachedContent((const unsigned char *)m_contents[i].constData(), m_contents[i].size());
+    m_files.push_back(files[i]);
+  }
+}
+
+void ModelCache::Scope::store(const std::vector<ModelVertex> & vertices, const std::vector<uint32> & indices,
+                              const std::vector<ModelGeosetHD *> & geosets)
+{
+  if (m_data || m_contents.empty())
+    return;
+
+  std::vector<ModelGeosetHD> geosetValues;
+  geosetValues.reserve(geosets.size());
+  for (auto geoset : geosets)
+    geosetValues.push_back(*geoset);
+
+  // entries contents, in file order
+  std::vector<std::pair<qint32, QByteArray> > contents;
+  for (size_t i = 0; i < m_files.size(); i++)
+    contents.push_back(std::make_pair((qint32)m_files[i]->fileDataId(), m_contents[i]));
+
+  contents.push_back(std::make_pair(GEOMETRY_VERTICES,
+                                    QByteArray::fromRawData((const char *)vertices.data(), (int)(vertices.size() * sizeof(ModelVertex)))));
+  contents.push_back(std::make_pair(GEOMETRY_INDICES,
+                                    QByteArray::fromRawData((const char *)indices.data(), (int)(indices.size() * sizeof(uint32)))));
+  contents.push_back(std::make_pair(GEOMETRY_GEOSETS,
+                                    QByteArray::fromRawData((const char *)geosetValues.data(), (int)(geosetValues.size() * sizeof(ModelGeosetHD)))));
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  QByteArray b = build();
+  memcpy(header.build, b.constData(), b.size());
+  header.nbEntries = (quint32)contents.size();
+
+  std::vector<Entry> entries(contents.size());
+  quint64 offset = sizeof(Header) + contents.size() * sizeof(Entry);
+  for (size_t i = 0; i < contents.size(); i++)
+  {
+    offset = align(offset);
+    entries[i].fileDataId = contents[i].first;
+    entries[i].unused = 0;
+    entries[i].offset = offset;
+    entries[i].size = contents[i].second.size();
+    offset += entries[i].size;
+  }
+
+  // written aside then renamed, so that other processes sharing the cache never read a partial file
+  QSaveFile out(m_file.fileName());
+  if (!out.open(QIODevice::WriteOnly))
+  {
+    LOG_ERROR << "Unable to write model cache file" << m_file.fileName();
+    return;
+  }
+
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)entries.data(), entries.size() * sizeof(Entry));
+
+  static const char padding[ALIGNMENT] = { 0 };
+  for (size_t i = 0; i < contents.size(); i++)
+  {
+    out.write(padding, entries[i].offset - out.pos());
+    out.write(contents[i].second.constData(), entries[i].size);
+  }
+
+  if (!out.commit())
+    LOG_ERROR << "Unable to write model cache file" << m_file.fileName();
+}
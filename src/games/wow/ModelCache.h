@@ -0,0 +1,98 @@
+/*
+ * ModelCache.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _MODELCACHE_H_
+#define _MODELCACHE_H_
+
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+
+#include "modelheaders.h"
+
+class GameFile;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _MODELCACHE_API_ __declspec(dllexport)
+#    else
+#        define _MODELCACHE_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _MODELCACHE_API_
+#endif
+
+// Baked models on disk.
+// One flat file per model, keyed by model fileDataId and game build, stores geometry
+// resolved while building it (vertices in Y-up coordinate system, indices and geosets of
+// first view), along with the model file and the files needed to build it (skeleton,
+// parent skeleton and first .skin).
+// Next time model is built, this file is mapped in memory : geometry is copied straight
+// from it, and model files are opened from it (see GameFile::setCachedContent) without any
+// CASC lookup nor decompression, for the parts still converted on load. Bones and
+// animations (decoded lazily per animation), render passes and textures (tied to GL
+// context and TextureManager) are not baked. Legacy (not chunked) models are not cached.
+class _MODELCACHE_API_ ModelCache
+{
+  public:
+    static ModelCache & instance();
+
+    // cache is disabled until a folder is set
+    void setFolder(const QString & folder);
+    QString folder() const;
+
+    // points to mapped cache file
+    struct Geometry
+    {
+      const ModelVertex * vertices;
+      size_t nbVertices;
+      const uint32 * indices;
+      size_t nbIndices;
+      const ModelGeosetHD * geosets;
+      size_t nbGeosets;
+    };
+
+    // model files are opened from cache while a Scope lives. If model is not cached yet,
+    // its files are read once and kept in memory until model is stored
+    class _MODELCACHE_API_ Scope
+    {
+      public:
+        explicit Scope(GameFile * model);
+        ~Scope();
+
+        // geometry read from cache, null if model is not cached yet
+        const Geometry * geometry() const { return m_data ? &m_geometry : 0; }
+
+        // bakes model files and geometry resolved from them, if model is not cached yet
+        void store(const std::vector<ModelVertex> & vertices, const std::vector<uint32> & indices,
+                   const std::vector<ModelGeosetHD *> & geosets);
+
+      private:
+        Scope(const Scope &);
+        void operator=(const Scope &);
+
+        bool map();
+        void read(GameFile * model);
+
+        QFile m_file;
+        uchar * m_data;
+        Geometry m_geometry;
+        std::vector<GameFile *> m_files;
+        std::vector<QByteArray> m_contents; // files read, when model is not cached yet
+    };
+
+  private:
+    ModelCache() {}
+
+    mutable QMutex m_mutex;
+    QString m_folder;
+};
+
+#endif /* _MODELCACHE_H_ */
@@ -0,0 +1,432 @@
+/*
+ * ModelLoader.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "ModelLoader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QThread>
+
+#include "CASCChunks.h"
+#include "Game.h"
+#include "GameFile.h"
+#include "WoWModel.h"
+
+#include "logger/Logger.h"
+
+ModelLoader::Request::Request(GameFile * file, bool forceAnim)
+  : m_file(file), m_forceAnim(forceAnim), m_stage(QUEUED), m_cancelled(false), m_failed(false),
+    m_nbFiles(0), m_nbFilesRead(0), m_nbTasks(0), m_reportedStage(QUEUED), m_reportedFilesRead(0)
+{
+}
+
+ModelLoader::Stage ModelLoader::Request::stage() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_stage;
+}
+
+unsigned int ModelLoader::Request::nbFilesRead() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_nbFilesRead;
+}
+
+unsigned int ModelLoader::Request::nbFiles() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_nbFiles;
+}
+
+bool ModelLoader::Request::finished() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_stage == READY || m_stage == FAILED || m_stage == CANCELLED;
+}
+
+void ModelLoader::Request::cancel()
+{
+  QMutexLocker locker(&m_mutex);
+  m_cancelled = true;
+}
+
+bool ModelLoader::Request::cancelled() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_cancelled;
+}
+
+void ModelLoader::Request::setStage(Stage stage)
+{
+  QMutexLocker locker(&m_mutex);
+  m_stage = stage;
+}
+
+ModelLoader::ModelLoader()
+{
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+ModelLoader::~ModelLoader()
+{
+  cancel();
+  m_pool.waitForDone();
+
+  for (auto & request : m_requests)
+    release(request);
+}
+
+ModelLoader::RequestPtr ModelLoader::load(GameFile * file,
+                                          std::function<void(WoWModel *)> onReady,
+                                          std::function<void(const Request &)> onProgress,
+                                          bool forceAnim)
+{
+  if (!file)
+    return RequestPtr();
+
+  cancel();
+
+  RequestPtr request(new Request(file, forceAnim));
+  request->m_onReady = onReady;
+  request->m_onProgress = onProgress;
+  request->m_nbTasks = 1;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    m_requests.push_back(request);
+  }
+
+  m_pool.start(new ModelTask(this, request));
+
+  return request;
+}
+
+WoWModel * ModelLoader::loadNow(GameFile * file, bool forceAnim)
+{
+  cancel();
+
+  QMutexLocker locker(&m_buildMutex);
+  return new WoWModel(file, forceAnim);
+}
+
+void ModelLoader::cancel()
+{
+  QMutexLocker locker(&m_mutex);
+  for (auto & request : m_requests)
+    request->cancel();
+}
+
+GameFile * ModelLoader::pendingFile() const
+{
+  QMutexLocker locker(&m_mutex);
+  for (auto & request : m_requests)
+  {
+    if (!request->cancelled())
+      return request->m_file;
+  }
+
+  return 0;
+}
+
+void ModelLoader::update()
+{
+  std::vector<RequestPtr> requests;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    requests = m_requests;
+  }
+
+  for (auto & request : requests)
+  {
+    bool ended, cancelled, failed;
+
+    {
+      QMutexLocker locker(&request->m_mutex);
+      ended = (request->m_nbTasks == 0);
+      cancelled = request->m_cancelled;
+      failed = request->m_failed;
+    }
+
+    if (!cancelled)
+      report(request);
+
+    // workers still reading files
+    if (!ended)
+      continue;
+
+    {
+      QMutexLocker locker(&m_mutex);
+      m_requests.erase(std::remove(m_requests.begin(), m_requests.end(), request), m_requests.end());
+    }
+
+    if (cancelled)
+    {
+      release(request);
+      request->setStage(CANCELLED);
+      continue;
+    }
+
+    WoWModel * model = 0;
+
+    if (failed)
+    {
+      release(request);
+      request->setStage(FAILED);
+    }
+    else
+    {
+      request->setStage(BUILDING);
+      report(request);
+
+      // model closes and reopens some files while building (skeletons, textures...) : read
+      // contents are kept as cached contents until it is built, so that they are not read again
+      std::vector<GameFile *> pinned;
+      std::vector<QByteArray> contents;
+      pin(request, pinned, contents);
+
+      {
+        QMutexLocker locker(&m_buildMutex);
+        model = new WoWModel(request->m_file, request->m_forceAnim);
+      }
+
+      for (auto file : pinned)
+        file->setCachedContent(0, 0);
+
+      release(request);
+      request->setStage(READY);
+    }
+
+    report(request);
+
+    // may start another load, so called last
+    if (request->m_onReady)
+      request->m_onReady(model);
+  }
+}
+
+QString ModelLoader::stageName(Stage stage)
+{
+  switch (stage)
+  {
+    case QUEUED:
+      return "queued";
+    case READING_MODEL:
+      return "reading model";
+    case READING_DEPENDENCIES:
+      return "reading dependencies";
+    case BUILDING:
+      return "building";
+    case READY:
+      return "ready";
+    case FAILED:
+      return "failed";
+    case CANCELLED:
+      return "cancelled";
+  }
+
+  return "";
+}
+
+void ModelLoader::readModel(RequestPtr request)
+{
+  std::vector<GameFile *> files;
+  unsigned int nbFilesRead = 0;
+
+  if (!request->cancelled())
+  {
+    GameFile * file = request->m_file;
+
+    request->setStage(READING_MODEL);
+
+    if (open(request, file))
+    {
+      nbFilesRead++;
+
+      request->setStage(READING_DEPENDENCIES);
+
+      if (file->isChunked())
+      {
+        // chunks are selected on model and skeleton files, which a model being built may use
+        // too. Mutex is only held while reading them, not while reading other files
+        std::vector<uint32> fileIds;
+        uint32 skelFileId = 0;
+
+        {
+          QMutexLocker locker(&m_buildMutex);
+
+          if (file->setChunk("SKID"))
+            file->read(&skelFileId, sizeof(skelFileId));
+
+          // first view only, other ones are only used when changing LOD
+          if (file->setChunk("SFID") && !file->isEof())
+          {
+            uint32 skinFileId;
+            file->read(&skinFileId, sizeof(skinFileId));
+            fileIds.push_back(skinFileId);
+          }
+
+          if (file->setChunk("TXID"))
+          {
+            TXID txid;
+            while (!file->isEof())
+            {
+              file->read(&txid, sizeof(TXID));
+              fileIds.push_back(txid.fileDataId);
+            }
+          }
+
+          file->setChunk("MD21");
+        }
+
+        GameFile * skelFile = skelFileId ? GAMEDIRECTORY.getFile(skelFileId) : 0;
+        if (skelFile && open(request, skelFile))
+        {
+          nbFilesRead++;
+
+          uint32 parentFileId = 0;
+
+          {
+            QMutexLocker locker(&m_buildMutex);
+            if (skelFile->setChunk("SKPD"))
+            {
+              SKPD skpd;
+              memcpy(&skpd, skelFile->getBuffer(), sizeof(SKPD));
+              parentFileId = skpd.parentFileId;
+            }
+          }
+
+          GameFile * parentFile = parentFileId ? GAMEDIRECTORY.getFile(parentFileId) : 0;
+          if (parentFile && open(request, parentFile))
+            nbFilesRead++;
+        }
+
+        for (auto id : fileIds)
+          addFile(files, GAMEDIRECTORY.getFile(id));
+      }
+      else
+      {
+        QString skinName = file->fullname();
+        skinName.replace(".m2", "00.skin", Qt::CaseInsensitive);
+        addFile(files, GAMEDIRECTORY.getFile(skinName));
+      }
+    }
+    else
+    {
+      LOG_ERROR << "Unable to read model file" << file->fullname();
+      QMutexLocker locker(&request->m_mutex);
+      request->m_failed = true;
+    }
+  }
+
+  {
+    QMutexLocker locker(&request->m_mutex);
+    request->m_nbFiles = nbFilesRead + files.size();
+    request->m_nbFilesRead = nbFilesRead;
+    request->m_nbTasks += files.size();
+  }
+
+  for (auto file : files)
+    m_pool.start(new FileTask(this, request, file));
+
+  QMutexLocker locker(&request->m_mutex);
+  request->m_nbTasks--;
+}
+
+void ModelLoader::readFile(RequestPtr request, GameFile * file)
+{
+  // tasks of cancelled requests end right away, leaving threads to the current one
+  if (!request->cancelled())
+    open(request, file);
+
+  QMutexLocker locker(&request->m_mutex);
+  request->m_nbFilesRead++;
+  request->m_nbTasks--;
+}
+
+bool ModelLoader::open(RequestPtr request, GameFile * file)
+{
+  // reference taken before opening, so that a file shared with another request is not
+  // closed by release() in between
+  {
+    QMutexLocker locker(&m_mutex);
+    m_fileRefs[file]++;
+  }
+
+  {
+    QMutexLocker locker(&request->m_mutex);
+    request->m_opened.push_back(file);
+  }
+
+  return file->open();
+}
+
+void ModelLoader::addFile(std::vector<GameFile *> & files, GameFile * file)
+{
+  if (file && std::find(files.begin(), files.end(), file) == files.end())
+    files.push_back(file);
+}
+
+void ModelLoader::release(RequestPtr request)
+{
+  std::vector<GameFile *> opened;
+
+  {
+    QMutexLocker locker(&request->m_mutex);
+    opened.swap(request->m_opened);
+  }
+
+  QMutexLocker locker(&m_mutex);
+  for (auto file : opened)
+  {
+    auto it = m_fileRefs.find(file);
+    if (it == m_fileRefs.end() || --it->second > 0)
+      continue;
+
+    m_fileRefs.erase(it);
+    file->close();
+  }
+}
+
+void ModelLoader::pin(RequestPtr request, std::vector<GameFile *> & files, std::vector<QByteArray> & contents)
+{
+  std::vector<GameFile *> opened;
+
+  {
+    QMutexLocker locker(&request->m_mutex);
+    opened = request->m_opened;
+  }
+
+  contents.reserve(opened.size());
+  for (auto file : opened)
+  {
+    if (!file->content() || std::find(files.begin(), files.end(), file) != files.end())
+      continue;
+
+    contents.push_back(QByteArray((const char *)file->content(), (int)file->contentSize()));
+    file->setCachedContent((const unsigned char *)contents.back().constData(), contents.back().size());
+    files.push_back(file);
+  }
+}
+
+void ModelLoader::report(RequestPtr request)
+{
+  if (!request->m_onProgress)
+    return;
+
+  {
+    QMutexLocker locker(&request->m_mutex);
+    if (request->m_stage == request->m_reportedStage && request->m_nbFilesRead == request->m_reportedFilesRead)
+      return;
+
+    request->m_reportedStage = request->m_stage;
+    request->m_reportedFilesRead = request->m_nbFilesRead;
+  }
+
+  request->m_onProgress(*request);
+}
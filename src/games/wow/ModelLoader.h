@@ -0,0 +1,174 @@
+/*
+ * ModelLoader.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _MODELLOADER_H_
+#define _MODELLOADER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QRunnable>
+#include <QString>
+#include <QThreadPool>
+
+class GameFile;
+class WoWModel;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _MODELLOADER_API_ __declspec(dllexport)
+#    else
+#        define _MODELLOADER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _MODELLOADER_API_
+#endif
+
+// Loads models in background.
+// Model file and the files it depends on (skeletons, .skin and textures) are read
+// by worker threads, then model is built on calling (GL) thread by update(), as building
+// it creates textures and GL buffers.
+// Only one load is pending at a time : starting a new one cancels previous one, so that
+// browsing through models never queues loads the user is no longer interested in.
+class _MODELLOADER_API_ ModelLoader
+{
+  public:
+    enum Stage
+    {
+      QUEUED,
+      READING_MODEL,
+      READING_DEPENDENCIES,
+      BUILDING,
+      READY,
+      FAILED,
+      CANCELLED
+    };
+
+    // handle on a load started by ModelLoader::load
+    class _MODELLOADER_API_ Request
+    {
+      public:
+        GameFile * file() const { return m_file; }
+
+        Stage stage() const;
+
+        // files read so far / files to read (total is known once model file is read)
+        unsigned int nbFilesRead() const;
+        unsigned int nbFiles() const;
+
+        // model delivered, failed or cancelled
+        bool finished() const;
+
+        void cancel();
+
+      private:
+        friend class ModelLoader;
+
+        Request(GameFile * file, bool forceAnim);
+
+        bool cancelled() const;
+        void setStage(Stage stage);
+
+        GameFile * m_file;
+        bool m_forceAnim;
+        std::function<void(WoWModel *)> m_onReady;
+        std::function<void(const Request &)> m_onProgress;
+
+        mutable QMutex m_mutex;
+        Stage m_stage;
+        bool m_cancelled;
+        bool m_failed;
+        unsigned int m_nbFiles;
+        unsigned int m_nbFilesRead;
+        unsigned int m_nbTasks; // worker tasks not ended yet
+        std::vector<GameFile *> m_opened;
+
+        // last state reported by update()
+        Stage m_reportedStage;
+        unsigned int m_reportedFilesRead;
+    };
+
+    typedef std::shared_ptr<Request> RequestPtr;
+
+    ModelLoader();
+    ~ModelLoader();
+
+    // starts loading file in background, cancelling any other pending load.
+    // onReady is called by update() with built model, owned by caller (null if model file
+    // can't be read). onProgress is called by update() each time stage or file count changes.
+    RequestPtr load(GameFile * file,
+                    std::function<void(WoWModel *)> onReady,
+                    std::function<void(const Request &)> onProgress = std::function<void(const Request &)>(),
+                    bool forceAnim = true);
+
+    // builds model right away, cancelling any pending load
+    WoWModel * loadNow(GameFile * file, bool forceAnim = true);
+
+    // cancels pending load, if any
+    void cancel();
+
+    // file being loaded in background, 0 if none
+    GameFile * pendingFile() const;
+
+    // to be called regularly from GL thread : reports progress and builds models once their
+    // files are read
+    void update();
+
+    static QString stageName(Stage stage);
+
+  private:
+    class ModelTask : public QRunnable
+    {
+      public:
+        ModelTask(ModelLoader * loader, RequestPtr request) : m_loader(loader), m_request(request) {}
+        void run() { m_loader->readModel(m_request); }
+
+      private:
+        ModelLoader * m_loader;
+        RequestPtr m_request;
+    };
+
+    class FileTask : public QRunnable
+    {
+      public:
+        FileTask(ModelLoader * loader, RequestPtr request, GameFile * file) : m_loader(loader), m_request(request), m_file(file) {}
+        void run() { m_loader->readFile(m_request, m_file); }
+
+      private:
+        ModelLoader * m_loader;
+        RequestPtr m_request;
+        GameFile * m_file;
+    };
+
+    // worker side
+    void readModel(RequestPtr request);
+    void readFile(RequestPtr request, GameFile * file);
+    bool open(RequestPtr request, GameFile * file);
+    static void addFile(std::vector<GameFile *> & files, GameFile * file);
+
+    // copies contents of files read for request, and sets them as their cached contents
+    // until reset by caller
+    static void pin(RequestPtr request, std::vector<GameFile *> & files, std::vector<QByteArray> & contents);
+
+    // closes files opened for request, unless another request still uses them
+    void release(RequestPtr request);
+    void report(RequestPtr request);
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    std::vector<RequestPtr> m_requests;
+    std::map<GameFile *, int> m_fileRefs;
+
+    // held while selecting chunks in model files, from workers and while building models
+    QMutex m_buildMutex;
+};
+
+#endif /* _MODELLOADER_H_ */
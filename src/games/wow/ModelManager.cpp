@@ -7,8 +7,36 @@
 
 #include "ModelManager.h"
 
+#include <list>
+
 #include "WoWModel.h"
 
+namespace
+{
+	struct RetainedModel
+	{
+		WoWModel * model;
+		size_t size;
+	};
+
+	// shared by all managers, most recently released first.
+	// left as is at exit : GL context models were built in may already be gone
+	struct RetentionPool
+	{
+		std::list<RetainedModel> models;
+		size_t size = 0;
+		size_t budget = 256 * 1024 * 1024;
+		unsigned int hits = 0;
+		unsigned int misses = 0;
+	};
+
+	RetentionPool & pool()
+	{
+		static RetentionPool * p = new RetentionPool();
+		return *p;
+	}
+}
+
 // Adds models to the model manager, used by WMO's
 int ModelManager::add(GameFile * file)
 {
@@ -18,13 +46,29 @@ int ModelManager::add(GameFile * file)
 		items[id]->addref();
 		return id;
 	}
-	// load new
-	WoWModel *model = new WoWModel(file);
+	// reuse a retained one, or load new
+	WoWModel *model = reuse(file);
+	if (!model)
+		model = new WoWModel(file);
+	model->setItemName(file->name());
 	id = nextID();
   do_add(file->name(), id, model);
     return id;
 }
 
+void ModelManager::del(int id)
+{
+	auto it = items.find(id);
+	if (it == items.end() || !it->second->delref())
+		return;
+
+	WoWModel * model = (WoWModel *)it->second;
+	names.erase(model->itemName());
+	items.erase(it);
+
+	retain(model);
+}
+
 // Resets the animation back to default.
 void ModelManager::resetAnim()
 {
@@ -44,10 +88,120 @@ void ModelManager::updateEmitters(float dt)
 void ModelManager::clear()
 {
 	for (std::map<int, ManagedItem*>::iterator it = items.begin(); it != items.end(); ++it) {
-		doDelete(it->first);
-		delete it->second;
+		// references held by this manager users go away with it
+		while (it->second->refCount() > 0)
+			it->second->delref();
+		retain((WoWModel *)it->second);
 	}
 	items.clear();
 	names.clear();
 }
 
+void ModelManager::setRetentionBudget(size_t budget)
+{
+	pool().budget = budget;
+	evict();
+}
+
+size_t ModelManager::retentionBudget()
+{
+	return pool().budget;
+}
+
+void ModelManager::flushRetained()
+{
+	RetentionPool & p = pool();
+	for (auto & it : p.models)
+		delete it.model;
+
+	p.models.clear();
+	p.size = 0;
+}
+
+std::set<GLuint> ModelManager::retainedTextures()
+{
+	std::set<GLuint> result;
+	for (auto & it : pool().models)
+	{
+		std::set<GLuint> textures = it.model->glTextures();
+		result.insert(textures.begin(), textures.end());
+	}
+	return result;
+}
+
+size_t ModelManager::nbRetained()
+{
+	return pool().models.size();
+}
+
+size_t ModelManager::retainedSize()
+{
+	return pool().size;
+}
+
+unsigned int ModelManager::nbHits()
+{
+	return pool().hits;
+}
+
+unsigned int ModelManager::nbMisses()
+{
+	return pool().misses;
+}
+
+float ModelManager::hitRate()
+{
+	const RetentionPool & p = pool();
+	return (p.hits + p.misses > 0) ? (float)p.hits / (p.hits + p.misses) : 0.f;
+}
+
+WoWModel * ModelManager::reuse(GameFile * file)
+{
+	RetentionPool & p = pool();
+	for (auto it = p.models.begin(); it != p.models.end(); ++it)
+	{
+		if (it->model->gamefile != file)
+			continue;
+
+		WoWModel * model = it->model;
+		p.size -= it->size;
+		p.models.erase(it);
+		p.hits++;
+
+		model->reset();
+		return model;
+	}
+
+	p.misses++;
+	return 0;
+}
+
+void ModelManager::retain(WoWModel * model)
+{
+	RetentionPool & p = pool();
+	if (!model->ok || p.budget == 0)
+	{
+		delete model;
+		return;
+	}
+
+	RetainedModel retained;
+	retained.model = model;
+	retained.size = model->memorySize();
+
+	p.models.push_front(retained);
+	p.size += retained.size;
+
+	evict();
+}
+
+void ModelManager::evict()
+{
+	RetentionPool & p = pool();
+	while (p.size > p.budget && !p.models.empty())
+	{
+		p.size -= p.models.back().size;
+		delete p.models.back().model;
+		p.models.pop_back();
+	}
+}
@@ -8,11 +8,30 @@
 #ifndef _MODELMANAGER_H_
 #define _MODELMANAGER_H_
 
+#include <set>
+
 #include "manager.h"
 
-class ModelManager: public SimpleManager {
+class WoWModel;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _MODELMANAGER_API_ __declspec(dllexport)
+#    else
+#        define _MODELMANAGER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _MODELMANAGER_API_
+#endif
+
+// Models released by managers (last reference deleted, or manager cleared) are not deleted
+// right away but retained, as long as they fit in retention budget : adding them again to
+// any manager (WMO revisited, or another WMO sharing doodads) reuses them as they are.
+// When budget is exceeded, least recently released models are deleted first.
+class _MODELMANAGER_API_ ModelManager: public SimpleManager {
 public:
 	int add(GameFile *);
+	void del(int id);
 
 	ModelManager() : v(0) {}
 
@@ -22,6 +41,27 @@ public:
 	void updateEmitters(float dt);
 	void clear();
 
+	// retention budget, in bytes (0 disables retention)
+	static void setRetentionBudget(size_t budget);
+	static size_t retentionBudget();
+
+	// deletes all retained models (GL context must be current)
+	static void flushRetained();
+
+	// GL textures used by retained models, to keep when clearing TEXTUREMANAGER
+	static std::set<GLuint> retainedTextures();
+
+	// retention statistics
+	static size_t nbRetained();
+	static size_t retainedSize();
+	static unsigned int nbHits();
+	static unsigned int nbMisses();
+	static float hitRate();
+
+private:
+	static WoWModel * reuse(GameFile *);
+	static void retain(WoWModel *);
+	static void evict();
 };
 
 
@@ -7,6 +7,8 @@
 	#include "GL\wglew.h"
 #elif _MAC
 	#include <GL/glew.h>
+#elif defined(GLEW_OSMESA) || defined(GLEW_EGL) // headless _LINUX, no X11
+	#include <GL/glew.h>
 #else // _LINUX
 	#include <GL/glew.h>
 	#include <GL/glxew.h>
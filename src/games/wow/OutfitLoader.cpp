@@ -0,0 +1,520 @@
+/*
+ * OutfitLoader.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "OutfitLoader.h"
+
+#include <algorithm>
+
+#include <QStringList>
+#include <QThread>
+
+#include "database.h" // items
+#include "Game.h"
+#include "GameFile.h"
+#include "RaceInfos.h"
+#include "TextureManager.h"
+#include "WoWModel.h"
+
+#include "logger/Logger.h"
+
+OutfitLoader::OutfitLoader(WoWModel * model)
+  : m_model(model)
+{
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+OutfitLoader::~OutfitLoader()
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    m_pending.clear();
+  }
+  m_pool.waitForDone();
+}
+
+void OutfitLoader::setItem(CharSlots slot, int itemId)
+{
+  WoWItem * item = m_model ? m_model->getItem(slot) : 0;
+  if (!item || itemId < 0)
+    return;
+
+  Request request = { item, itemId, -1 };
+
+  for (auto & it : m_requests)
+  {
+    if (it.item == item)
+    {
+      it = request;
+      return;
+    }
+  }
+
+  m_requests.push_back(request);
+}
+
+void OutfitLoader::setDisplay(CharSlots slot, int displayId)
+{
+  WoWItem * item = m_model ? m_model->getItem(slot) : 0;
+  if (!item)
+    return;
+
+  Request request = { item, -1, displayId };
+
+  for (auto & it : m_requests)
+  {
+    if (it.item == item)
+    {
+      it = request;
+      return;
+    }
+  }
+
+  m_requests.push_back(request);
+}
+
+void OutfitLoader::apply()
+{
+  // same as WoWItem::setId / setDisplayId : nothing to do if item doesn't change
+  std::vector<Request> requests;
+  for (auto it : m_requests)
+  {
+    if ((it.itemId != -1 && it.itemId != it.item->m_id) ||
+        (it.itemId == -1 && it.displayId != it.item->m_displayId))
+      requests.push_back(it);
+  }
+  m_requests = requests;
+
+  if (m_requests.empty())
+    return;
+
+  resolveItems();
+
+  std::map<WoWItem *, WoWItem::DisplayInfos> infos;
+  resolveDisplays(infos);
+
+  // read files in the order they will be needed : textures first, as they are
+  // loaded before any old item is released, then models
+  std::vector<GameFile *> textures, models;
+  for (auto & it : infos)
+  {
+    const WoWItem::DisplayInfos & info = it.second;
+
+    std::vector<int> textureIds(info.materialTextures);
+    textureIds.push_back(info.texture[0]);
+    textureIds.push_back(info.texture[1]);
+
+    for (auto id : textureIds)
+    {
+      GameFile * file = (id != 0) ? GAMEDIRECTORY.getFile(id) : 0;
+      if (file && std::find(textures.begin(), textures.end(), file) == textures.end())
+        textures.push_back(file);
+    }
+
+    for (size_t i = 0; i < 2; i++)
+    {
+      GameFile * file = (info.model[i] != 0) ? GAMEDIRECTORY.getFile(info.model[i]) : 0;
+      if (file && std::find(models.begin(), models.end(), file) == models.end())
+        models.push_back(file);
+    }
+  }
+
+  std::vector<GameFile *> files(textures);
+  files.insert(files.end(), models.begin(), models.end());
+  prefetch(files);
+
+  m_model->lockRefresh();
+
+  // keep new textures loaded while items are unloaded, so that textures shared by
+  // old and new outfits are not deleted then reloaded
+  for (auto file : textures)
+  {
+    waitFor(file);
+    TEXTUREMANAGER.add(file);
+  }
+
+  for (auto & request : m_requests)
+  {
+    WoWItem * item = request.item;
+
+    if (request.itemId == 0)
+    {
+      item->setId(0);
+      continue;
+    }
+
+    item->unload();
+
+    if (item->m_id == 0 || item->m_displayId == 0)
+      continue;
+
+    auto it = infos.find(item);
+    if (it == infos.end())
+      continue;
+
+    for (size_t i = 0; i < 2; i++)
+    {
+      if (it->second.model[i] != 0)
+        waitFor(GAMEDIRECTORY.getFile(it->second.model[i]));
+    }
+
+    item->apply(it->second);
+  }
+
+  // single refresh for the whole outfit
+  m_model->refresh();
+  m_model->unlockRefresh();
+
+  for (auto file : textures)
+    TEXTUREMANAGER.delbyname(file->fullname());
+
+  // files not used (model failing to load, etc.) must not keep their content in memory
+  {
+    QMutexLocker locker(&m_mutex);
+    m_pending.clear();
+  }
+  m_pool.waitForDone();
+
+  for (auto file : files)
+    file->close();
+
+  m_requests.clear();
+}
+
+void OutfitLoader::resolveItems()
+{
+  std::set<int> itemIds;
+  for (auto it : m_requests)
+  {
+    if (it.itemId > 0)
+      itemIds.insert(it.itemId);
+  }
+
+  if (itemIds.empty())
+    return;
+
+  // item levels, for all items at once
+  std::map<int, std::vector<int> > appearances;
+  sqlResult result = GAMEDATABASE.sqlQuery(QString("SELECT ItemID, ItemAppearanceID FROM ItemModifiedAppearance "
+                                                   "WHERE ItemID IN (%1)").arg(idList(itemIds)));
+  if (result.valid)
+  {
+    for (auto & it : result.values)
+      appearances[it[0].toInt()].push_back(it[1].toInt());
+  }
+
+  std::set<int> appearanceIds;
+  for (auto & request : m_requests)
+  {
+    if (request.itemId <= 0)
+      continue;
+
+    WoWItem * item = request.item;
+    item->m_id = request.itemId;
+
+    auto it = appearances.find(request.itemId);
+    if (it != appearances.end())
+      item->setLevels(it->second);
+
+    appearanceIds.insert(item->m_levelDisplayMap[item->m_level]);
+  }
+
+  // display ids
+  std::map<int, int> displays;
+  result = GAMEDATABASE.sqlQuery(QString("SELECT ID, ItemDisplayInfoID FROM ItemAppearance WHERE ID IN (%1)").arg(idList(appearanceIds)));
+  if (result.valid)
+  {
+    for (auto & it : result.values)
+      displays[it[0].toInt()] = it[1].toInt();
+  }
+
+  for (auto & request : m_requests)
+  {
+    if (request.itemId <= 0)
+      continue;
+
+    WoWItem * item = request.item;
+
+    auto it = displays.find(item->m_levelDisplayMap[item->m_level]);
+    if (it != displays.end())
+      item->m_displayId = it->second;
+
+    ItemRecord itemRcd = items.getById(request.itemId);
+    item->setName(itemRcd.name);
+    item->m_quality = itemRcd.quality;
+    item->m_type = itemRcd.type;
+  }
+
+  for (auto & request : m_requests)
+  {
+    if (request.itemId != -1)
+      continue;
+
+    request.item->m_id = -1;
+    request.item->m_displayId = request.displayId;
+    request.item->setName("NPC Item");
+  }
+}
+
+void OutfitLoader::resolveDisplays(std::map<WoWItem *, WoWItem::DisplayInfos> & result)
+{
+  std::set<int> displayIds;
+  for (auto it : m_requests)
+  {
+    if (it.itemId != 0 && it.item->m_displayId > 0)
+      displayIds.insert(it.item->m_displayId);
+  }
+
+  if (displayIds.empty())
+    return;
+
+  RaceInfos charInfos;
+  RaceInfos::getCurrent(m_model, charInfos);
+
+  QString displays = idList(displayIds);
+
+  // geosets
+  std::map<int, WoWItem::DisplayInfos> infos;
+  QString query = QString("SELECT ID, GeoSetGroup1, GeoSetGroup2, GeoSetGroup3, GeoSetGroup4, GeoSetGroup5, GeoSetGroup6 "
+                          "FROM ItemDisplayInfo WHERE ID IN (%1)").arg(displays);
+  sqlResult r = GAMEDATABASE.sqlQuery(query);
+
+  if (!r.valid || r.empty())
+  {
+    LOG_ERROR << "Impossible to query information for outfit - SQL ERROR";
+    LOG_ERROR << query;
+    return;
+  }
+
+  for (auto & it : r.values)
+  {
+    WoWItem::DisplayInfos & info = infos[it[0].toInt()];
+    // same as WoWItem::queryDisplayInfos, group 5 is used for both 5th and 6th values
+    info.geosetGroup[0] = it[1].toInt();
+    info.geosetGroup[1] = it[2].toInt();
+    info.geosetGroup[2] = it[3].toInt();
+    info.geosetGroup[3] = it[4].toInt();
+    info.geosetGroup[4] = it[6].toInt();
+    info.geosetGroup[5] = it[6].toInt();
+  }
+
+  // model candidates (one per race / gender), then their customization
+  std::map<int, std::vector<int> > modelCandidates[2];
+  std::set<int> modelIds;
+  r = GAMEDATABASE.sqlQuery(QString("SELECT ItemDisplayInfo.ID, 0, ModelID FROM ItemDisplayInfo "
+                                    "LEFT JOIN ModelFileData ON Model1 = ModelFileData.ID WHERE ItemDisplayInfo.ID IN (%1) "
+                                    "UNION ALL "
+                                    "SELECT ItemDisplayInfo.ID, 1, ModelID FROM ItemDisplayInfo "
+                                    "LEFT JOIN ModelFileData ON Model2 = ModelFileData.ID WHERE ItemDisplayInfo.ID IN (%1)").arg(displays));
+  if (r.valid)
+  {
+    for (auto & it : r.values)
+    {
+      modelCandidates[it[1].toInt()][it[0].toInt()].push_back(it[2].toInt());
+      modelIds.insert(it[2].toInt());
+    }
+  }
+
+  std::vector<std::vector<int> > modelComponents; // ID, GenderIndex, RaceID, PositionIndex
+  if (!modelIds.empty())
+  {
+    r = GAMEDATABASE.sqlQuery(QString("SELECT ID, GenderIndex, RaceID, PositionIndex FROM ComponentModelFileData "
+                                      "WHERE ID IN (%1)").arg(idList(modelIds)));
+    for (auto & it : r.values)
+      modelComponents.push_back({ it[0].toInt(), it[1].toInt(), it[2].toInt(), it[3].toInt() });
+  }
+
+  // texture candidates, then their customization
+  std::map<int, std::vector<int> > textureCandidates[2];
+  std::set<int> textureIds;
+  r = GAMEDATABASE.sqlQuery(QString("SELECT ItemDisplayInfo.ID, 0, TextureID FROM ItemDisplayInfo "
+                                    "LEFT JOIN TextureFileData ON TextureItemID1 = TextureFileData.ID WHERE ItemDisplayInfo.ID IN (%1) "
+                                    "UNION ALL "
+                                    "SELECT ItemDisplayInfo.ID, 1, TextureID FROM ItemDisplayInfo "
+                                    "LEFT JOIN TextureFileData ON TextureItemID2 = TextureFileData.ID WHERE ItemDisplayInfo.ID IN (%1)").arg(displays));
+  if (r.valid)
+  {
+    for (auto & it : r.values)
+    {
+      textureCandidates[it[1].toInt()][it[0].toInt()].push_back(it[2].toInt());
+      textureIds.insert(it[2].toInt());
+    }
+  }
+
+  std::vector<std::vector<int> > textureComponents; // ID, GenderIndex, RaceID
+  if (!textureIds.empty())
+  {
+    r = GAMEDATABASE.sqlQuery(QString("SELECT ID, GenderIndex, RaceID FROM ComponentTextureFileData "
+                                      "WHERE ID IN (%1)").arg(idList(textureIds)));
+    for (auto & it : r.values)
+      textureComponents.push_back({ it[0].toInt(), it[1].toInt(), it[2].toInt() });
+  }
+
+  // textures from ItemDisplayInfoMaterialRes
+  r = GAMEDATABASE.sqlQuery(QString("SELECT ItemDisplayInfoID, TextureID FROM ItemDisplayInfoMaterialRes "
+                                    "LEFT JOIN TextureFileData ON TextureFileDataID = TextureFileData.ID "
+                                    "INNER JOIN ComponentTextureFileData ON ComponentTextureFileData.ID = TextureFileData.TextureID "
+                                    "AND (ComponentTextureFileData.GenderIndex = 3 OR ComponentTextureFileData.GenderIndex = %1) "
+                                    "WHERE ItemDisplayInfoID IN (%2)").arg(charInfos.sexid).arg(displays));
+  if (r.valid)
+  {
+    for (auto & it : r.values)
+    {
+      auto info = infos.find(it[0].toInt());
+      if (info != infos.end())
+        info->second.materialTextures.push_back(it[1].toInt());
+    }
+  }
+
+  // pick models and textures matching character, as WoWItem::getCustomModelId / getCustomTextureId do
+  for (auto & it : infos)
+  {
+    int displayId = it.first;
+    WoWItem::DisplayInfos & info = it.second;
+
+    for (size_t index = 0; index < 2; index++)
+    {
+      const std::vector<int> & models = modelCandidates[index][displayId];
+      if (models.size() == 1)
+      {
+        info.model[index] = models[0];
+      }
+      else if (models.size() > 1)
+      {
+        size_t i = 0;
+        for (auto & c : modelComponents)
+        {
+          if (std::find(models.begin(), models.end(), c[0]) == models.end())
+            continue;
+
+          int gender = c[1];
+          int race = c[2];
+          // models are customized by race and gender
+          // if gender == 2, no customization
+          int fallbackRaceID = 0;
+          if (gender == 0)
+            fallbackRaceID = charInfos.MaleModelFallbackRaceID;
+          else if (gender == 1)
+            fallbackRaceID = charInfos.FemaleModelFallbackRaceID;
+          if (((gender == charInfos.sexid) && ((race == charInfos.raceid) || (fallbackRaceID > 0 && (race == fallbackRaceID)))) ||
+              ((gender == 2) && (i == index)))
+          {
+            info.model[index] = c[0];
+            break;
+          }
+          i++;
+        }
+      }
+
+      const std::vector<int> & textures = textureCandidates[index][displayId];
+      if (textures.size() == 1)
+      {
+        info.texture[index] = textures[0];
+      }
+      else if (textures.size() > 1)
+      {
+        for (auto & c : textureComponents)
+        {
+          if (std::find(textures.begin(), textures.end(), c[0]) == textures.end())
+            continue;
+
+          int gender = c[1];
+          int race = c[2];
+          int fallbackRaceID = 0;
+          if (gender == 0)
+            fallbackRaceID = charInfos.MaleTextureFallbackRaceID;
+          else if (gender == 1)
+            fallbackRaceID = charInfos.FemaleTextureFallbackRaceID;
+          // textures are customized by race and gender (gender == 3 means both sex)
+          if (((gender == charInfos.sexid) || (gender == 3)) && ((race == charInfos.raceid) || (fallbackRaceID > 0 && (race == fallbackRaceID))))
+          {
+            info.texture[index] = c[0];
+            break;
+          }
+        }
+      }
+    }
+
+    // shoulders : first component found tells which model is the left one
+    for (auto & c : modelComponents)
+    {
+      if (c[0] == info.model[0] || c[0] == info.model[1])
+      {
+        if (c[0] == info.model[0])
+          info.leftShoulderIndex = (c[3] == 0) ? 0 : 1;
+        else
+          info.leftShoulderIndex = (c[3] == 0) ? 1 : 0;
+        break;
+      }
+    }
+  }
+
+  for (auto request : m_requests)
+  {
+    auto it = infos.find(request.item->m_displayId);
+    if (it != infos.end())
+      result[request.item] = it->second;
+    else if (request.itemId != 0)
+      LOG_ERROR << "Impossible to query information for item" << request.item->name() << "(id " << request.item->m_id << "- display id" << request.item->m_displayId << ")";
+  }
+}
+
+void OutfitLoader::prefetch(const std::vector<GameFile *> & files)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    m_pending.assign(files.begin(), files.end());
+  }
+
+  int nbWorkers = std::min(m_pool.maxThreadCount(), (int)files.size());
+  for (int i = 0; i < nbWorkers; i++)
+    m_pool.start(new Worker(this));
+}
+
+void OutfitLoader::waitFor(GameFile * file)
+{
+  QMutexLocker locker(&m_mutex);
+
+  // not read yet : caller will open it itself when needed
+  auto it = std::find(m_pending.begin(), m_pending.end(), file);
+  if (it != m_pending.end())
+    m_pending.erase(it);
+
+  while (m_inProgress.count(file) != 0)
+    m_fileOpened.wait(&m_mutex);
+}
+
+bool OutfitLoader::loadNext()
+{
+  GameFile * file;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.empty())
+      return false;
+
+    file = m_pending.front();
+    m_pending.pop_front();
+    m_inProgress.insert(file);
+  }
+
+  file->open();
+
+  QMutexLocker locker(&m_mutex);
+  m_inProgress.erase(file);
+  m_fileOpened.wakeAll();
+
+  return true;
+}
+
+QString OutfitLoader::idList(const std::set<int> & ids)
+{
+  QStringList result;
+  for (auto id : ids)
+    result.append(QString::number(id));
+
+  return result.join(",");
+}
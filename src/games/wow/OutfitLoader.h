@@ -0,0 +1,97 @@
+/*
+ * OutfitLoader.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _OUTFITLOADER_H_
+#define _OUTFITLOADER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <QMutex>
+#include <QRunnable>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "wow_enums.h"
+#include "WoWItem.h"
+
+class GameFile;
+class WoWModel;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _OUTFITLOADER_API_ __declspec(dllexport)
+#    else
+#        define _OUTFITLOADER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _OUTFITLOADER_API_
+#endif
+
+// Equips a whole outfit on a character at once.
+// Equivalent to calling WoWItem::setId / setDisplayId slot by slot, but :
+//  - item looks of all slots are resolved with a few set based queries, instead of
+//    ten or so queries per item
+//  - model and texture files are read by worker threads, while models are built on
+//    calling (GL) thread
+//  - textures shared by old and new outfit are not released and reloaded
+//  - character is refreshed only once, when all items are loaded
+class _OUTFITLOADER_API_ OutfitLoader
+{
+  public:
+    explicit OutfitLoader(WoWModel * model);
+    ~OutfitLoader();
+
+    // 0 removes item from slot
+    void setItem(CharSlots slot, int itemId);
+    void setDisplay(CharSlots slot, int displayId);
+
+    // loads all items set and refreshes character
+    void apply();
+
+  private:
+    class Worker : public QRunnable
+    {
+      public:
+        explicit Worker(OutfitLoader * loader) : m_loader(loader) {}
+        void run() { while (m_loader->loadNext()); }
+
+      private:
+        OutfitLoader * m_loader;
+    };
+
+    struct Request
+    {
+      WoWItem * item;
+      int itemId;
+      int displayId;
+    };
+
+    void resolveItems();
+    void resolveDisplays(std::map<WoWItem *, WoWItem::DisplayInfos> & result);
+
+    // file prefetching
+    void prefetch(const std::vector<GameFile *> & files);
+    void waitFor(GameFile * file);
+    bool loadNext();
+
+    static QString idList(const std::set<int> & ids);
+
+    WoWModel * m_model;
+    std::vector<Request> m_requests;
+
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QWaitCondition m_fileOpened;
+    std::deque<GameFile *> m_pending;
+    std::set<GameFile *> m_inProgress;
+};
+
+#endif /* _OUTFITLOADER_H_ */
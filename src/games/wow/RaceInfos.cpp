@@ -1,5 +1,11 @@
 #include "RaceInfos.h"
 
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <QStringList>
+
 #include "Game.h"
 #include "WoWDatabase.h"
 #include "WoWModel.h"
@@ -32,24 +38,70 @@ bool RaceInfos::getCurrent(WoWModel * model, RaceInfos & result)
 
 void RaceInfos::init()
 {
-  sqlResult races = 
-    GAMEDATABASE.sqlQuery("SELECT CMDM.FileID as malemodel, lower(ClientPrefix), CharComponentTexLayoutID, "
-                          "CMDF.FileID AS femalemodel, lower(ClientPrefix), CharComponentTexLayoutID, "
-                          "CMDMHD.FileID as malemodelHD, lower(ClientPrefix), CharComponentTexLayoutHiResID, "
-                          "CMDFHD.FileID AS femalemodelHD, lower(ClientPrefix), CharComponentTexLayoutHiResID, "
-                          "ChrRaces.ID, BaseRaceID, Flags, MaleModelFallbackRaceID, FemaleModelFallbackRaceID, MaleTextureFallbackRaceID, FemaleTextureFallbackRaceID FROM ChrRaces "
-                          "LEFT JOIN CreatureDisplayInfo CDIM ON CDIM.ID = MaleDisplayID LEFT JOIN CreatureModelData CMDM ON CDIM.ModelID = CMDM.ID "
-                          "LEFT JOIN CreatureDisplayInfo CDIF ON CDIF.ID = FemaleDisplayID LEFT JOIN CreatureModelData CMDF ON CDIF.ModelID = CMDF.ID "
-                          "LEFT JOIN CreatureDisplayInfo CDIMHD ON CDIMHD.ID = HighResMaleDisplayId LEFT JOIN CreatureModelData CMDMHD ON CDIMHD.ModelID = CMDMHD.ID "
-                          "LEFT JOIN CreatureDisplayInfo CDIFHD ON CDIFHD.ID = HighResFemaleDisplayId LEFT JOIN CreatureModelData CMDFHD ON CDIFHD.ModelID = CMDFHD.ID");
-
-  if(!races.valid || races.empty())
+  RACES.clear();
+
+  // read straight from game files, model file of each display being resolved in memory
+  // (ChrRaces -> CreatureDisplayInfo -> CreatureModelData)
+  std::vector<std::vector<std::string> > races;
+  std::map<int, int> displayModels; // display id -> model id
+  std::map<int, int> modelFiles; // model id -> file id
+
+  bool ok = GAMEDATABASE.readTable("ChrRaces",
+                                   QStringList() << "MaleDisplayID" << "ClientPrefix" << "CharComponentTexLayoutID"
+                                                 << "FemaleDisplayID" << "ClientPrefix" << "CharComponentTexLayoutID"
+                                                 << "HighResMaleDisplayId" << "ClientPrefix" << "CharComponentTexLayoutHiResID"
+                                                 << "HighResFemaleDisplayId" << "ClientPrefix" << "CharComponentTexLayoutHiResID"
+                                                 << "ID" << "BaseRaceID" << "Flags"
+                                                 << "MaleModelFallbackRaceID" << "FemaleModelFallbackRaceID"
+                                                 << "MaleTextureFallbackRaceID" << "FemaleTextureFallbackRaceID",
+                                   [&](const std::vector<std::string> & value)
+  {
+    races.push_back(value);
+    for (int r = 0; r < 12; r += 3)
+      displayModels[atoi(value[r].c_str())] = 0;
+  });
+
+  ok = ok && GAMEDATABASE.readTable("CreatureDisplayInfo", QStringList() << "ID" << "ModelID",
+                                    [&](const std::vector<std::string> & value)
+  {
+    auto it = displayModels.find(atoi(value[0].c_str()));
+    if (it != displayModels.end())
+    {
+      it->second = atoi(value[1].c_str());
+      modelFiles[it->second] = 0;
+    }
+  });
+
+  ok = ok && GAMEDATABASE.readTable("CreatureModelData", QStringList() << "ID" << "FileID",
+                                    [&](const std::vector<std::string> & value)
+  {
+    auto it = modelFiles.find(atoi(value[0].c_str()));
+    if (it != modelFiles.end())
+      it->second = atoi(value[1].c_str());
+  });
+
+  if(!ok || races.empty())
   {
     LOG_ERROR << "Unable to collect race information from game database";
     return;
   }
 
-  for (auto& value : races.values)
+  for (auto& value : races)
+  {
+    // model file of each display, "" if not found (as sql LEFT JOIN would give)
+    for (int r = 0; r < 12; r += 3)
+    {
+      auto display = displayModels.find(atoi(value[r].c_str()));
+      auto model = modelFiles.end();
+      if (display != displayModels.end() && display->second != 0)
+        model = modelFiles.find(display->second);
+
+      value[r] = (model != modelFiles.end() && model->second != 0) ? std::to_string(model->second) : "";
+      value[r + 1] = QString::fromStdString(value[r + 1]).toLower().toStdString();
+    }
+  }
+
+  for (auto& value : races)
   {
     std::string displayPrefix;
 
@@ -58,17 +110,17 @@ void RaceInfos::init()
       if(value[r] != "")
       {
         RaceInfos infos;
-        infos.prefix = !displayPrefix.empty() ? displayPrefix : value[r + 1].toStdString();
-        infos.textureLayoutID = value[r+2].toInt();
-        infos.raceid = value[12].toInt();
+        infos.prefix = !displayPrefix.empty() ? displayPrefix : value[r + 1];
+        infos.textureLayoutID = atoi(value[r+2].c_str());
+        infos.raceid = atoi(value[12].c_str());
         infos.sexid = (r == 0 || r == 6)?0:1;
-        infos.barefeet = (value[14].toInt() & 0x2);
+        infos.barefeet = (atoi(value[14].c_str()) & 0x2);
         // Get fallback display race ID (this is mostly for allied races and others that rely on
         // item display info from other race models):
-        infos.MaleModelFallbackRaceID = value[15].toInt();
-        infos.FemaleModelFallbackRaceID = value[16].toInt();
-        infos.MaleTextureFallbackRaceID = value[17].toInt();
-        infos.FemaleTextureFallbackRaceID = value[18].toInt();
+        infos.MaleModelFallbackRaceID = atoi(value[15].c_str());
+        infos.FemaleModelFallbackRaceID = atoi(value[16].c_str());
+        infos.MaleTextureFallbackRaceID = atoi(value[17].c_str());
+        infos.FemaleTextureFallbackRaceID = atoi(value[18].c_str());
 
  /*      
         // workaround - manually associate display race id with related race - info not in db ?
@@ -92,7 +144,7 @@ void RaceInfos::init()
         }
 */
 
-        int modelfileid = value[r].toInt();
+        int modelfileid = atoi(value[r].c_str());
         
         if ((r == 6) || (r == 9)) // if we are dealing with a HD model
           infos.isHD = true;
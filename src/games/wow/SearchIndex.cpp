@@ -0,0 +1,141 @@
+/*
+ * SearchIndex.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+SearchIndex::SearchIndex()
+{
+}
+
+void SearchIndex::clear()
+{
+  m_entries.clear();
+  m_names.clear();
+  m_nameEntries.clear();
+  m_nameIds.clear();
+  m_trigrams.clear();
+}
+
+quint64 SearchIndex::trigram(const QChar * c)
+{
+  return ((quint64)c[0].unicode() << 32) | ((quint64)c[1].unicode() << 16) | (quint64)c[2].unicode();
+}
+
+void SearchIndex::add(int id, const QString & name)
+{
+  QString lower = name.toLower();
+
+  int nameId;
+  QHash<QString, int>::const_iterator it = m_nameIds.constFind(lower);
+  if (it != m_nameIds.constEnd())
+  {
+    nameId = it.value();
+  }
+  else
+  {
+    nameId = (int)m_names.size();
+    m_nameIds.insert(lower, nameId);
+    m_names.push_back(lower);
+    m_nameEntries.push_back(std::vector<int>());
+
+    // names are numbered in increasing order, so posting lists stay sorted
+    const QChar * c = lower.constData();
+    for (int i = 0; i + 2 < lower.size(); i++)
+    {
+      std::vector<int> & names = m_trigrams[trigram(c + i)];
+      if (names.empty() || names.back() != nameId)
+        names.push_back(nameId);
+    }
+  }
+
+  m_nameEntries[nameId].push_back((int)m_entries.size());
+
+  Entry e;
+  e.id = id;
+  e.name = nameId;
+  m_entries.push_back(e);
+}
+
+std::vector<int> SearchIndex::search(const QString & query) const
+{
+  std::vector<int> result;
+
+  QString q = query.trimmed().toLower();
+
+  if (q.isEmpty())
+  {
+    result.reserve(m_entries.size());
+    for (auto & e : m_entries)
+      result.push_back(e.id);
+    return result;
+  }
+
+  // candidate names : all of them for short queries, names sharing every query trigram otherwise
+  std::vector<int> candidates;
+  bool allNames = (q.size() < 3);
+
+  if (!allNames)
+  {
+    std::vector<const std::vector<int> *> lists;
+    const QChar * c = q.constData();
+    for (int i = 0; i + 2 < q.size(); i++)
+    {
+      auto it = m_trigrams.find(trigram(c + i));
+      if (it == m_trigrams.end())
+        return result;
+      lists.push_back(&it->second);
+    }
+
+    // intersect smallest lists first
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<int> * a, const std::vector<int> * b) { return a->size() < b->size(); });
+
+    candidates = *lists[0];
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); i++)
+    {
+      std::vector<int> common;
+      std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                            std::back_inserter(common));
+      candidates.swap(common);
+    }
+  }
+
+  // (rank, entry) of every entry whose name really contains query
+  std::vector<std::pair<int, int> > matches;
+  size_t nbCandidates = allNames ? m_names.size() : candidates.size();
+
+  for (size_t i = 0; i < nbCandidates; i++)
+  {
+    int nameId = allNames ? (int)i : candidates[i];
+    const QString & name = m_names[nameId];
+
+    int pos = name.indexOf(q);
+    if (pos == -1)
+      continue;
+
+    int rank = 3;
+    if (pos == 0)
+      rank = (name.size() == q.size()) ? 0 : 1;
+    else if (!name[pos - 1].isLetterOrNumber())
+      rank = 2;
+
+    for (auto entry : m_nameEntries[nameId])
+      matches.push_back(std::make_pair(rank, entry));
+  }
+
+  std::sort(matches.begin(), matches.end());
+
+  result.reserve(matches.size());
+  for (auto & m : matches)
+    result.push_back(m_entries[m.second].id);
+
+  return result;
+}
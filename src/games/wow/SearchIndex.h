@@ -0,0 +1,63 @@
+/*
+ * SearchIndex.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _SEARCHINDEX_H_
+#define _SEARCHINDEX_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _SEARCHINDEX_API_ __declspec(dllexport)
+#    else
+#        define _SEARCHINDEX_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _SEARCHINDEX_API_
+#endif
+
+// Case insensitive substring search over a list of named entries (items, npcs...).
+// Names are interned (lower cased and stored once, whatever the number of entries
+// using them) and a trigram index is kept over them, so that a query only verifies
+// names containing all of its trigrams instead of scanning every entry.
+class _SEARCHINDEX_API_ SearchIndex
+{
+  public:
+    SearchIndex();
+
+    void add(int id, const QString & name);
+    void clear();
+
+    size_t size() const { return m_entries.size(); }
+
+    // ids of entries whose name contains query, best matches first :
+    // exact name, then name starting with query, then a word starting with query,
+    // then any other match. Entries keep insertion order within each rank.
+    // empty query returns all entries in insertion order.
+    std::vector<int> search(const QString & query) const;
+
+  private:
+    struct Entry
+    {
+      int id;
+      int name;
+    };
+
+    static quint64 trigram(const QChar * c);
+
+    std::vector<Entry> m_entries;
+    std::vector<QString> m_names;
+    std::vector<std::vector<int> > m_nameEntries; // name -> entries
+    QHash<QString, int> m_nameIds;
+    std::unordered_map<quint64, std::vector<int> > m_trigrams; // trigram -> sorted names
+};
+
+#endif /* _SEARCHINDEX_H_ */
@@ -6,6 +6,9 @@
 #include "GameFile.h"
 #include "video.h"
 
+#include <cstring>
+#include <vector>
+
 #include <QImage>
 
 #include "OpenGLHeaders.h"
@@ -22,264 +25,228 @@ void Texture::getPixels(unsigned char* buf, unsigned int format)
 	glGetTexImage(GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, buf);
 }
 
-void Texture::load()
+namespace
 {
-  // Vars
-  int offsets[16], sizes[16], type = 0;
-  uint width = 0, height = 0;
-  GLint format = 0;
-  char attr[4];
+  const size_t BLP_HEADER_SIZE = 148; // magic, type, attributes, size, mipmaps offsets and sizes
+  const size_t BLP_PALETTE_SIZE = 1024;
 
-  // bind the texture
-  glBindTexture(GL_TEXTURE_2D, id);
+  /*
+  reference: http://en.wikipedia.org/wiki/.BLP
+  */
+  struct BLPHeader
+  {
+    int type; // 0 : JPEG, 1 : encoding given by attr[0]
+    unsigned char attr[4]; // encoding, alpha depth, alpha encoding, has mipmaps
+    uint width, height;
+    int offsets[16], sizes[16];
+  };
 
-  if (!file || !file->open() || file->isEof()) 
+  bool readHeader(const unsigned char * data, size_t size, BLPHeader & header)
   {
-    id = 0;
-    return;
+    if (!data || size < BLP_HEADER_SIZE)
+      return false;
+
+    memcpy(&header.type, data + 4, 4);
+    memcpy(header.attr, data + 8, 4);
+    memcpy(&header.width, data + 12, 4);
+    memcpy(&header.height, data + 16, 4);
+    memcpy(header.offsets, data + 20, 4 * 16);
+    memcpy(header.sizes, data + 84, 4 * 16);
+
+    return header.width != 0 && header.height != 0;
   }
-  else {
-    //tex->id = id; // I don't see the id being set anywhere,  should I set it now?
+
+  // true if mip level is stored in data
+  bool hasMip(const BLPHeader & header, size_t level, size_t size)
+  {
+    return header.offsets[level] > 0 && header.sizes[level] > 0 &&
+           (size_t)header.offsets[level] + header.sizes[level] <= size;
   }
 
-  file->seek(4);
-  file->read(&type, 4);
-  file->read(attr, 4);
-  file->read(&width, 4);
-  file->read(&height, 4);
-  file->read(offsets, 4 * 16);
-  file->read(sizes, 4 * 16);
+  // encoding 2 : format and block size of DirectX compressed data
+  GLint dxtFormat(const BLPHeader & header, int & blocksize)
+  {
+    /*
+    Type 1 Encoding 2 AlphaDepth 0 (DXT1 no alpha)
+    The image data is formatted using DXT1 compression with no alpha channel.
 
-  bool hasmipmaps = (attr[3]>0);
-  size_t mipmax = hasmipmaps ? 16 : 1;
+    Type 1 Encoding 2 AlphaDepth 1 (DXT1 one bit alpha)
+    The image data is formatted using DXT1 compression with a one-bit alpha channel.
 
-  w = width;
-  h = height;
+    Type 1 Encoding 2 AlphaDepth 8 (DXT3)
+    The image data is formatted using DXT3 compression.
 
-  /*
-  reference: http://en.wikipedia.org/wiki/.BLP
-  */
-  if (type == 0) // JPEG compression
-  { 
-    /*
-    * DWORD JpegHeaderSize;
-    * BYTE[JpegHeaderSize] JpegHeader;
-    * struct MipMap[16]
-    * {
-    *     BYTE[???] JpegData;
-    * }
+    Type 1 Encoding 2 AlphaDepth 8 AlphaEncoding 7 (DXT5)
+    The image data are formatted using DXT5 compression.
     */
-    LOG_ERROR << __FILE__ << __FUNCTION__ << __LINE__ << "type=" << type;
+    GLint format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    blocksize = 8;
 
-    BYTE *buffer = NULL;
-    unsigned char *buf = new unsigned char[sizes[0]];
+    // guesswork here :(
+    // new alpha bit depth == 4 for DXT3, alfred 2008/10/11
+    if (header.attr[1] == 8 || header.attr[1] == 4)
+    {
+      format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+      blocksize = 16;
+    }
 
-    file->seek(offsets[0]);
-    file->read(buf, sizes[0]);
+    // Fix to the BLP2 format required in WoW 2.0 thanks to Linghuye (creator of MyWarCraftStudio)
+    if (header.attr[1] == 8 && header.attr[2] == 7)
+    {
+      format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+      blocksize = 16;
+    }
 
-    QImage image;
+    return format;
+  }
 
-    if (!image.loadFromData(buf, sizes[0], "jpg"))
+  // encoding 1 : paletted mip level to RGBA pixels, returns false if mip data is too small
+  bool decodePaletted(const BLPHeader & header, const unsigned int * pal, const unsigned char * mip, size_t mipSize,
+                      uint width, uint height, unsigned int * dest)
+  {
+    /*
+    Type 1 Encoding 1 AlphaDepth 0 (uncompressed paletted image with no alpha)
+    Each by of the image data is an index into Palette which contains the actual RGB value for the pixel. Although the palette entries are 32-bits, the alpha value of each Palette entry may contain garbage and should be discarded.
+
+    Type 1 Encoding 1 AlphaDepth 1 (uncompressed paletted image with 1-bit alpha)
+    This is the same as Type 1 Encoding 1 AlphaDepth 0 except that immediately following the index array is a second image array containing 1-bit alpha values for each pixel. The first byte of the array is for pixels 0 through 7, the second byte for pixels 8 through 15 and so on. Bit 0 of each byte corresponds to the first pixel (leftmost) in the group, bit 7 to the rightmost. A set bit indicates the pixel is opaque while a zero bit indicates a transparent pixel.
+
+    Type 1 Encoding 1 AlphaDepth 8(uncompressed paletted image with 8-bit alpha)
+    This is the same as Type 1 Encoding 1 AlphaDepth 0 except that immediately following the index array is a second image array containing the actual 8-bit alpha values for each pixel. This second array starts at BLP2Header.Offset[0] + BLP2Header.Width * BLP2Header.Height.
+    */
+    const size_t alphabits = header.attr[1];
+    const size_t nbPixels = (size_t)width * height;
+    if (mipSize < nbPixels + (nbPixels * alphabits + 7) / 8)
+      return false;
+
+    const unsigned char * a = mip + nbPixels;
+    for (size_t i = 0; i < nbPixels; i++)
     {
-      LOG_ERROR << __FUNCTION__ << __LINE__ << "Failed to load texture";
+      uint k = pal[mip[i]];
+      k = ((k & 0x00FF0000) >> 16) | ((k & 0x0000FF00)) | ((k & 0x000000FF) << 16);
+
+      uint alpha = 0xff;
+      if (alphabits == 8)
+        alpha = a[i];
+      else if (alphabits == 4)
+        alpha = ((a[i / 2] >> ((i % 2) * 4)) & 0xf) * 0x11;
+      else if (alphabits == 1)
+        alpha = (a[i / 8] & (1 << (i % 8))) ? 0xff : 0;
+
+      dest[i] = k | (alpha << 24);
     }
 
-    image = image.mirrored();
-    image = image.convertToFormat(QImage::Format_RGBA8888);
+    return true;
+  }
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+void Texture::load()
+{
+  // bind the texture
+  glBindTexture(GL_TEXTURE_2D, id);
 
-    delete buffer;
-    buffer = nullptr;
-    delete [] buf;
-    buf = nullptr;
-  }
-  else if (type == 1) 
+  if (!file || !file->open() || file->isEof()) 
   {
-    if (attr[0] == 2) 
-    {
-      /*
-      Type 1 Encoding 2 AlphaDepth 0 (DXT1 no alpha)
-      The image data is formatted using DXT1 compression with no alpha channel.
-
-      Type 1 Encoding 2 AlphaDepth 1 (DXT1 one bit alpha)
-      The image data is formatted using DXT1 compression with a one-bit alpha channel.
-
-      Type 1 Encoding 2 AlphaDepth 8 (DXT3)
-      The image data is formatted using DXT3 compression.
-
-      Type 1 Encoding 2 AlphaDepth 8 AlphaEncoding 7 (DXT5)
-      The image data are formatted using DXT5 compression.
-      */
-      // encoding 2, directx compressed
-      unsigned char *ucbuf = NULL;
-      if (!video.supportCompression)
-        ucbuf = new unsigned char[width*height * 4];
-
-      format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-      int blocksize = 8;
-
-      // guesswork here :(
-      // new alpha bit depth == 4 for DXT3, alfred 2008/10/11
-      if (attr[1] == 8 || attr[1] == 4) 
-      {
-        format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-        blocksize = 16;
-      }
+    id = 0;
+    return;
+  }
 
-      // Fix to the BLP2 format required in WoW 2.0 thanks to Linghuye (creator of MyWarCraftStudio)
-      if (attr[1] == 8 && attr[2] == 7) 
-      {
-        format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-        blocksize = 16;
-      }
+  const unsigned char * data = file->getBuffer();
+  const size_t size = file->getSize();
 
-      compressed = true;
+  BLPHeader header;
+  if (!readHeader(data, size, header))
+  {
+    LOG_ERROR << __FILE__ << __FUNCTION__ << __LINE__ << "Invalid texture" << file->fullname();
+    file->close();
+    return;
+  }
 
-      unsigned char *buf = new unsigned char[sizes[0]];
+  uint width = header.width, height = header.height;
+  size_t mipmax = (header.attr[3] > 0) ? 16 : 1;
 
-      // do every mipmap level
-      for (size_t i = 0; i<mipmax; i++) 
-      {
-        if (width == 0) width = 1;
-        if (height == 0) height = 1;
-        if (offsets[i] && sizes[i]) 
-        {
-          file->seek(offsets[i]);
-          file->read(buf, sizes[i]);
-
-          int size = ((width + 3) / 4) * ((height + 3) / 4) * blocksize;
-
-          if (video.supportCompression) 
-          {
-            glCompressedTexImage2DARB(GL_TEXTURE_2D, (GLint)i, format, width, height, 0, size, buf);
-          }
-          else 
-          {
-            decompressDXTC(format, width, height, size, buf, ucbuf);
-            glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, ucbuf);
-          }
-
-        }
-        else
-        {
-          break;
-        }
-        width >>= 1;
-        height >>= 1;
-      }
+  w = width;
+  h = height;
 
-      delete [] buf;
-      buf = nullptr;
-      if (!video.supportCompression)
-      {
-        delete ucbuf;
-		ucbuf = nullptr;
-      }
+  if (header.type == 0) // JPEG compression, first level only
+  { 
+    QImage image = decode(QByteArray::fromRawData((const char *)data, (int)size));
 
+    if (image.isNull())
+    {
+      LOG_ERROR << __FUNCTION__ << __LINE__ << "Failed to load texture";
     }
-    else if (attr[0] == 1) 
+    else
     {
-      /*
-      Type 1 Encoding 0 AlphaDepth 0 (uncompressed paletted image with no alpha)
-      Each by of the image data is an index into Palette which contains the actual RGB value for the pixel. Although the palette entries are 32-bits, the alpha value of each Palette entry may contain garbage and should be discarded.
-
-      Type 1 Encoding 1 AlphaDepth 1 (uncompressed paletted image with 1-bit alpha)
-      This is the same as Type 1 Encoding 1 AlphaDepth 0 except that immediately following the index array is a second image array containing 1-bit alpha values for each pixel. The first byte of the array is for pixels 0 through 7, the second byte for pixels 8 through 15 and so on. Bit 0 of each byte corresponds to the first pixel (leftmost) in the group, bit 7 to the rightmost. A set bit indicates the pixel is opaque while a zero bit indicates a transparent pixel.
+      image = image.convertToFormat(QImage::Format_RGBA8888);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+    }
+  }
+  else if (header.type == 1 && header.attr[0] == 2) // directx compressed
+  {
+    int blocksize = 8;
+    GLint format = dxtFormat(header, blocksize);
 
-      Type 1 Encoding 1 AlphaDepth 8(uncompressed paletted image with 8-bit alpha)
-      This is the same as Type 1 Encoding 1 AlphaDepth 0 except that immediately following the index array is a second image array containing the actual 8-bit alpha values for each pixel. This second array starts at BLP2Header.Offset[0] + BLP2Header.Width * BLP2Header.Height.
-      */
+    std::vector<unsigned char> ucbuf;
+    if (!video.supportCompression)
+      ucbuf.resize(width * height * 4);
 
-      // encoding 1, uncompressed
-      unsigned int pal[256];
-      file->read(pal, 1024);
+    compressed = true;
 
-      unsigned char *buf = new unsigned char[sizes[0]];
-      unsigned int *buf2 = new unsigned int[width*height];
-      unsigned int *p = NULL;
-      unsigned char *c = NULL, *a = NULL;
+    // do every mipmap level
+    for (size_t i = 0; i < mipmax && hasMip(header, i, size); i++)
+    {
+      if (width == 0) width = 1;
+      if (height == 0) height = 1;
 
-      int alphabits = attr[1];
-      bool hasalpha = (alphabits != 0);
+      int mipSize = ((width + 3) / 4) * ((height + 3) / 4) * blocksize;
+      if (mipSize > header.sizes[i])
+        break;
 
-      compressed = false;
+      // ddslib and GL only read source data
+      unsigned char * mip = const_cast<unsigned char *>(data + header.offsets[i]);
 
-      for (size_t i = 0; i<mipmax; i++) 
+      if (video.supportCompression) 
       {
-        if (width == 0) width = 1;
-        if (height == 0) height = 1;
-        if (offsets[i] && sizes[i]) 
-        {
-          file->seek(offsets[i]);
-          file->read(buf, sizes[i]);
-
-          int cnt = 0;
-          int alpha = 0;
-
-          p = buf2;
-          c = buf;
-          a = buf + width*height;
-          for (uint y = 0; y<height; y++)
-          {
-            for (uint x = 0; x<width; x++)
-            {
-              uint k = pal[*c++];
-
-              k = ((k & 0x00FF0000) >> 16) | ((k & 0x0000FF00)) | ((k & 0x000000FF) << 16);
-
-              if (hasalpha) 
-              {
-                if (alphabits == 8)
-                {
-                  alpha = (*a++);
-                }
-                else if (alphabits == 4) 
-                {
-                  alpha = (*a & (0xf << cnt++)) * 0x11;
-                  if (cnt == 2) 
-                  {
-                    cnt = 0;
-                    a++;
-                  }
-                }
-                else if (alphabits == 1) 
-                {
-                  //alpha = (*a & (128 >> cnt++)) ? 0xff : 0;
-                  alpha = (*a & (1 << cnt++)) ? 0xff : 0;
-                  if (cnt == 8) 
-                  {
-                    cnt = 0;
-                    a++;
-                  }
-                }
-              }
-              else alpha = 0xff;
-
-              k |= alpha << 24;
-              *p++ = k;
-            }
-          }
-
-          glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, buf2);
-
-        }
-        else break;
-
-        width >>= 1;
-        height >>= 1;
+        glCompressedTexImage2DARB(GL_TEXTURE_2D, (GLint)i, format, width, height, 0, mipSize, mip);
+      }
+      else 
+      {
+        decompressDXTC(format, width, height, mipSize, mip, ucbuf.data());
+        glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, ucbuf.data());
       }
 
-      delete [] buf2;
-      buf2 = nullptr;
-      delete [] buf;
-      buf = nullptr;
+      width >>= 1;
+      height >>= 1;
     }
-    else 
+  }
+  else if (header.type == 1 && header.attr[0] == 1 && size >= BLP_HEADER_SIZE + BLP_PALETTE_SIZE) // uncompressed paletted
+  {
+    unsigned int pal[256];
+    memcpy(pal, data + BLP_HEADER_SIZE, BLP_PALETTE_SIZE);
+
+    std::vector<unsigned int> pixels(width * height);
+
+    compressed = false;
+
+    for (size_t i = 0; i < mipmax && hasMip(header, i, size); i++)
     {
-      LOG_ERROR << __FILE__ << __FUNCTION__ << __LINE__ << "type=" << type << "attr[0]=" << attr[0];
+      if (width == 0) width = 1;
+      if (height == 0) height = 1;
+
+      if (!decodePaletted(header, pal, data + header.offsets[i], header.sizes[i], width, height, pixels.data()))
+        break;
+
+      glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+      width >>= 1;
+      height >>= 1;
     }
   }
+  else 
+  {
+    LOG_ERROR << __FILE__ << __FUNCTION__ << __LINE__ << "type=" << header.type << "attr[0]=" << header.attr[0];
+  }
 
   file->close();
   /*
@@ -294,6 +261,93 @@ void Texture::load()
   //}
 }
 
+QImage Texture::decode(GameFile * file)
+{
+  if (!file || !file->open() || file->isEof())
+    return QImage();
+
+  QByteArray blp((const char *)file->getBuffer(), (int)file->getSize());
+  file->close();
+
+  return decode(blp);
+}
+
+QImage Texture::decode(const QByteArray & blp)
+{
+  const unsigned char * data = (const unsigned char *)blp.constData();
+  const size_t size = blp.size();
+
+  BLPHeader header;
+  if (!readHeader(data, size, header) || !hasMip(header, 0, size))
+    return QImage();
+
+  const uint width = header.width, height = header.height;
+  const unsigned char * mip = data + header.offsets[0];
+
+  if (header.type == 0) // JPEG compression, mip data share a common jpeg header
+  {
+    uint jpegHeaderSize = 0;
+    memcpy(&jpegHeaderSize, data + BLP_HEADER_SIZE, 4);
+    if (BLP_HEADER_SIZE + 4 + jpegHeaderSize > size)
+      return QImage();
+
+    QByteArray jpeg((const char *)data + BLP_HEADER_SIZE + 4, jpegHeaderSize);
+    jpeg.append((const char *)mip, header.sizes[0]);
+
+    QImage image;
+    if (!image.loadFromData(jpeg, "jpg"))
+      return QImage();
+
+    return image.convertToFormat(QImage::Format_ARGB32);
+  }
+
+  if (header.type != 1)
+    return QImage();
+
+  QImage image(width, height, QImage::Format_RGBA8888);
+  if (image.isNull())
+    return QImage();
+
+  if (header.attr[0] == 2) // directx compressed
+  {
+    int blocksize = 8;
+    GLint format = dxtFormat(header, blocksize);
+
+    const size_t mipSize = ((width + 3) / 4) * ((height + 3) / 4) * blocksize;
+    if (mipSize > (size_t)header.sizes[0])
+      return QImage();
+
+    image.fill(0);
+    // ddslib only reads source data
+    decompressDXTC(format, width, height, mipSize, const_cast<unsigned char *>(mip), image.bits());
+  }
+  else if (header.attr[0] == 1) // uncompressed paletted image
+  {
+    if (size < BLP_HEADER_SIZE + BLP_PALETTE_SIZE)
+      return QImage();
+
+    unsigned int pal[256];
+    memcpy(pal, data + BLP_HEADER_SIZE, BLP_PALETTE_SIZE);
+
+    if (!decodePaletted(header, pal, mip, header.sizes[0], width, height, (unsigned int *)image.bits()))
+      return QImage();
+  }
+  else if (header.attr[0] == 3) // uncompressed BGRA
+  {
+    if ((size_t)header.sizes[0] < width * height * 4)
+      return QImage();
+
+    QImage bgra(mip, width, height, QImage::Format_ARGB32);
+    return bgra.copy();
+  }
+  else
+  {
+    return QImage();
+  }
+
+  return image.convertToFormat(QImage::Format_ARGB32);
+}
+
 /*
 struct Color {
 unsigned char r, g, b;
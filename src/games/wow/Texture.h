@@ -1,6 +1,9 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <QByteArray>
+#include <QImage>
+
 #include "manager.h"
 #include "vec3d.h"
 
@@ -29,8 +32,13 @@ public:
 	void getPixels(unsigned char *buff, unsigned int format=GL_RGBA);
   void load();
 
+  // CPU decoding of BLP first mip level, no GL call involved.
+  // Second version only works on given data and can be used from any thread
+  static QImage decode(GameFile * file);
+  static QImage decode(const QByteArray & blp);
+
 private:
-	void decompressDXTC(GLint format, int w, int h, size_t size, unsigned char *src, unsigned char *dest);
+	static void decompressDXTC(GLint format, int w, int h, size_t size, unsigned char *src, unsigned char *dest);
 
 };
 
@@ -0,0 +1,226 @@
+/*
+ * TextureExporter.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#include "TextureExporter.h"
+
+#include <algorithm>
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include "GameFile.h"
+#include "Texture.h"
+#include "TextureManager.h"
+
+#include "logger/Logger.h"
+
+namespace
+{
+  // Qt has no tga writer: uncompressed 32 bits, bottom-up rows
+  QByteArray encodeTGA(const QImage & source)
+  {
+    QImage image = source.convertToFormat(QImage::Format_ARGB32);
+
+    QByteArray result(18, 0);
+    result[2] = 2; // uncompressed true color
+    result[12] = (char)(image.width() & 0xFF);
+    result[13] = (char)((image.width() >> 8) & 0xFF);
+    result[14] = (char)(image.height() & 0xFF);
+    result[15] = (char)((image.height() >> 8) & 0xFF);
+    result[16] = 32;
+    result[17] = 8; // alpha bits
+
+    result.reserve(18 + image.width() * image.height() * 4);
+    for (int y = image.height() - 1; y >= 0; y--)
+      result.append((const char *)image.constScanLine(y), image.width() * 4); // BGRA in memory
+
+    return result;
+  }
+
+  bool encode(const QImage & image, const QString & format, QByteArray & result)
+  {
+    if (format == "tga")
+    {
+      result = encodeTGA(image);
+      return true;
+    }
+
+    QBuffer buffer(&result);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, format.toLatin1());
+    return writer.write(image);
+  }
+
+  class TextureWriteTask : public QRunnable
+  {
+    public:
+      TextureWriteTask(std::shared_ptr<TextureExporter::Job> job, bool * result)
+        : m_job(job), m_result(result)
+      {}
+
+      void run()
+      {
+        *m_result = false;
+
+        QImage image = m_job->blp.isEmpty() ? m_job->image : Texture::decode(m_job->blp);
+        if (image.isNull())
+        {
+          LOG_ERROR << "Unable to decode texture" << m_job->name;
+          return;
+        }
+
+        // one encoding per output format
+        std::map<QString, QByteArray> encoded;
+        bool ok = true;
+        for (auto & file : m_job->files)
+        {
+          QString format = QFileInfo(file).suffix().toLower();
+          auto it = encoded.find(format);
+          if (it == encoded.end())
+          {
+            QByteArray data;
+            if (!encode(image, format, data))
+            {
+              LOG_ERROR << "Unable to encode texture" << m_job->name << "as" << format;
+              ok = false;
+              continue;
+            }
+            it = encoded.insert(std::make_pair(format, data)).first;
+          }
+
+          QFile f(file);
+          if (!f.open(QIODevice::WriteOnly) || f.write(it->second) != it->second.size())
+          {
+            LOG_ERROR << "Unable to write texture" << file;
+            ok = false;
+          }
+        }
+
+        *m_result = ok;
+      }
+
+    private:
+      std::shared_ptr<TextureExporter::Job> m_job;
+      bool * m_result;
+  };
+}
+
+bool TextureExporter::save(const QImage & image, const QString & file)
+{
+  QByteArray data;
+  if (!encode(image, QFileInfo(file).suffix().toLower(), data))
+    return false;
+
+  QFile f(file);
+  return f.open(QIODevice::WriteOnly) && (f.write(data) == data.size());
+}
+
+TextureExporter::Job * TextureExporter::job(const QString & key, const QString & name, const std::wstring & filename)
+{
+  QString file = QString::fromStdWString(filename);
+
+  // same destination file already requested by another texture
+  if (!m_files.insert(file).second)
+    return 0;
+
+  auto it = m_keys.find(key);
+  if (it != m_keys.end())
+  {
+    m_jobs[it->second]->files.push_back(file);
+    return 0;
+  }
+
+  std::shared_ptr<Job> job = std::make_shared<Job>();
+  job->name = name;
+  job->files.push_back(file);
+  m_keys[key] = m_jobs.size();
+  m_jobs.push_back(job);
+
+  return job.get();
+}
+
+void TextureExporter::add(GameFile * file, const std::wstring & filename)
+{
+  if (!file)
+    return;
+
+  QString key = (file->fileDataId() > 0) ? QString("fdid:%1").arg(file->fileDataId()) : "file:" + file->fullname();
+
+  Job * j = job(key, file->fullname(), filename);
+  if (!j)
+    return;
+
+  // only raw file content is read here, decoding is done by workers
+  if (file->open() && !file->isEof())
+    j->blp = QByteArray((const char *)file->getBuffer(), (int)file->getSize());
+  file->close();
+}
+
+void TextureExporter::add(GLuint id, const std::wstring & filename)
+{
+  auto it = TEXTUREMANAGER.items.find(id);
+  if (it != TEXTUREMANAGER.items.end())
+  {
+    Texture * tex = dynamic_cast<Texture *>(it->second);
+    if (tex && tex->file)
+    {
+      add(tex->file, filename);
+      return;
+    }
+  }
+
+  Job * j = job(QString("gl:%1").arg(id), QString("GL texture %1").arg(id), filename);
+  if (!j)
+    return;
+
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, id);
+
+  GLint width = 0, height = 0;
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+  if (width > 0 && height > 0)
+  {
+    j->image = QImage(width, height, QImage::Format_ARGB32);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, j->image.bits());
+  }
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+}
+
+bool TextureExporter::write()
+{
+  LOG_INFO << "Writing" << m_jobs.size() << "textures";
+
+  // std::vector<bool> elements cannot be written concurrently
+  std::unique_ptr<bool[]> results(new bool[m_jobs.size()]);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+
+  for (size_t i = 0; i < m_jobs.size(); i++)
+    pool.start(new TextureWriteTask(m_jobs[i], &results[i]));
+
+  pool.waitForDone();
+
+  bool result = true;
+  for (size_t i = 0; i < m_jobs.size(); i++)
+    result = result && results[i];
+
+  m_keys.clear();
+  m_files.clear();
+  m_jobs.clear();
+
+  return result;
+}
@@ -0,0 +1,72 @@
+/*
+ * TextureExporter.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ */
+
+#ifndef _TEXTUREEXPORTER_H_
+#define _TEXTUREEXPORTER_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+#include "GL/glew.h"
+
+class GameFile;
+
+#ifdef _WIN32
+#    ifdef BUILDING_WOW_DLL
+#        define _TEXTUREEXPORTER_API_ __declspec(dllexport)
+#    else
+#        define _TEXTUREEXPORTER_API_ __declspec(dllimport)
+#    endif
+#else
+#    define _TEXTUREEXPORTER_API_
+#endif
+
+// Writes textures as image files, format being chosen from file extension (png, tga...).
+// Textures are collected on the GL thread: textures loaded from game files only have
+// their BLP data read, other ones (composed character skin...) are read back from GL.
+// Decoding and encoding are done by worker threads in write(), each source texture
+// being decoded and encoded once whatever the number of models / files using it.
+class _TEXTUREEXPORTER_API_ TextureExporter
+{
+  public:
+    TextureExporter() {}
+
+    void add(GLuint id, const std::wstring & filename);
+    void add(GameFile * file, const std::wstring & filename);
+
+    // blocks until all textures are written, returns false if one of them failed
+    bool write();
+
+    size_t size() const { return m_jobs.size(); }
+
+    // encode and write a single image, can be called from any thread
+    static bool save(const QImage & image, const QString & file);
+
+    struct Job
+    {
+      QString name;
+      QByteArray blp;
+      QImage image;
+      std::vector<QString> files;
+    };
+
+  private:
+    Job * job(const QString & key, const QString & name, const std::wstring & filename);
+
+    std::map<QString, size_t> m_keys; // fileDataId / file name / GL id -> job
+    std::set<QString> m_files;
+    std::vector<std::shared_ptr<Job> > m_jobs;
+};
+
+#endif
@@ -48,6 +48,28 @@ GLuint TextureManager::add(GameFile * file)
 }
 //#define SAVE_BLP
 
+void TextureManager::clear(const std::set<GLuint> & keep)
+{
+	for (GLuint i = 0; i < 50; i++) {
+		if (keep.find(i) == keep.end() && items.find(i) != items.end())
+			del(i);
+	}
+
+	for (auto it = names.begin(); it != names.end();) {
+		if (keep.find(it->second) == keep.end())
+			it = names.erase(it);
+		else
+			++it;
+	}
+
+	for (auto it = items.begin(); it != items.end();) {
+		if (keep.find(it->first) == keep.end())
+			it = items.erase(it);
+		else
+			++it;
+	}
+}
+
 void TextureManager::doDelete(GLuint id)
 {
 	if (glIsTexture(id)) {
@@ -1,6 +1,7 @@
 #ifndef TEXTUREMANAGER_H
 #define TEXTUREMANAGER_H
 
+#include <set>
 #include <vector>
 #include "manager.h"
 #include "vec3d.h"
@@ -24,6 +25,9 @@ public:
 	virtual GLuint add(GameFile *);
 	void doDelete(GLuint id);
 
+	// same as Manager::clear, except that textures in keep are left untouched
+	using Manager<GLuint>::clear;
+	void clear(const std::set<GLuint> & keep);
 };
 
 _TEXTUREMANAGER_API_ extern TextureManager TEXTUREMANAGER;
@@ -1,11 +1,14 @@
 #include "WMOGroup.h"
 
 #include "CASCFile.h"
+#include "Frustum.h"
 #include "types.h"
 #include "wmo.h"
 
 
 
+#include "logger/Logger.h"
+
 #include <QString>
 
 /*
@@ -55,6 +58,12 @@ void setGLColor(unsigned int col)
 
 
 void WMOGroup::initDisplayList()
+{
+  if (load())
+    upload();
+}
+
+bool WMOGroup::load()
 {
   vertices = NULL;
   normals = NULL;
@@ -66,8 +75,7 @@ void WMOGroup::initDisplayList()
 
   WMOGroupHeader gh;
 
-  short *useLights = 0;
-  int nLR = 0;
+  lightRefs.clear();
 
   // open group file
   QString temp(wmo->itemName());
@@ -75,7 +83,11 @@ void WMOGroup::initDisplayList()
 
   QString fname = QString("%1_%2.wmo").arg(temp).arg(num, 3, 10, QChar('0'));
   CASCFile gf(fname);
-  gf.open();
+  if (!gf.open() || gf.isEof())
+  {
+    LOG_ERROR << "Couldn't load WMO group" << fname;
+    return false;
+  }
   gf.seek(0x14);
 
   // read header
@@ -92,6 +104,9 @@ void WMOGroup::initDisplayList()
   b1 = Vec3D(gh.box1[0], gh.box1[2], -gh.box1[1]);
   b2 = Vec3D(gh.box2[0], gh.box2[2], -gh.box2[1]);
 
+  portalStart = gh.portalStart;
+  portalCount = gh.portalCount;
+
   gf.seek(0x58); // first chunk
 
   uint32 size;
@@ -196,17 +211,16 @@ void WMOGroup::initDisplayList()
       //			Light references, one 16-bit integer per light reference.
       //			This is basically a list of lights used in this WMO group, the numbers are indices into the WMO root file's MOLT table.
       //			For some WMO groups there is a large number of lights specified here, more than what a typical video card will handle at once. I wonder how they do lighting properly. Currently, I just turn on the first GL_MAX_LIGHTS and hope for the best. :(
-      nLR = (int)size / 2;
-      useLights = (short*)gf.getPointer();
+      short * useLights = (short*)gf.getPointer();
+      lightRefs.assign(useLights, useLights + size / 2);
     }
     else if (fourcc == "MODR") {
       //			Doodad references, one 16-bit integer per doodad.
       //			The numbers are indices into the doodad instance table (MODD chunk) of the WMO root file. These have to be filtered to the doodad set being used in any given WMO instance.
-      /*
       nDoodads = (int)(size/2);
+      delete[] ddr;
       ddr = new short[nDoodads];
       gf.read(ddr,size);
-      */
     }
     else if (fourcc == "MOBN") {
       //			Array of t_BSP_NODE.
@@ -319,12 +333,36 @@ void WMOGroup::initDisplayList()
     gf.seek(nextpos);
   }
 
+  gf.close();
+
+  IndiceToVerts = new uint32[nIndices];
+
+  for (size_t b = 0; b<nBatches; b++) {
+    WMOBatch *batch = &batches[b];
+
+    // build indice to vert array.
+    for (size_t i = 0; i < batch->indexCount; i++){
+      size_t a = indices[batch->indexStart + i];
+      for (size_t j = batch->vertexStart; j <= batch->vertexEnd; j++){
+        if (vertices[a] == vertices[j]){
+          IndiceToVerts[batch->indexStart + i] = j;
+          break;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void WMOGroup::upload()
+{
   // ok, make a display list
 
   indoor = (flags & 8192) != 0;
   //gLog("Lighting: %s %X\n\n", indoor?"Indoor":"Outdoor", flags);
 
-  initLighting(nLR, useLights);
+  initLighting((int)lightRefs.size(), lightRefs.empty() ? 0 : &lightRefs[0]);
 
   dl = glGenLists(1);
   glNewList(dl, GL_COMPILE);
@@ -340,23 +378,10 @@ void WMOGroup::initDisplayList()
 
   // assume that texturing is on, for unit 1
 
-  IndiceToVerts = new uint32[nIndices];
-
   for (size_t b = 0; b<nBatches; b++) {
     WMOBatch *batch = &batches[b];
     WMOMaterial *mat = &wmo->mat[batch->texture];
 
-    // build indice to vert array.
-    for (size_t i = 0; i <= batch->indexCount; i++){
-      size_t a = indices[batch->indexStart + i];
-      for (size_t j = batch->vertexStart; j <= batch->vertexEnd; j++){
-        if (vertices[a] == vertices[j]){
-          IndiceToVerts[batch->indexStart + i] = j;
-          break;
-        }
-      }
-    }
-
     // setup texture
     glBindTexture(GL_TEXTURE_2D, mat->tex);
 
@@ -416,8 +441,6 @@ void WMOGroup::initDisplayList()
 
   glEndList();
 
-  gf.close();
-
   // hmm
   indoor = false;
 
@@ -462,12 +485,8 @@ void WMOGroup::initLighting(int nLR, short *useLights)
 
 void WMOGroup::draw()
 {
-  if (!ok) {
-    visible = false;
+  if (!ok || !visible)
     return;
-  }
-
-  visible = true;
 
   if (hascv) {
     glDisable(GL_LIGHTING);
@@ -481,56 +500,34 @@ void WMOGroup::draw()
   }
 }
 
-void WMOGroup::drawDoodads(int doodadset)
+void WMOGroup::collectDoodads(int doodadset, const Frustum & frustum, WMODoodadBatches & batches)
 {
   if (!visible) return;
   if (nDoodads == 0) return;
   if (doodadset<0) return;
 
-  //setupFog();
-
-  /*
-  float xr=0,xg=0,xb=0;
-  if (flags & 0x0040) xr = 1;
-  //if (flags & 0x0008) xg = 1;
-  if (flags & 0x8000) xb = 1;
-  glColor4f(xr,xg,xb,1);
-  */
-
-  // draw doodads
-  glColor4f(1, 1, 1, 1);
   for (size_t i = 0; i<nDoodads; i++) {
     short dd = ddr[i];
 
-    bool inSet;
-    if (doodadset == -1) {
-      inSet = false;
-    }
-    else {
-      inSet = (((dd >= wmo->doodadsets[doodadset].start) && (dd < (wmo->doodadsets[doodadset].start + (int)wmo->doodadsets[doodadset].size)))
-               || (wmo->includeDefaultDoodads && (dd >= wmo->doodadsets[0].start) && ((dd < (wmo->doodadsets[0].start + (int)wmo->doodadsets[0].size)))));
-    }
-
-    if (inSet) {
-
-      WMOModelInstance &mi = wmo->modelis[dd];
+    if (dd < 0 || (size_t)dd >= wmo->modelis.size())
+      continue;
 
-      if (!outdoorLights) {
-        glDisable(GL_LIGHT0);
-        WMOLight::setupOnce(GL_LIGHT2, mi.ldir, mi.lcol);
-      }
-      else {
-        glEnable(GL_LIGHT0);
-      }
+    bool inSet = (((dd >= wmo->doodadsets[doodadset].start) && (dd < (wmo->doodadsets[doodadset].start + (int)wmo->doodadsets[doodadset].size)))
+                  || (wmo->includeDefaultDoodads && (dd >= wmo->doodadsets[0].start) && ((dd < (wmo->doodadsets[0].start + (int)wmo->doodadsets[0].size)))));
 
-      wmo->modelis[dd].draw();
-    }
-  }
+    if (!inSet)
+      continue;
 
-  glDisable(GL_LIGHT2);
+    WMOModelInstance &mi = wmo->modelis[dd];
 
-  glColor4f(1, 1, 1, 1);
+    if (!mi.model || !frustum.intersects(mi.pos, mi.model->rad * mi.sc))
+      continue;
 
+    WMODoodadRef ref;
+    ref.instance = &mi;
+    ref.outdoorLights = outdoorLights;
+    batches[mi.model].push_back(ref);
+  }
 }
 
 void WMOGroup::drawLiquid()
@@ -577,14 +574,14 @@ void WMOGroup::setupFog()
 WMOGroup::WMOGroup() :
 dl(0), ddr(0), vertices(NULL), normals(NULL), texcoords(NULL),
 indices(NULL), materials(NULL), nTriangles(0), nVertices(0),
-nIndices(0), nBatches(0)
+nIndices(0), nBatches(0), portalStart(0), portalCount(0)
 {
 }
 
 WMOGroup::~WMOGroup()
 {
   cleanup();
-  delete ddr;
+  delete[] ddr;
 }
 
 void WMOGroup::cleanup()
@@ -631,7 +628,7 @@ void WMOGroup::updateModels(bool load)
       WMOModelInstance &mi = wmo->modelis[dd];
 
       if (load && !mi.model)
-        mi.loadModel(wmo->loadedModels);
+        wmo->requestModel(dd);
       else if (!load && mi.model)
         mi.unloadModel(wmo->loadedModels);
     }
@@ -680,4 +677,6 @@ void WMOGroup::init(WMO *wmo, GameFile &f, int num, char *names)
 
   ok = false;
   visible = false;
+  portalStart = 0;
+  portalCount = 0;
 }
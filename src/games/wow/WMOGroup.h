@@ -1,11 +1,15 @@
 #ifndef _WMO_GROUP_H_
 #define _WMO_GROUP_H_
 
+#include <vector>
+
 #include "types.h"
 #include "vec3d.h"
+#include "WMOModelInstance.h"
 
 typedef unsigned int GLuint;
 
+class Frustum;
 class GameFile;
 class WMO;
 
@@ -51,14 +55,27 @@ class WMOGroup
   bool outdoorLights;
   std::wstring name, desc;
 
+  // light references (MOLR chunk), indices in WMO::lights
+  std::vector<short> lightRefs;
+
+  // range of this group's portal references in WMO::prs (MOPR chunk)
+  short portalStart, portalCount;
+
+  bool isIndoor() const { return (flags & 0x2000) != 0; }
+  bool isOutdoor() const { return (flags & 0x8) != 0; }
+
   WMOGroup();
   ~WMOGroup();
   void init(WMO *wmo, GameFile &f, int num, char *names);
   void initDisplayList();
+  // initDisplayList is split in two steps, to allow group file parsing out of GL thread
+  bool load();   // read group file into CPU buffers, doesn't use GL
+  void upload(); // build display list from loaded buffers, GL thread only
   void initLighting(int nLR, short *useLights);
   void draw();
   void drawLiquid();
-  void drawDoodads(int doodadset);
+  // add doodads of given set in view to per model batches
+  void collectDoodads(int doodadset, const Frustum & frustum, WMODoodadBatches & batches);
   void setupFog();
   void cleanup();
 
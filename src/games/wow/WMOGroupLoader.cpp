@@ -0,0 +1,107 @@
+#include "WMOGroupLoader.h"
+
+#include "animated.h" // fixCoordSystem
+#include "wmo.h"
+#include "WMOGroup.h"
+
+#include <algorithm>
+
+#include <QThread>
+
+WMOGroupLoader::WMOGroupLoader(WMO * wmo)
+  : m_wmo(wmo), m_nbInProgress(0), m_cancelled(false)
+{
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+WMOGroupLoader::~WMOGroupLoader()
+{
+  cancel();
+}
+
+void WMOGroupLoader::start()
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = false;
+    for (uint32 i = 0; i < m_wmo->nGroups; i++)
+      m_pending.push_back(i);
+  }
+
+  for (int i = 0; i < m_pool.maxThreadCount(); i++)
+    m_pool.start(new Worker(this));
+}
+
+void WMOGroupLoader::cancel()
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = true;
+    m_pending.clear();
+  }
+  m_pool.waitForDone();
+}
+
+void WMOGroupLoader::waitForDone()
+{
+  m_pool.waitForDone();
+}
+
+void WMOGroupLoader::setFocus(const Vec3D & pos)
+{
+  QMutexLocker locker(&m_mutex);
+  m_focus = pos;
+}
+
+void WMOGroupLoader::takeLoadedGroups(std::vector<uint32> & result)
+{
+  QMutexLocker locker(&m_mutex);
+  result.insert(result.end(), m_loaded.begin(), m_loaded.end());
+  m_loaded.clear();
+}
+
+bool WMOGroupLoader::isDone() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_pending.empty() && m_loaded.empty() && m_nbInProgress == 0;
+}
+
+bool WMOGroupLoader::loadNext()
+{
+  uint32 id;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_cancelled || m_pending.empty())
+      return false;
+
+    // pick group closest to focus, based on root file (MOGI) bounding boxes
+    size_t best = 0;
+    float bestDist = -1.0f;
+    for (size_t i = 0; i < m_pending.size(); i++)
+    {
+      WMOGroup & g = m_wmo->groups[m_pending[i]];
+      Vec3D center = (fixCoordSystem(g.v1) + fixCoordSystem(g.v2)) * 0.5f;
+      float dist = (center - m_focus).lengthSquared();
+      if (bestDist < 0.0f || dist < bestDist)
+      {
+        best = i;
+        bestDist = dist;
+      }
+    }
+
+    id = m_pending[best];
+    m_pending[best] = m_pending.back();
+    m_pending.pop_back();
+    m_nbInProgress++;
+  }
+
+  bool ok = m_wmo->groups[id].load();
+
+  QMutexLocker locker(&m_mutex);
+  m_nbInProgress--;
+  if (ok)
+    m_loaded.push_back(id);
+
+  return !m_cancelled;
+}
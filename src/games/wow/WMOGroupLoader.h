@@ -0,0 +1,61 @@
+#ifndef _WMO_GROUP_LOADER_H_
+#define _WMO_GROUP_LOADER_H_
+
+#include <vector>
+
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "types.h"
+#include "vec3d.h"
+
+class WMO;
+
+// Parses WMO group files on worker threads.
+// Workers always pick the pending group closest to focus point (usually camera position),
+// parsed groups are then retrieved from GL thread to be uploaded (see WMOGroup::upload)
+class WMOGroupLoader
+{
+  public:
+    explicit WMOGroupLoader(WMO * wmo);
+    ~WMOGroupLoader();
+
+    void start();
+    // stop pending work and wait for groups currently parsed
+    void cancel();
+    // wait for all groups to be parsed
+    void waitForDone();
+
+    void setFocus(const Vec3D & pos);
+
+    // append parsed groups ids to result, and forget them
+    void takeLoadedGroups(std::vector<uint32> & result);
+
+    bool isDone() const;
+
+  private:
+    class Worker : public QRunnable
+    {
+      public:
+        explicit Worker(WMOGroupLoader * loader) : m_loader(loader) {}
+        void run() { while (m_loader->loadNext()); }
+
+      private:
+        WMOGroupLoader * m_loader;
+    };
+
+    bool loadNext();
+
+    WMO * m_wmo;
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+
+    std::vector<uint32> m_pending;
+    std::vector<uint32> m_loaded;
+    size_t m_nbInProgress;
+    Vec3D m_focus;
+    bool m_cancelled;
+};
+
+#endif
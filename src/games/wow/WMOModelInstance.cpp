@@ -7,6 +7,8 @@
 #include "quaternion.h"
 #include "WoWModel.h"
 
+#include "logger/Logger.h"
+
 #include "GL/glew.h"
 
 void WMOModelInstance::init(char *fname, GameFile &f)
@@ -17,6 +19,7 @@ void WMOModelInstance::init(char *fname, GameFile &f)
   filename.replace(".mdl", ".m2");
 
   model = 0;
+  hasTransform = false;
 
   float ff[3];
   f.read(ff, 12); // Position (X,Z,-Y)
@@ -37,29 +40,51 @@ void glQuaternionRotate(const Vec3D& vdir, float w)
   glMultMatrixf(m);
 }
 
+void WMOModelInstance::setupTransform()
+{
+  if (!hasTransform)
+  {
+    glPushMatrix();
+    glLoadIdentity();
+    glTranslatef(pos.x, pos.y, pos.z);
+    Vec3D vdir(-dir.z, dir.x, dir.y);
+    glQuaternionRotate(vdir, w);
+    glScalef(sc, -sc, -sc);
+    glGetFloatv(GL_MODELVIEW_MATRIX, transform);
+    glPopMatrix();
+    hasTransform = true;
+  }
+
+  glMultMatrixf(transform);
+}
+
 void WMOModelInstance::draw()
 {
   if (!model) return;
 
   glPushMatrix();
-
-  glTranslatef(pos.x, pos.y, pos.z);
-  Vec3D vdir(-dir.z, dir.x, dir.y);
-  glQuaternionRotate(vdir, w);
-  glScalef(sc, -sc, -sc);
-
+  setupTransform();
   model->draw();
   glPopMatrix();
 }
 
 void WMOModelInstance::loadModel(ModelManager &mm)
 {
-  model = (WoWModel*)mm.items[mm.add(GAMEDIRECTORY.getFile(filename))];
+  GameFile * file = GAMEDIRECTORY.getFile(filename);
+  if (!file)
+  {
+    LOG_ERROR << "Unable to find doodad model" << filename;
+    return;
+  }
+
+  model = (WoWModel*)mm.items[mm.add(file)];
   model->isWMO = true;
 }
 
 void WMOModelInstance::unloadModel(ModelManager &mm)
 {
-  mm.delbyname(filename);
+  // managers key models by file name, not by path
+  if (model)
+    mm.delbyname(model->itemName());
   model = 0;
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "vec3d.h"
 
+#include <map>
+#include <vector>
+
 #include <QString>
 
 class GameFile;
@@ -26,12 +29,27 @@ class WMOModelInstance {
   Vec3D ldir;
   Vec3D lcol;
 
-  WMOModelInstance() {}
+  WMOModelInstance() : model(0), hasTransform(false) {}
   void init(char *fname, GameFile &f);
   void draw();
 
+  // multiply current GL matrix by placement transform (computed once, placement is static)
+  void setupTransform();
+
   void loadModel(ModelManager &mm);
   void unloadModel(ModelManager &mm);
+
+  private:
+  float transform[16];
+  bool hasTransform;
 };
 
+// visible doodad placement, gathered per model to draw all placements in one batch
+struct WMODoodadRef {
+  WMOModelInstance * instance;
+  bool outdoorLights;
+};
+
+typedef std::map<WoWModel *, std::vector<WMODoodadRef> > WMODoodadBatches;
+
 #endif
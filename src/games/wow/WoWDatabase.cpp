@@ -8,6 +8,8 @@
 #include "WoWDatabase.h"
 
 #include <QDomNamedNodeMap>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "Game.h"
 #include "logger/Logger.h"
@@ -80,6 +82,10 @@ DBFile * wow::TableStructure::createDBFile()
   if (result != 0)
     return result;
 
+  // game file object is shared, tables can be read by several threads (see GameDatabase::readTable)
+  static QMutex mutex;
+  QMutexLocker locker(&mutex);
+
   GameFile * fileToOpen = 0;
   // loop over possible extension to check if file exists
   for (unsigned int i = 0; i < POSSIBLE_DB_EXT.size(); i++)
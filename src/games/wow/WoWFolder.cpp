@@ -124,6 +124,7 @@ GameFile * wow::WoWFolder::getFile(int id)
   if (id <= 0) // bad id given
     return result;
 
+  QMutexLocker locker(&m_mutex);
   auto it = m_idMap.find(id);
   if (it != m_idMap.end())
     result = it->second;
@@ -190,12 +191,14 @@ int wow::WoWFolder::lastError()
 void wow::WoWFolder::onChildAdded(GameFile * child)
 {
   GameFolder::onChildAdded(child);
+  QMutexLocker locker(&m_mutex);
   m_idMap[child->fileDataId()] = child;
 }
 
 void wow::WoWFolder::onChildRemoved(GameFile * child)
 {
   GameFolder::onChildRemoved(child);
+  QMutexLocker locker(&m_mutex);
   m_idMap.erase(child->fileDataId());
 }
 
@@ -84,34 +84,11 @@ void WoWItem::setId(int id)
 
     if (itemlevels.valid && !itemlevels.values.empty())
     {
-      m_nbLevels = 0;
-      m_level = 0;
-      m_levelDisplayMap.clear();
+      std::vector<int> appearances;
       for (unsigned int i = 0; i < itemlevels.values.size(); i++)
-      {
-        int curid = itemlevels.values[i][1].toInt();
-
-        // if display id is null (case when item's look doesn't change with level)
-        if (curid == 0)
-          continue;
-
-        //check if display id already in the map (do not duplicate when look is the same)
-        bool found = false;
-        for (std::map<int, int>::iterator it = m_levelDisplayMap.begin(); it != m_levelDisplayMap.end(); ++it)
-        {
-          if (it->second == curid)
-          {
-            found = true;
-            break;
-          }
-        }
+        appearances.push_back(itemlevels.values[i][1].toInt());
 
-        if (!found)
-        {
-          m_levelDisplayMap[m_nbLevels] = curid;
-          m_nbLevels++;
-        }
-      }
+      setLevels(appearances);
     }
 
     query = QString("SELECT ItemDisplayInfoID FROM ItemAppearance WHERE ID = %1")
@@ -164,6 +141,38 @@ void WoWItem::setLevel(int level)
 }
 
 
+void WoWItem::setLevels(const std::vector<int> & appearances)
+{
+  m_nbLevels = 0;
+  m_level = 0;
+  m_levelDisplayMap.clear();
+  for (unsigned int i = 0; i < appearances.size(); i++)
+  {
+    int curid = appearances[i];
+
+    // if display id is null (case when item's look doesn't change with level)
+    if (curid == 0)
+      continue;
+
+    //check if display id already in the map (do not duplicate when look is the same)
+    bool found = false;
+    for (std::map<int, int>::iterator it = m_levelDisplayMap.begin(); it != m_levelDisplayMap.end(); ++it)
+    {
+      if (it->second == curid)
+      {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+    {
+      m_levelDisplayMap[m_nbLevels] = curid;
+      m_nbLevels++;
+    }
+  }
+}
+
 void WoWItem::onParentSet(Component * parent)
 {
   m_charModel = dynamic_cast<WoWModel *>(parent);
@@ -201,7 +210,7 @@ void WoWItem::unload()
   // unload any merged model
   if (m_mergedModel != 0)
   {
-    // TODO : unmerge trigs refreshMerging that trigs refresh... so m_mergedModel must be null...
+    // TODO : unmerge trigs refresh... so m_mergedModel must be null...
     // need to find a better way to solve this
     WoWModel * m = m_mergedModel;
     m_mergedModel = 0;
@@ -220,6 +229,25 @@ void WoWItem::load()
   if (m_id == 0 || m_displayId == 0) // no equipment, just return
     return;
 
+  DisplayInfos infos;
+  if (!queryDisplayInfos(infos))
+    return;
+
+  apply(infos);
+}
+
+WoWItem::DisplayInfos::DisplayInfos()
+  : leftShoulderIndex(0)
+{
+  for (size_t i = 0; i < 6; i++)
+    geosetGroup[i] = 0;
+
+  model[0] = model[1] = 0;
+  texture[0] = texture[1] = 0;
+}
+
+bool WoWItem::queryDisplayInfos(DisplayInfos & infos)
+{
   RaceInfos charInfos;
   RaceInfos::getCurrent(m_charModel, charInfos);
   sqlResult iteminfos;
@@ -228,17 +256,22 @@ void WoWItem::load()
   if (!queryItemInfo(QString("SELECT GeoSetGroup1, GeoSetGroup2, GeoSetGroup3, GeoSetGroup4, GeoSetGroup5, GeoSetGroup6 "
                              "FROM ItemDisplayInfo WHERE ItemDisplayInfo.ID = %1").arg(m_displayId), 
                      iteminfos))
-    return;
+    return false;
 
-  int geosetGroup[6] = { iteminfos.values[0][0].toInt(), iteminfos.values[0][1].toInt() ,
-                         iteminfos.values[0][2].toInt(), iteminfos.values[0][3].toInt() ,
-                         iteminfos.values[0][5].toInt(), iteminfos.values[0][5].toInt()};
+  infos.geosetGroup[0] = iteminfos.values[0][0].toInt();
+  infos.geosetGroup[1] = iteminfos.values[0][1].toInt();
+  infos.geosetGroup[2] = iteminfos.values[0][2].toInt();
+  infos.geosetGroup[3] = iteminfos.values[0][3].toInt();
+  infos.geosetGroup[4] = iteminfos.values[0][5].toInt();
+  infos.geosetGroup[5] = iteminfos.values[0][5].toInt();
 
   // query models
-  int model[2] = { getCustomModelId(0), getCustomModelId(1) };
+  infos.model[0] = getCustomModelId(0);
+  infos.model[1] = getCustomModelId(1);
 
   // query textures
-  int texture[2] = { getCustomTextureId(0), getCustomTextureId(1) };
+  infos.texture[0] = getCustomTextureId(0);
+  infos.texture[1] = getCustomTextureId(1);
 
   // query textures from ItemDisplayInfoMaterialRes (if relevant)
   sqlResult texinfos = GAMEDATABASE.sqlQuery(QString("SELECT * FROM ItemDisplayInfoMaterialRes WHERE ItemDisplayInfoID = %1").arg(m_displayId));
@@ -252,14 +285,51 @@ void WoWItem::load()
                       iteminfos))
     {
       for (uint i = 0; i < iteminfos.values.size(); i++)
-      {
-        GameFile * tex = GAMEDIRECTORY.getFile(iteminfos.values[i][0].toInt());
-        if (tex)
-        {
-          TEXTUREMANAGER.add(tex);
-          m_itemTextures[getRegionForTexture(tex)] = tex;
-        }
-      }
+        infos.materialTextures.push_back(iteminfos.values[i][0].toInt());
+    }
+  }
+
+  if (m_slot == CS_SHOULDER)
+  {
+    // find position index value from ComponentModelFileData table
+    QString query = QString("SELECT ID, PositionIndex FROM ComponentModelFileData "
+                            "WHERE ID IN (%1,%2)").arg(infos.model[0]).arg(infos.model[1]);
+    sqlResult result = GAMEDATABASE.sqlQuery(query);
+
+    if (result.valid && result.values.size() > 0)
+    {
+      int modelid = result.values[0][0].toInt();
+      int position = result.values[0][1].toInt();
+
+      // first model is left one if it is at position 0, or if the other one is not
+      if (modelid == infos.model[0])
+        infos.leftShoulderIndex = (position == 0) ? 0 : 1;
+      else
+        infos.leftShoulderIndex = (position == 0) ? 1 : 0;
+    }
+    else
+    {
+      LOG_ERROR << "Impossible to query information for item" << name() << "(id " << m_id << "- display id" << m_displayId << ") - SQL ERROR";
+      LOG_ERROR << query;
+    }
+  }
+
+  return true;
+}
+
+void WoWItem::apply(const DisplayInfos & infos)
+{
+  const int * geosetGroup = infos.geosetGroup;
+  const int * model = infos.model;
+  const int * texture = infos.texture;
+
+  for (uint i = 0; i < infos.materialTextures.size(); i++)
+  {
+    GameFile * tex = GAMEDIRECTORY.getFile(infos.materialTextures[i]);
+    if (tex)
+    {
+      TEXTUREMANAGER.add(tex);
+      m_itemTextures[getRegionForTexture(tex)] = tex;
     }
   }
 
@@ -282,50 +352,8 @@ void WoWItem::load()
       // Shoulder: {geosetGroup[0] = 2601}
       m_itemGeosets[CG_GEOSET2600] = 1 + geosetGroup[0];
 
-      // find position index value from ComponentModelFileData table
-      QString query = QString("SELECT ID, PositionIndex FROM ComponentModelFileData "
-                              "WHERE ID IN (%1,%2)").arg(model[0]).arg(model[1]);
-      sqlResult result = GAMEDATABASE.sqlQuery(query);
-      
-      int leftIndex = 0;
-      int rightIndex = 1;
-      if (result.valid && result.values.size() > 0)
-      {
-        int modelid = result.values[0][0].toInt();
-        int position = result.values[0][1].toInt();
-        
-        if (modelid == model[0])
-        {
-          if (position == 0)
-          {
-            leftIndex = 0;
-            rightIndex = 1;
-          }
-          else
-          {
-            leftIndex = 1;
-            rightIndex = 0;
-          }
-        }
-        else
-        {
-          if (position == 0)
-          {
-            leftIndex = 1;
-            rightIndex = 0;
-          }
-          else
-          {
-            leftIndex = 0;
-            rightIndex = 1;
-          }
-        }
-      }
-      else
-      {
-        LOG_ERROR << "Impossible to query information for item" << name() << "(id " << m_id << "- display id" << m_displayId << ") - SQL ERROR";
-        LOG_ERROR << query;
-      }
+      int leftIndex = infos.leftShoulderIndex;
+      int rightIndex = 1 - leftIndex;
 
       LOG_INFO << "leftIndex" << leftIndex << "rightIndex" << rightIndex;
 
@@ -80,8 +80,27 @@ class _WOWITEM_API_ WoWItem : public Component
     void load(QString &);
 
   private:
+    friend class OutfitLoader;
+
+    // everything needed to build item look, as read from database
+    struct DisplayInfos
+    {
+      DisplayInfos();
+
+      int geosetGroup[6];
+      int model[2];
+      int texture[2];
+      int leftShoulderIndex; // index in model / texture of left shoulder, the other is right one
+      std::vector<int> materialTextures; // from ItemDisplayInfoMaterialRes
+    };
+
     void unload();
 
+    void setLevels(const std::vector<int> & appearances);
+
+    bool queryDisplayInfos(DisplayInfos & infos);
+    void apply(const DisplayInfos & infos);
+
     bool isCustomizableTabard() const;
 
     WoWModel * m_charModel;
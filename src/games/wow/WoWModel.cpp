@@ -7,6 +7,7 @@
 #include "GlobalSettings.h"
 #include "CASCFile.h"
 #include "Game.h"
+#include "ModelCache.h"
 #include "ModelColor.h"
 #include "ModelEvent.h"
 #include "ModelLight.h"
@@ -131,6 +132,14 @@ gamefile(file)
   isWMO = false;
   isMount = false;
 
+  animcalc = false;
+  refreshLocks = 0;
+  refreshPending = false;
+  anim = animtime = animGlobalTime = 0;
+  animSecondaryId = animMouthId = -1;
+  animSecondaryFrame = animMouthFrame = 0;
+  animCloseLHand = animCloseRHand = false;
+
   showModel = false;
   showBones = false;
   showBounds = false;
@@ -160,7 +169,15 @@ gamefile(file)
   rawPasses.clear();
   rawGeosets.clear();
 
+  // model, skeleton and .skin files and geometry resolved from them are read from baked
+  // cache if enabled, and baked once model is built otherwise
+  ModelCache::Scope cache(file);
+  cachedGeometry = cache.geometry();
   initCommon(file);
+  cachedGeometry = 0;
+
+  if (ok)
+    cache.store(rawVertices, rawIndices, rawGeosets);
 }
 
 WoWModel::~WoWModel()
@@ -542,16 +559,24 @@ void WoWModel::initCommon(GameFile * f)
   showModel = true;
   alpha = 1.0f;
 
-  ModelVertex * buffer = new ModelVertex[header.nVertices];
-  memcpy(buffer, f->getBuffer() + header.ofsVertices, sizeof(ModelVertex)*header.nVertices);
-  rawVertices.assign(buffer, buffer + header.nVertices);
-  delete[] buffer;
-
-  // Correct the data from the model, so that its using the Y-Up axis mode.
-  for (auto & it : rawVertices)
+  if (cachedGeometry && cachedGeometry->nbVertices == header.nVertices)
   {
-     it.pos = fixCoordSystem(it.pos);
-     it.normal = fixCoordSystem(it.normal);
+    // already in Y-Up axis mode
+    rawVertices.assign(cachedGeometry->vertices, cachedGeometry->vertices + cachedGeometry->nbVertices);
+  }
+  else
+  {
+    ModelVertex * buffer = new ModelVertex[header.nVertices];
+    memcpy(buffer, f->getBuffer() + header.ofsVertices, sizeof(ModelVertex)*header.nVertices);
+    rawVertices.assign(buffer, buffer + header.nVertices);
+    delete[] buffer;
+
+    // Correct the data from the model, so that its using the Y-Up axis mode.
+    for (auto & it : rawVertices)
+    {
+       it.pos = fixCoordSystem(it.pos);
+       it.normal = fixCoordSystem(it.normal);
+    }
   }
 
   origVertices = rawVertices;
@@ -868,9 +893,9 @@ void WoWModel::readAnimsFromFile(GameFile * f, vector<AFID> & afids, modelAnimDa
       anim = GAMEDIRECTORY.getFile(tempname);
     }
 
-    if (anim && anim->open())
+    // file is only read when animation is used, see loadAnimation
+    if (anim)
     {
-      anim->setChunk("AFSB"); // try to set chunk if it exist, no effect if there is no AFSB chunk present
       {     
         auto animIt = data.animfiles.find(anims[i].animID);
         if (animIt != data.animfiles.end())
@@ -1026,12 +1051,8 @@ void WoWModel::initAnimated(GameFile * f)
     }
   }
 
-  // free MPQFile
-  for (auto it : data.animfiles)
-  {
-    if (it.second.first != 0)
-      it.second.first->close();
-  }
+  for (auto & it : data.animfiles)
+    animFiles[it.first] = it.second.first;
 
   const size_t size = (origVertices.size() * sizeof(float));
   vbufsize = (3 * size); // we multiple by 3 for the x, y, z positions of the vertex
@@ -1222,15 +1243,26 @@ void WoWModel::setLOD(GameFile * f, int index)
     return;
   }
 
-  // Indices,  Triangles
-  uint16 *indexLookup = (uint16*)(g->getBuffer() + view->ofsIndex);
-  uint16 *triangles = (uint16*)(g->getBuffer() + view->ofsTris);
-  rawIndices.clear();
-  rawIndices.resize(view->nTris);
+  // indices and geosets of first view are read from model cache, if any
+  const bool useCache = cachedGeometry && (index == 0) &&
+                        (cachedGeometry->nbIndices == view->nTris) && (cachedGeometry->nbGeosets == view->nSub);
 
-  for (size_t i = 0; i < view->nTris; i++)
+  // Indices,  Triangles
+  if (useCache)
   {
-    rawIndices[i] = indexLookup[triangles[i]];
+    rawIndices.assign(cachedGeometry->indices, cachedGeometry->indices + cachedGeometry->nbIndices);
+  }
+  else
+  {
+    uint16 *indexLookup = (uint16*)(g->getBuffer() + view->ofsIndex);
+    uint16 *triangles = (uint16*)(g->getBuffer() + view->ofsTris);
+    rawIndices.clear();
+    rawIndices.resize(view->nTris);
+
+    for (size_t i = 0; i < view->nTris; i++)
+    {
+      rawIndices[i] = indexLookup[triangles[i]];
+    }
   }
 
   indices = rawIndices;
@@ -1243,14 +1275,22 @@ void WoWModel::setLOD(GameFile * f, int index)
   uint16 *texanimlookup = (uint16*)(f->getBuffer() + header.ofsTexAnimLookup);
   int16 *texunitlookup = (int16*)(f->getBuffer() + header.ofsTexUnitLookup);
 
-  uint32 istart = 0;
-  for (size_t i = 0; i < view->nSub; i++)
+  if (useCache)
   {
-    ModelGeosetHD * hdgeo = new ModelGeosetHD(ops[i]);
-    hdgeo->istart = istart;
-    istart += hdgeo->icount;
-    hdgeo->display = (hdgeo->id == 0);
-    rawGeosets.push_back(hdgeo);
+    for (size_t i = 0; i < cachedGeometry->nbGeosets; i++)
+      rawGeosets.push_back(new ModelGeosetHD(cachedGeometry->geosets[i]));
+  }
+  else
+  {
+    uint32 istart = 0;
+    for (size_t i = 0; i < view->nSub; i++)
+    {
+      ModelGeosetHD * hdgeo = new ModelGeosetHD(ops[i]);
+      hdgeo->istart = istart;
+      istart += hdgeo->icount;
+      hdgeo->display = (hdgeo->id == 0);
+      rawGeosets.push_back(hdgeo);
+    }
   }
 
   restoreRawGeosets();
@@ -1338,8 +1378,68 @@ bool WoWModel::sortPasses(ModelRenderPass* mrp1, ModelRenderPass* mrp2)
   return mrp1->blendmode < mrp2->blendmode;
 }
 
+void WoWModel::loadAnimation(ssize_t anim)
+{
+  if (anim < 0 || (size_t)anim >= anims.size())
+    return;
+
+  auto loaded = std::find(loadedAnims.begin(), loadedAnims.end(), anim);
+  if (loaded != loadedAnims.end())
+  {
+    loadedAnims.splice(loadedAnims.begin(), loadedAnims, loaded);
+    return;
+  }
+
+  auto it = animFiles.find(anims[anim].animID);
+  if (it == animFiles.end()) // keys already read from model file
+    return;
+
+  // .anim file is only read if some bones have keys in it
+  bool external = std::any_of(bones.begin(), bones.end(), [anim](const Bone & b) { return b.isExternal(anim); });
+
+  GameFile * file = it->second;
+  if (external && file->open())
+  {
+    file->setChunk("AFSB"); // try to set chunk if it exist, no effect if there is no AFSB chunk present
+
+    for (auto & b : bones)
+    {
+      if (b.isExternal(anim))
+        b.loadAnimation(anim, *file);
+    }
+
+    file->close();
+  }
+  else if (external)
+  {
+    LOG_ERROR << "Unable to read animation file" << file->fullname();
+  }
+
+  // failed ones are kept too, not to retry on every frame
+  loadedAnims.push_front(anim);
+
+  if (loadedAnims.size() > ANIM_CACHE_SIZE)
+  {
+    for (auto & b : bones)
+    {
+      if (b.isExternal(loadedAnims.back()))
+        b.unloadAnimation(loadedAnims.back());
+    }
+
+    loadedAnims.pop_back();
+  }
+}
+
 void WoWModel::calcBones(ssize_t anim, size_t time)
 {
+  // read animations used below, if not done yet
+  loadAnimation(anim);
+  if (animManager)
+  {
+    loadAnimation(animManager->GetSecondaryID());
+    loadAnimation(animManager->GetMouthID());
+  }
+
   // Reset all bones to 'false' which means they haven't been animated yet.
   for (auto & it : bones)
   {
@@ -1373,6 +1473,8 @@ void WoWModel::calcBones(ssize_t anim, size_t time)
     if (animLookups.size() >= ANIMATION_HANDSCLOSED && animLookups[ANIMATION_HANDSCLOSED] > 0) // closed fist
       closeFistID = animLookups[ANIMATION_HANDSCLOSED];
 
+    loadAnimation(closeFistID);
+
     // Animate key skeletal bones except the fingers which we do later.
     // -----
     size_t a, t;
@@ -1527,16 +1629,52 @@ void WoWModel::animate(ssize_t anim)
   if (tmax == 0)
     tmax = 1;
 
+  ssize_t secondaryId = -1, mouthId = -1;
+  size_t secondaryFrame = 0, mouthFrame = 0, secondaryCount = 0;
+
   if (isWMO == true)
   {
     t = globalTime;
     t %= tmax;
   }
   else
+  {
     t = animManager->GetFrame();
+    secondaryId = animManager->GetSecondaryID();
+    secondaryFrame = animManager->GetSecondaryFrame();
+    mouthId = animManager->GetMouthID();
+    mouthFrame = animManager->GetMouthFrame();
+    secondaryCount = animManager->GetSecondaryCount();
+  }
+
+  // global time only matters for WMO doodads and global sequences
+  size_t gt = (isWMO || !globalSequences.empty()) ? globalTime : 0;
+
+  // and view only matters for billboarded bones
+  float modelview[16] = { 0 };
+  if (animBones && hasBillboardBones())
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+
+  // skip evaluation when nothing changed since last call (paused animation,
+  // several placements of a WMO doodad sharing the same animation state...)
+  if (animcalc && this->anim == (size_t)anim && this->animtime == t && animGlobalTime == gt &&
+      animSecondaryId == secondaryId && animSecondaryFrame == secondaryFrame && animSecondaryCount == secondaryCount &&
+      animMouthId == mouthId && animMouthFrame == mouthFrame &&
+      animCloseLHand == charModelDetails.closeLHand && animCloseRHand == charModelDetails.closeRHand &&
+      memcmp(animModelview, modelview, sizeof(modelview)) == 0)
+    return;
 
   this->animtime = t;
   this->anim = anim;
+  animGlobalTime = gt;
+  animSecondaryId = secondaryId;
+  animSecondaryFrame = secondaryFrame;
+  animSecondaryCount = secondaryCount;
+  animMouthId = mouthId;
+  animMouthFrame = mouthFrame;
+  animCloseLHand = charModelDetails.closeLHand;
+  animCloseRHand = charModelDetails.closeRHand;
+  memcpy(animModelview, modelview, sizeof(modelview));
 
   if (animBones) // && (!animManager->IsPaused() || !animManager->IsParticlePaused()))
   {
@@ -1606,9 +1744,11 @@ void WoWModel::animate(ssize_t anim)
 
   for (auto & it : texAnims)
     it.calc(anim, t);
+
+  animcalc = true;
 }
 
-inline void WoWModel::drawModel()
+void WoWModel::bindBuffers()
 {
   // assume these client states are enabled: GL_VERTEX_ARRAY, GL_NORMAL_ARRAY, GL_TEXTURE_COORD_ARRAY
   if (video.supportVBO && animated)
@@ -1638,6 +1778,20 @@ inline void WoWModel::drawModel()
     glNormalPointer(GL_FLOAT, 0, normals);
     glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
   }
+}
+
+void WoWModel::unbindBuffers()
+{
+  // clean bind
+  if (video.supportVBO && animated)
+  {
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+  }
+}
+
+inline void WoWModel::drawModel()
+{
+  bindBuffers();
 
   // Display in wireframe mode?
   if (showWireframe)
@@ -1656,11 +1810,7 @@ inline void WoWModel::drawModel()
   if (showWireframe)
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-  // clean bind
-  if (video.supportVBO && animated)
-  {
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-  }
+  unbindBuffers();
 
   // done with all render ops
 }
@@ -1678,22 +1828,90 @@ inline void WoWModel::draw()
   }
   else
   {
-    if (ind)
+    // animate() itself skips evaluation when its inputs didn't change
+    animate(currentAnim);
+
+    if (showModel)
+      drawModel();
+  }
+}
+
+void WoWModel::drawInstances(size_t nbInstances, const std::function<void(size_t)> & setupInstance)
+{
+  if (!ok || !showModel || nbInstances == 0)
+    return;
+
+  if (!animated)
+  {
+    for (size_t i = 0; i < nbInstances; i++)
     {
-      animate(currentAnim);
+      glPushMatrix();
+      setupInstance(i);
+      glCallList(dlist);
+      glPopMatrix();
     }
-    else
+    return;
+  }
+
+  // billboards face the camera from each placement, so each one needs its own animation
+  if (animBones && hasBillboardBones())
+  {
+    for (size_t i = 0; i < nbInstances; i++)
     {
-      if (!animcalc)
-      {
-        animate(currentAnim);
-        //animcalc = true; // Not sure what this is really for but it breaks WMO animation
-      }
+      glPushMatrix();
+      setupInstance(i);
+      draw();
+      glPopMatrix();
     }
+    return;
+  }
 
-    if (showModel)
-      drawModel();
+  animate(currentAnim);
+
+  bindBuffers();
+
+  if (showWireframe)
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+  // render pass by pass, so that texture / blending state is set once for all instances
+  // (fixed function passes don't allow hardware instancing here)
+  for (auto it : passes)
+  {
+    if (!it->init())
+      continue;
+
+    // texture animation leaves matrix mode on GL_TEXTURE until deinit
+    GLint matrixMode;
+    glGetIntegerv(GL_MATRIX_MODE, &matrixMode);
+    glMatrixMode(GL_MODELVIEW);
+
+    for (size_t i = 0; i < nbInstances; i++)
+    {
+      glPushMatrix();
+      setupInstance(i);
+      it->render(animated);
+      glPopMatrix();
+    }
+
+    glMatrixMode(matrixMode);
+    it->deinit();
+  }
+
+  if (showWireframe)
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  unbindBuffers();
+}
+
+bool WoWModel::hasBillboardBones() const
+{
+  for (auto & it : bones)
+  {
+    if (it.billboard)
+      return true;
   }
+
+  return false;
 }
 
 // These aren't really needed in the model viewer.. only wowmapviewer
@@ -2034,184 +2252,280 @@ void WoWModel::mergeModel(WoWModel * m)
   LOG_INFO << __FUNCTION__ << m;
   auto it = mergedModels.insert(m);
   if (it.second == true) // new element inserted
-    refreshMerging();
+  {
+    appendMergedModel(m);
+    updateVertexBuffers(mergedInfos.back().vertexStart);
+    refresh();
+  }
 }
   
-void WoWModel::refreshMerging()
+void WoWModel::appendMergedModel(WoWModel * m)
 {
-  LOG_INFO << __FUNCTION__;
-  for (auto it : mergedModels)
-    LOG_INFO << it->name() << it->gamefile->fullname();
-
-  // first reinit this model with original data
-  origVertices = rawVertices;
-  indices = rawIndices;
-  passes = rawPasses;
-  geosets = rawGeosets;
-  textures.resize(TEXTURE_MAX);
-  replaceTextures.resize(TEXTURE_MAX);
-  specialTextures.resize(TEXTURE_MAX);
+  LOG_INFO << __FUNCTION__ << m->name() << m->gamefile->fullname();
 
-  uint mergeIndex = 0;
-  for (auto modelsIt : mergedModels)
-  {
-    uint nbVertices = origVertices.size();
-    uint nbIndices = indices.size();
-    uint nbGeosets = geosets.size();
-
-    // reinit merged model as well, just in case
-    modelsIt->origVertices = modelsIt->rawVertices;
-    modelsIt->indices = modelsIt->rawIndices;
-    modelsIt->passes = modelsIt->rawPasses;
-    modelsIt->restoreRawGeosets();
+  MergedModelInfo info;
+  info.model = m;
+  info.vertexStart = origVertices.size();
+  info.vertexCount = m->rawVertices.size();
+  info.indexStart = indices.size();
+  info.indexCount = m->rawIndices.size();
+  info.geosetStart = geosets.size();
+  info.passStart = passes.size();
 
-    mergeIndex++;
+  // reinit merged model geosets, just in case
+  m->restoreRawGeosets();
 
-    for (auto it : modelsIt->geosets)
-    {
-      it->istart += nbIndices;
-      it->vstart += nbVertices;
-      geosets.push_back(it);
-    }
+  for (auto it : m->geosets)
+  {
+    it->istart += info.indexStart;
+    it->vstart += info.vertexStart;
+    geosets.push_back(it);
+  }
+  info.geosetCount = m->geosets.size();
 
-    // build bone corresponsance table
-    uint32 nbBonesInNewModel = modelsIt->header.nBones;
-    int16 * boneConvertTable = new int16[nbBonesInNewModel];
+  // build bone corresponsance table
+  if (boneLookup.empty())
+    boneLookup.build(bones);
 
-    for (uint i = 0; i < nbBonesInNewModel; ++i)
-      boneConvertTable[i] = i;
+  uint32 nbBonesInNewModel = m->bones.size();
+  std::vector<int16> boneConvertTable(nbBonesInNewModel);
 
-    for (uint i = 0; i < nbBonesInNewModel; ++i)
-    {
-      Vec3D pivot = modelsIt->bones[i].pivot;
-      for (uint b = 0; b < bones.size(); ++b)
-      {
-        Vec3D p = bones[b].pivot;
-        if ((p == pivot) && 
-            (bones[b].boneDef.unknown == modelsIt->bones[i].boneDef.unknown))
-        {
-          boneConvertTable[i] = b;
-          break;
-        }
-      }
-    }
+  for (uint i = 0; i < nbBonesInNewModel; ++i)
+  {
+    int16 b = boneLookup.find(m->bones[i].pivot, m->bones[i].boneDef.unknown);
+    boneConvertTable[i] = (b != -1) ? b : i;
+  }
 
 #ifdef DEBUG_DH_SUPPORT
-    for (uint i = 0; i < nbBonesInNewModel; ++i)
-      LOG_INFO << i << "=>" << boneConvertTable[i];
+  for (uint i = 0; i < nbBonesInNewModel; ++i)
+    LOG_INFO << i << "=>" << boneConvertTable[i];
 #endif
 
-    // change bone from new model to character one
-    for (auto & it : modelsIt->origVertices)
+  // change bone from new model to character one
+  origVertices.reserve(origVertices.size() + info.vertexCount);
+  for (auto it : m->rawVertices)
+  {
+    for (uint i = 0; i < 4; ++i)
     {
-      for (uint i = 0; i < 4; ++i)
-      {
-        if (it.weights[i] > 0)
-          it.bones[i] = boneConvertTable[it.bones[i]];
-      }
+      if (it.weights[i] > 0 && it.bones[i] < nbBonesInNewModel)
+        it.bones[i] = boneConvertTable[it.bones[i]];
     }
+    origVertices.push_back(it);
+  }
 
-    delete[] boneConvertTable;
+  indices.reserve(indices.size() + info.indexCount);
+  for (auto & it : m->rawIndices)
+    indices.push_back(it + info.vertexStart);
 
-    origVertices.reserve(origVertices.size() + modelsIt->origVertices.size());
-    origVertices.insert(origVertices.end(), modelsIt->origVertices.begin(), modelsIt->origVertices.end());
+  // retrieve tex id associated to model hands (needed for DH)
+  uint16 handTex = ModelRenderPass::INVALID_TEX;
+  for (auto it : passes)
+  {
+    if (geosets[it->geoIndex]->id / 100 == 23)
+      handTex = it->tex;
+  }
 
-    indices.reserve(indices.size() + modelsIt->indices.size());
+  const size_t texStart = (mergedInfos.size() + 1) * TEXTURE_MAX;
 
-    for (auto & it : modelsIt->indices)
-      indices.push_back(it + nbVertices);
+  for (auto it : m->rawPasses)
+  {
+    ModelRenderPass * p = new ModelRenderPass(*it);
+    p->model = this;
+    p->geoIndex += info.geosetStart;
+    bool hands = (m->geosets[it->geoIndex]->id / 100 == 23);
+    if (!hands) // don't copy texture for hands
+      p->tex += texStart;
+    else
+      p->tex = handTex; // use regular model texture instead
 
-    // retrieve tex id associated to model hands (needed for DH)
-    uint16 handTex = ModelRenderPass::INVALID_TEX;
-    for (auto it : passes)
-    {
-      if (geosets[it->geoIndex]->id / 100 == 23)
-        handTex = it->tex;
-    }
+    passes.push_back(p);
+    info.passOwnTex.push_back(!hands);
+  }
+  info.passCount = m->rawPasses.size();
 
-    for (auto it : modelsIt->passes)
-    {
-      ModelRenderPass * p = new ModelRenderPass(*it);
-      p->model = this;
-      p->geoIndex += nbGeosets;
-      if (geosets[it->geoIndex]->id / 100 != 23) // don't copy texture for hands
-        p->tex += (mergeIndex * TEXTURE_MAX);
-      else
-        p->tex = handTex; // use regular model texture instead
+  // add model textures, padded to TEXTURE_MAX so that pass offsets stay valid
+  textures.resize(texStart, ModelRenderPass::INVALID_TEX);
+  specialTextures.resize(texStart, -1);
+  replaceTextures.resize(texStart, ModelRenderPass::INVALID_TEX);
 
-      passes.push_back(p);
-    }
+  for (uint i = 0; i < TEXTURE_MAX; i++)
+  {
+    GLuint tex = (i < m->textures.size()) ? m->textures[i] : ModelRenderPass::INVALID_TEX;
+    if (tex != ModelRenderPass::INVALID_TEX)
+      TEXTUREMANAGER.add(GAMEDIRECTORY.getFile(TEXTUREMANAGER.get(tex)));
+    textures.push_back(tex);
+
+    int special = (i < m->specialTextures.size()) ? m->specialTextures[i] : -1;
+    if (special != -1)
+      special += texStart;
+    specialTextures.push_back(special);
+
+    replaceTextures.push_back((i < m->replaceTextures.size()) ? m->replaceTextures[i] : ModelRenderPass::INVALID_TEX);
+  }
+
+  mergedInfos.push_back(info);
 
 #ifdef DEBUG_DH_SUPPORT
-    LOG_INFO << "---- FINAL ----";
-    LOG_INFO << "nbGeosets =" << geosets.size();
-    LOG_INFO << "nbVertices =" << origVertices.size();
-    LOG_INFO << "nbIndices =" << indices.size();
-    LOG_INFO << "nbPasses =" << passes.size();
+  LOG_INFO << "---- FINAL ----";
+  LOG_INFO << "nbGeosets =" << geosets.size();
+  LOG_INFO << "nbVertices =" << origVertices.size();
+  LOG_INFO << "nbIndices =" << indices.size();
+  LOG_INFO << "nbPasses =" << passes.size();
 #endif
+}
 
-    // add model textures
-    for (auto it : modelsIt->textures)
-    {
-      if (it != ModelRenderPass::INVALID_TEX)
-        TEXTUREMANAGER.add(GAMEDIRECTORY.getFile(TEXTUREMANAGER.get(it)));
-      textures.push_back(it);
-    }
+void WoWModel::removeMergedModel(size_t index)
+{
+  const MergedModelInfo info = mergedInfos[index];
+  LOG_INFO << __FUNCTION__ << info.model->name();
 
-    uint tmax = specialTextures.size();
-    for (auto it : modelsIt->specialTextures)
-    {
-      int val = it;
-      if (it != -1)
-        val += tmax;
+  // release model textures
+  const size_t texStart = (index + 1) * TEXTURE_MAX;
+  for (size_t i = texStart; i < texStart + TEXTURE_MAX && i < textures.size(); i++)
+  {
+    if (textures[i] != ModelRenderPass::INVALID_TEX)
+      TEXTUREMANAGER.del(textures[i]);
+  }
 
-      specialTextures.push_back(val);
-    }
+  textures.erase(textures.begin() + texStart, textures.begin() + texStart + TEXTURE_MAX);
+  replaceTextures.erase(replaceTextures.begin() + texStart, replaceTextures.begin() + texStart + TEXTURE_MAX);
+  specialTextures.erase(specialTextures.begin() + texStart, specialTextures.begin() + texStart + TEXTURE_MAX);
 
-    for (auto it : modelsIt->replaceTextures)
-      replaceTextures.push_back(it);
+  for (size_t i = texStart; i < specialTextures.size(); i++)
+  {
+    if (specialTextures[i] != -1)
+      specialTextures[i] -= TEXTURE_MAX;
   }
 
-  delete[] vertices;
-  delete[] normals;
+  // remove model data (geosets are owned by merged model)
+  for (size_t i = info.passStart; i < info.passStart + info.passCount; i++)
+    delete passes[i];
 
-  vertices = new Vec3D[origVertices.size()];
-  normals = new Vec3D[origVertices.size()];
+  passes.erase(passes.begin() + info.passStart, passes.begin() + info.passStart + info.passCount);
+  geosets.erase(geosets.begin() + info.geosetStart, geosets.begin() + info.geosetStart + info.geosetCount);
+  indices.erase(indices.begin() + info.indexStart, indices.begin() + info.indexStart + info.indexCount);
+  origVertices.erase(origVertices.begin() + info.vertexStart, origVertices.begin() + info.vertexStart + info.vertexCount);
 
-  uint i = 0;
-  for (auto & ov_it : origVertices)
+  mergedInfos.erase(mergedInfos.begin() + index);
+
+  // shift models merged after this one
+  for (size_t i = info.indexStart; i < indices.size(); i++)
+    indices[i] -= info.vertexCount;
+
+  for (size_t i = index; i < mergedInfos.size(); i++)
   {
-    // Set the data for our vertices, normals from the model data
-    vertices[i] = ov_it.pos;
-    normals[i] = ov_it.normal.normalize();
-    ++i;
+    MergedModelInfo & next = mergedInfos[i];
+    next.vertexStart -= info.vertexCount;
+    next.indexStart -= info.indexCount;
+    next.geosetStart -= info.geosetCount;
+    next.passStart -= info.passCount;
+
+    for (size_t g = next.geosetStart; g < next.geosetStart + next.geosetCount; g++)
+    {
+      geosets[g]->istart -= info.indexCount;
+      geosets[g]->vstart -= info.vertexCount;
+    }
+
+    for (size_t p = 0; p < next.passCount; p++)
+    {
+      ModelRenderPass * pass = passes[next.passStart + p];
+      pass->geoIndex -= info.geosetCount;
+      if (next.passOwnTex[p])
+        pass->tex -= TEXTURE_MAX;
+    }
   }
 
-  const size_t size = (origVertices.size() * sizeof(float));
+  updateVertexBuffers(info.vertexStart);
+}
+
+void WoWModel::updateVertexBuffers(size_t from)
+{
+  const size_t nbVertices = origVertices.size();
+  if (from > nbVertices)
+    from = nbVertices;
+
+  const size_t size = (nbVertices * sizeof(float));
   vbufsize = (3 * size); // we multiple by 3 for the x, y, z positions of the vertex
 
+  // animated vertices / bones must be computed again for new geometry
+  animcalc = false;
+
   if (video.supportVBO)
   {
-    glDeleteBuffersARB(1, &nbuf);
-    glDeleteBuffersARB(1, &vbuf);
+    // only upload modified part of the buffers if they are still big enough
+    GLuint * buffers[3] = { &vbuf, &nbuf, &tbuf };
+    const size_t needed[3] = { vbufsize, vbufsize, 2 * size };
+    bool fullUpload = false;
+    for (uint i = 0; i < 3; i++)
+    {
+      GLint bufSize = 0;
+      if (*buffers[i] != 0)
+      {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, *buffers[i]);
+        glGetBufferParameterivARB(GL_ARRAY_BUFFER_ARB, GL_BUFFER_SIZE_ARB, &bufSize);
+      }
+      if ((size_t)bufSize < needed[i])
+        fullUpload = true;
+    }
 
-    // Vert buffer
-    glGenBuffersARB(1, &vbuf);
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbuf);
-    glBufferDataARB(GL_ARRAY_BUFFER_ARB, vbufsize, vertices, GL_STATIC_DRAW_ARB);
-    delete[] vertices; vertices = 0;
+    if (fullUpload)
+      from = 0;
 
-    // normals buffer
-    glGenBuffersARB(1, &nbuf);
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, nbuf);
-    glBufferDataARB(GL_ARRAY_BUFFER_ARB, vbufsize, normals, GL_STATIC_DRAW_ARB);
-    delete[] normals; normals = 0;
+    const size_t count = nbVertices - from;
+    std::vector<Vec3D> newVertices(count);
+    std::vector<Vec3D> newNormals(count);
+    std::vector<Vec2D> newTexCoords(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      ModelVertex & ov = origVertices[from + i];
+      newVertices[i] = ov.pos;
+      newNormals[i] = ov.normal.normalize();
+      newTexCoords[i] = ov.texcoords;
+    }
+
+    const void * data[3] = { newVertices.data(), newNormals.data(), newTexCoords.data() };
+    const size_t elemSize[3] = { sizeof(Vec3D), sizeof(Vec3D), sizeof(Vec2D) };
+    for (uint i = 0; i < 3; i++)
+    {
+      if (*buffers[i] == 0)
+        glGenBuffersARB(1, buffers[i]);
+
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, *buffers[i]);
+      if (fullUpload) // keep some room for next merges
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB, needed[i] + needed[i] / 2, NULL, GL_STATIC_DRAW_ARB);
+      if (count)
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, from * elemSize[i], count * elemSize[i], data[i]);
+    }
 
     // clean bind
     glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
   }
+  else
+  {
+    // keep unchanged part of the arrays, only fill modified range
+    Vec3D * newVertices = new Vec3D[nbVertices];
+    Vec3D * newNormals = new Vec3D[nbVertices];
+    Vec2D * newTexCoords = new Vec2D[nbVertices];
 
-  refresh();
+    for (size_t i = 0; i < from; i++)
+    {
+      newVertices[i] = vertices[i];
+      newNormals[i] = normals[i];
+      newTexCoords[i] = texCoords[i];
+    }
+
+    for (size_t i = from; i < nbVertices; i++)
+    {
+      ModelVertex & ov = origVertices[i];
+      newVertices[i] = ov.pos;
+      newNormals[i] = ov.normal.normalize();
+      newTexCoords[i] = ov.texcoords;
+    }
+
+    delete[] vertices; vertices = newVertices;
+    delete[] normals; normals = newNormals;
+    delete[] texCoords; texCoords = newTexCoords;
+  }
 }
 
 void WoWModel::unmergeModel(QString & name)
@@ -2232,13 +2546,46 @@ void WoWModel::unmergeModel(QString & name)
 void WoWModel::unmergeModel(WoWModel * m)
 {
   LOG_INFO << __FUNCTION__ << m->name();
-  mergedModels.erase(m);
-  refreshMerging();
+  if (mergedModels.erase(m) == 0)
+    return;
+
+  for (size_t i = 0; i < mergedInfos.size(); i++)
+  {
+    if (mergedInfos[i].model == m)
+    {
+      removeMergedModel(i);
+      break;
+    }
+  }
+
+  refresh();
 }
 
 
+void WoWModel::lockRefresh()
+{
+  refreshLocks++;
+}
+
+void WoWModel::unlockRefresh()
+{
+  if (refreshLocks == 0)
+    return;
+
+  if (--refreshLocks == 0 && refreshPending)
+    refresh();
+}
+
 void WoWModel::refresh()
 {
+  if (refreshLocks > 0)
+  {
+    refreshPending = true;
+    return;
+  }
+
+  refreshPending = false;
+
   TextureID charTex = 0;
   bool showScalp = true;
 
@@ -2538,6 +2885,46 @@ GLuint WoWModel::getGLTexture(uint16 tex) const
     
 }
 
+std::set<GLuint> WoWModel::glTextures() const
+{
+  std::set<GLuint> result;
+
+  for (auto tex : textures)
+  {
+    if (tex != ModelRenderPass::INVALID_TEX)
+      result.insert(tex);
+  }
+
+  for (auto tex : replaceTextures)
+  {
+    if (tex != ModelRenderPass::INVALID_TEX)
+      result.insert(tex);
+  }
+
+  return result;
+}
+
+size_t WoWModel::memorySize() const
+{
+  const size_t nbVertices = origVertices.size();
+
+  size_t size = sizeof(WoWModel);
+
+  // vertices, normals and texture coordinates, in main memory and in buffers
+  size += 2 * nbVertices * (2 * sizeof(Vec3D) + sizeof(Vec2D));
+  size += (origVertices.capacity() + rawVertices.capacity()) * sizeof(ModelVertex);
+  size += (indices.capacity() + rawIndices.capacity()) * sizeof(uint32);
+
+  for (auto & bone : bones)
+    size += bone.trans.memorySize() + bone.rot.memorySize() + bone.scale.memorySize();
+
+  size += (passes.size() + rawPasses.size()) * sizeof(ModelRenderPass);
+  size += (geosets.size() + rawGeosets.size()) * sizeof(ModelGeosetHD);
+  size += particleSystems.size() * sizeof(ParticleSystem) + ribbons.size() * sizeof(RibbonEmitter);
+
+  return size;
+}
+
 void WoWModel::restoreRawGeosets()
 {
   std::vector<bool> geosetDisplayStatus;
@@ -2,6 +2,8 @@
 #define _WOWMODEL_H
 
 // C++ files
+#include <functional>
+#include <list>
 #include <map>
 #include <set>
 #include <vector>
@@ -20,6 +22,7 @@
 #include "matrix.h"
 #include "Model.h"
 #include "ModelAttachment.h"
+#include "ModelCache.h"
 #include "ModelCamera.h"
 #include "ModelColor.h"
 #include "ModelEvent.h"
@@ -75,6 +78,8 @@ class _WOWMODEL_API_ WoWModel : public ManagedItem, public Displayable, public M
   std::vector<GLuint> replaceTextures;
 
   inline void drawModel();
+  void bindBuffers();
+  void unbindBuffers();
   void initCommon(GameFile * f);
   bool isAnimated(GameFile * f);
   void initAnimated(GameFile * f);
@@ -82,6 +87,8 @@ class _WOWMODEL_API_ WoWModel : public ManagedItem, public Displayable, public M
 
   void animate(ssize_t anim);
   void calcBones(ssize_t anim, size_t time);
+  // billboarded bones are oriented using current modelview matrix (see Bone::calcMatrix)
+  bool hasBillboardBones() const;
 
   void lightsOn(GLuint lbase);
   void lightsOff(GLuint lbase);
@@ -89,15 +96,39 @@ class _WOWMODEL_API_ WoWModel : public ManagedItem, public Displayable, public M
   std::vector<uint16> boundTris;
   std::vector<Vec3D> bounds;
 
-  void refreshMerging();
   set<WoWModel *> mergedModels;
 
+  // layout of a merged model inside this model data, in merge order
+  // textures of merged model n are stored in block [n * TEXTURE_MAX, (n + 1) * TEXTURE_MAX[
+  struct MergedModelInfo
+  {
+    WoWModel * model;
+    size_t vertexStart, vertexCount;
+    size_t indexStart, indexCount;
+    size_t geosetStart, geosetCount;
+    size_t passStart, passCount;
+    std::vector<bool> passOwnTex; // false for passes using this model hands texture
+  };
+  std::vector<MergedModelInfo> mergedInfos;
+  BoneLookup boneLookup;
+
+  void appendMergedModel(WoWModel * model);
+  void removeMergedModel(size_t index);
+  void updateVertexBuffers(size_t from);
+
+  // see lockRefresh
+  unsigned int refreshLocks;
+  bool refreshPending;
+
   // raw values read from file (useful for merging)
   std::vector<ModelVertex> rawVertices;
   std::vector<uint32> rawIndices;
   std::vector<ModelRenderPass *> rawPasses;
   std::vector<ModelGeosetHD *> rawGeosets;
   std::vector<uint32> skinFileIDs;
+
+  // geometry read from model cache, while building model (see ModelCache)
+  const ModelCache::Geometry * cachedGeometry;
     
   void restoreRawGeosets();
   static bool sortPasses(ModelRenderPass* mrp1, ModelRenderPass* mrp2);
@@ -113,6 +144,10 @@ class _WOWMODEL_API_ WoWModel : public ManagedItem, public Displayable, public M
 
   bool animGeometry, animBones;
 
+  // .anim files by animation id, see loadAnimation
+  std::map<int16, GameFile *> animFiles;
+  std::list<ssize_t> loadedAnims; // most recently used first
+
   vector<AFID> readAFIDSFromFile(GameFile * f);
   void readAnimsFromFile(GameFile * f, vector<AFID> & afids, modelAnimData & data, uint32 nAnimations, uint32 ofsAnimation, uint32 nAnimationLookup, uint32 ofsAnimationLookup);
   vector<TXID> readTXIDSFromFile(GameFile * f);
@@ -196,8 +231,24 @@ public:
   std::vector<Bone> bones;
 
   size_t currentAnim;
-  bool animcalc;
-  size_t anim, animtime;
+  bool animcalc; // true when bones / vertices are up to date for last animate() inputs
+  size_t anim, animtime, animGlobalTime;
+  ssize_t animSecondaryId, animMouthId;
+  size_t animSecondaryFrame, animMouthFrame;
+  size_t animSecondaryCount; // bones animated by secondary animation (upper body)
+  bool animCloseLHand, animCloseRHand;
+  float animModelview[16]; // only used for models with billboarded bones
+
+  // keys of animations stored in external .anim files are only read when animation is
+  // used (calcBones, exporters), and only the last ANIM_CACHE_SIZE ones are kept
+  void loadAnimation(ssize_t anim);
+  static const size_t ANIM_CACHE_SIZE = 8;
+
+  // true if model look changes with global time, even when its animation is paused
+  bool hasGlobalSequences() const { return !globalSequences.empty(); }
+
+  // true if model displays particles or ribbons, which move as long as model is ticked
+  bool hasEmitters() const { return showParticles && (!particleSystems.empty() || !ribbons.empty()); }
 
   void reset()
   {
@@ -221,6 +272,9 @@ public:
   void drawBoundingVolume();
   void drawParticles();
   void draw();
+  // draws model once per instance while animating it only once. setupInstance is called for
+  // each instance with modelview matrix pushed, to apply instance transform and lighting
+  void drawInstances(size_t nbInstances, const std::function<void(size_t)> & setupInstance);
   // -------------------------------
 
   void updateEmitters(float dt);
@@ -270,8 +324,18 @@ public:
 
   void refresh();
 
+  // while locked, refresh requests (merge / unmerge of item models, etc.) are only recorded,
+  // a single refresh is then done when last lock is released (see OutfitLoader)
+  void lockRefresh();
+  void unlockRefresh();
+
   QString getNameForTex(uint16 tex);
   GLuint getGLTexture(uint16 tex) const;
+
+  // GL textures used by model, and rough size of model data in memory and on graphic card
+  // (textures not included, they are shared between models), see ModelManager
+  std::set<GLuint> glTextures() const;
+  size_t memorySize() const;
   void dumpTextureStatus();
 
   friend _WOWMODEL_API_ std::ostream& operator<<(std::ostream& out, const WoWModel& m);
@@ -86,6 +86,72 @@ enum Interpolations {
 	INTERPOLATION_BEZIER
 };
 
+// value at given time of one animation track (key times, values and
+// hermite / bezier tangents), time is clamped to last key
+template<class T>
+T interpolateKeys(ssize_t type, const std::vector<size_t> & times, const std::vector<T> & data,
+                  const std::vector<T> & in, const std::vector<T> & out, size_t time)
+{
+	if (data.size()>1 && times.size()>1) {
+		size_t t1, t2;
+		size_t pos=0;
+		float r;
+		size_t max_time = times[times.size()-1];
+		//if (max_time > 0)
+		//	time %= max_time; // I think this might not be necessary?
+		if (time > max_time) {
+			pos=times.size()-1;
+			r = 1.0f;
+
+			if (type == INTERPOLATION_NONE) 
+				return data[pos];
+			else if (type == INTERPOLATION_LINEAR) 
+				return interpolate<T>(r,data[pos],data[pos]);
+			else if (type==INTERPOLATION_HERMITE){
+				// INTERPOLATION_HERMITE is only used in cameras afaik?
+				return interpolateHermite<T>(r,data[pos],data[pos],in[pos],out[pos]);
+			}
+			else if (type==INTERPOLATION_BEZIER){
+				//Is this used ingame or only by custom models?
+				return interpolateBezier<T>(r,data[pos],data[pos],in[pos],out[pos]);
+			}
+			else //this shouldn't appear!
+				return data[pos];
+		} else {
+			for (size_t i=0; i<times.size()-1; i++) {
+				if (time >= times[i] && time < times[i+1]) {
+					pos = i;
+					break;
+				}
+			}
+			t1 = times[pos];
+			t2 = times[pos+1];
+			r = (time-t1)/(float)(t2-t1);
+
+			if (type == INTERPOLATION_NONE) 
+				return data[pos];
+			else if (type == INTERPOLATION_LINEAR) 
+				return interpolate<T>(r,data[pos],data[pos+1]);
+			else if (type==INTERPOLATION_HERMITE){
+				// INTERPOLATION_HERMITE is only used in cameras afaik?
+				return interpolateHermite<T>(r,data[pos],data[pos+1],in[pos],out[pos]);
+			}
+			else if (type==INTERPOLATION_BEZIER){
+				//Is this used ingame or only by custom models?
+				return interpolateBezier<T>(r,data[pos],data[pos+1],in[pos],out[pos]);
+			}
+			else //this shouldn't appear!
+				return data[pos];
+		}
+	} else {
+		// default value
+		if (data.size() == 0)
+			return T();
+		else
+			return data[0];
+	}
+}
+
 template <class T>
 class Identity {
 public:
@@ -167,65 +233,7 @@ public:
 				time = globalTime % globals[seq];
 			anim = 0;
 		}
-		if (data[anim].size()>1 && times[anim].size()>1) {
-			size_t t1, t2;
-			size_t pos=0;
-			float r;
-			size_t max_time = times[anim][times[anim].size()-1];
-			//if (max_time > 0)
-			//	time %= max_time; // I think this might not be necessary?
-			if (time > max_time) {
-				pos=times[anim].size()-1;
-				r = 1.0f;
-
-				if (type == INTERPOLATION_NONE) 
-					return data[anim][pos];
-				else if (type == INTERPOLATION_LINEAR) 
-					return interpolate<T>(r,data[anim][pos],data[anim][pos]);
-				else if (type==INTERPOLATION_HERMITE){
-					// INTERPOLATION_HERMITE is only used in cameras afaik?
-					return interpolateHermite<T>(r,data[anim][pos],data[anim][pos],in[anim][pos],out[anim][pos]);
-				}
-				else if (type==INTERPOLATION_BEZIER){
-					//Is this used ingame or only by custom models?
-					return interpolateBezier<T>(r,data[anim][pos],data[anim][pos],in[anim][pos],out[anim][pos]);
-				}
-				else //this shouldn't appear!
-					return data[anim][pos];
-			} else {
-				for (size_t i=0; i<times[anim].size()-1; i++) {
-					if (time >= times[anim][i] && time < times[anim][i+1]) {
-						pos = i;
-						break;
-					}
-				}
-				t1 = times[anim][pos];
-				t2 = times[anim][pos+1];
-				r = (time-t1)/(float)(t2-t1);
-
-				if (type == INTERPOLATION_NONE) 
-					return data[anim][pos];
-				else if (type == INTERPOLATION_LINEAR) 
-					return interpolate<T>(r,data[anim][pos],data[anim][pos+1]);
-				else if (type==INTERPOLATION_HERMITE){
-					// INTERPOLATION_HERMITE is only used in cameras afaik?
-					return interpolateHermite<T>(r,data[anim][pos],data[anim][pos+1],in[anim][pos],out[anim][pos]);
-				}
-				else if (type==INTERPOLATION_BEZIER){
-					//Is this used ingame or only by custom models?
-					return interpolateBezier<T>(r,data[anim][pos],data[anim][pos+1],in[anim][pos],out[anim][pos]);
-				}
-				else //this shouldn't appear!
-					return data[anim][pos];
-			}
-		} else {
-			// default value
-			if (data[anim].size() == 0)
-				return T();
-			else
-				return data[anim][0];
-		}
-
+		return interpolateKeys<T>(type, times[anim], data[anim], in[anim], out[anim], time);
 	}
 
 	void init(AnimationBlock &b, GameFile * f, std::vector<uint32> & gs)
@@ -294,114 +302,69 @@ public:
 		if( b.nTimes == 0 )
 			return;
 
-		for(size_t j=0; j < b.nTimes; j++) 
-    {
-      uint32 *ptimes;
-      AnimationBlockHeader* pHeadTimes;
-      auto it = modelData.animfiles.find(modelData.animIndexToAnimId.at(j));
-      if (it != modelData.animfiles.end())
-      {
-        GameFile * animfile = it->second.first;
-        GameFile * skelfile = it->second.second;
-        skelfile->setChunk("SKB1");
-        pHeadTimes = (AnimationBlockHeader*)(skelfile->getBuffer() + b.ofsTimes + j*sizeof(AnimationBlockHeader));
-        ptimes = (uint32*)(animfile->getBuffer() + pHeadTimes->ofsEntrys);
-        if (animfile->getSize() < pHeadTimes->ofsEntrys)
-          continue;
-      }
-      else
-      {
-        pHeadTimes = (AnimationBlockHeader*)(f.getBuffer() + b.ofsTimes + j*sizeof(AnimationBlockHeader));
-        ptimes = (uint32*)(f.getBuffer() + pHeadTimes->ofsEntrys);
-        if (f.getSize() < pHeadTimes->ofsEntrys)
-          continue;
-      }
-
-			for (size_t i=0; i < pHeadTimes->nEntrys; i++)
-				times[j].push_back(ptimes[i]);
-		}
-
-		// keyframes
-		for(size_t j=0; j < b.nKeys; j++) 
-    {
-			D *keys;
-      AnimationBlockHeader* pHeadKeys;
-      auto it = modelData.animfiles.find(modelData.animIndexToAnimId.at(j));
-      if (it != modelData.animfiles.end())
-      {
-        GameFile * animfile = it->second.first;
-        GameFile * skelfile = it->second.second;
-        skelfile->setChunk("SKB1");
-        pHeadKeys = (AnimationBlockHeader*)(skelfile->getBuffer() + b.ofsKeys + j*sizeof(AnimationBlockHeader));
-        keys = (D*)(animfile->getBuffer() + pHeadKeys->ofsEntrys);
-        if (animfile->getSize() < pHeadKeys->ofsEntrys)
-          continue;
-      }
-      else
-      {
-        pHeadKeys = (AnimationBlockHeader*)(f.getBuffer() + b.ofsKeys + j*sizeof(AnimationBlockHeader));
-        keys = (D*)(f.getBuffer() + pHeadKeys->ofsEntrys);
-        if (f.getSize() < pHeadKeys->ofsEntrys)
-          continue;
-      }
-
-			switch (type) 
-      {
-				case INTERPOLATION_NONE:
-				case INTERPOLATION_LINEAR:
-					for (size_t i = 0; i < pHeadKeys->nEntrys; i++) 
-						data[j].push_back(Conv::conv(keys[i]));
-					break;
-				case INTERPOLATION_HERMITE:
-					for (size_t i = 0; i < pHeadKeys->nEntrys; i++) 
-          {
-						data[j].push_back(Conv::conv(keys[i*3]));
-						in[j].push_back(Conv::conv(keys[i*3+1]));
-						out[j].push_back(Conv::conv(keys[i*3+2]));
-					}
-					break;
-				case INTERPOLATION_BEZIER:
-					for (size_t i = 0; i < pHeadKeys->nEntrys; i++) 
-          {
-						data[j].push_back(Conv::conv(keys[i*3]));
-						in[j].push_back(Conv::conv(keys[i*3+1]));
-						out[j].push_back(Conv::conv(keys[i*3+2]));
-					}
-					break;
+		for (size_t j = 0; j < b.nTimes; j++)
+		{
+			auto it = modelData.animfiles.find(modelData.animIndexToAnimId.at(j));
+			if (it != modelData.animfiles.end())
+			{
+				// keys are stored in an external .anim file, only read when animation is used (see load)
+				GameFile * skelfile = it->second.second;
+				skelfile->setChunk("SKB1");
+				AnimationBlockHeader* pHeadTimes = (AnimationBlockHeader*)(skelfile->getBuffer() + b.ofsTimes + j*sizeof(AnimationBlockHeader));
+				AnimationBlockHeader* pHeadKeys = (AnimationBlockHeader*)(skelfile->getBuffer() + b.ofsKeys + j*sizeof(AnimationBlockHeader));
+				external[j] = std::make_pair(*pHeadTimes, *pHeadKeys);
+			}
+			else
+			{
+				AnimationBlockHeader* pHeadTimes = (AnimationBlockHeader*)(f.getBuffer() + b.ofsTimes + j*sizeof(AnimationBlockHeader));
+				AnimationBlockHeader* pHeadKeys = (AnimationBlockHeader*)(f.getBuffer() + b.ofsKeys + j*sizeof(AnimationBlockHeader));
+				readKeys(j, *pHeadTimes, *pHeadKeys, f);
 			}
 		}
 	}
 
+	// animation keys stored in an external .anim file
+	bool isExternal(size_t anim) const { return external.find(anim) != external.end(); }
+
+	// reads keys of an external animation, animfile being its opened .anim file
+	void load(size_t anim, GameFile & animfile)
+	{
+		auto it = external.find(anim);
+		if (it == external.end() || !times[anim].empty())
+			return;
+
+		readKeys(anim, it->second.first, it->second.second, animfile);
+		fixKeys(anim);
+	}
+
+	// frees keys of an external animation, next load reads them again
+	void unload(size_t anim)
+	{
+		if (!isExternal(anim))
+			return;
+
+		std::vector<size_t>().swap(times[anim]);
+		std::vector<T>().swap(data[anim]);
+		std::vector<T>().swap(in[anim]);
+		std::vector<T>().swap(out[anim]);
+	}
+
+	// bytes used by keys currently loaded
+	size_t memorySize() const
+	{
+		size_t size = sizeof(*this) + globals.capacity() * sizeof(uint32);
+		for (size_t i = 0; i < MAX_ANIMATED; i++)
+			size += times[i].capacity() * sizeof(size_t) + (data[i].capacity() + in[i].capacity() + out[i].capacity()) * sizeof(T);
+		return size;
+	}
+
 	void fix(T fixfunc(const T))
 	{
-		switch (type) {
-			case INTERPOLATION_NONE:
-			case INTERPOLATION_LINEAR:
-				for (size_t i=0; i<sizes; i++) {
-					for (size_t j=0; j<data[i].size(); j++) {
-						data[i][j] = fixfunc(data[i][j]);
-					}
-				}
-				break;
-			case INTERPOLATION_HERMITE:
-				for (size_t i=0; i<sizes; i++) {
-					for (size_t j=0; j<data[i].size(); j++) {
-						data[i][j] = fixfunc(data[i][j]);
-						in[i][j] = fixfunc(in[i][j]);
-						out[i][j] = fixfunc(out[i][j]);
-					}
-				}
-				break;
-			case INTERPOLATION_BEZIER:
-				for (size_t i=0; i<sizes; i++) {
-					for (size_t j=0; j<data[i].size(); j++) {
-						data[i][j] = fixfunc(data[i][j]);
-						in[i][j] = fixfunc(in[i][j]);
-						out[i][j] = fixfunc(out[i][j]);
-					}
-				}
-				break;
-		}
+		// kept for keys of external animations, read later
+		fixFunc = fixfunc;
+
+		for (size_t i=0; i<sizes; i++)
+			fixKeys(i);
 	}
   friend std::ostream& operator<<(std::ostream& out, const Animated& v)
 	{
@@ -425,6 +388,65 @@ public:
 		out << "      </anims>"<< std::endl;
 		return out;
 	}
+
+private:
+	// block headers of animations stored in external .anim files (times, keys)
+	std::map<size_t, std::pair<AnimationBlockHeader, AnimationBlockHeader> > external;
+	T (*fixFunc)(const T) = 0;
+
+	void readKeys(size_t j, const AnimationBlockHeader & headTimes, const AnimationBlockHeader & headKeys, GameFile & f)
+	{
+		if (f.getSize() >= headTimes.ofsEntrys)
+		{
+			uint32 *ptimes = (uint32*)(f.getBuffer() + headTimes.ofsEntrys);
+			for (size_t i=0; i < headTimes.nEntrys; i++)
+				times[j].push_back(ptimes[i]);
+		}
+
+		if (f.getSize() < headKeys.ofsEntrys)
+			return;
+
+		D *keys = (D*)(f.getBuffer() + headKeys.ofsEntrys);
+		switch (type)
+		{
+			case INTERPOLATION_NONE:
+			case INTERPOLATION_LINEAR:
+				for (size_t i = 0; i < headKeys.nEntrys; i++)
+					data[j].push_back(Conv::conv(keys[i]));
+				break;
+			case INTERPOLATION_HERMITE:
+			case INTERPOLATION_BEZIER: //let's use same values like hermite?!?
+				for (size_t i = 0; i < headKeys.nEntrys; i++)
+				{
+					data[j].push_back(Conv::conv(keys[i*3]));
+					in[j].push_back(Conv::conv(keys[i*3+1]));
+					out[j].push_back(Conv::conv(keys[i*3+2]));
+				}
+				break;
+		}
+	}
+
+	void fixKeys(size_t i)
+	{
+		if (!fixFunc)
+			return;
+
+		switch (type) {
+			case INTERPOLATION_NONE:
+			case INTERPOLATION_LINEAR:
+				for (size_t j=0; j<data[i].size(); j++)
+					data[i][j] = fixFunc(data[i][j]);
+				break;
+			case INTERPOLATION_HERMITE:
+			case INTERPOLATION_BEZIER:
+				for (size_t j=0; j<data[i].size(); j++) {
+					data[i][j] = fixFunc(data[i][j]);
+					in[i][j] = fixFunc(in[i][j]);
+					out[i][j] = fixFunc(out[i][j]);
+				}
+				break;
+		}
+	}
 };
 
 typedef Animated<float,short,ShortToFloat> AnimatedShort;
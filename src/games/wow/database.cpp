@@ -1,11 +1,48 @@
 #include "database.h"
 
+#include <cstdlib>
+#include <string>
+
+#include <QStringList>
+
+#include "Game.h"
 #include "wow_enums.h"
 #include "logger/Logger.h"
 
 
 _DATABASE_API_ ItemDatabase		items;
 _DATABASE_API_ std::vector<NPCRecord> npcs;
+_DATABASE_API_ std::unordered_map<int, size_t> npcLookup;
+_DATABASE_API_ SearchIndex npcNames;
+
+void addNPC(const NPCRecord & rec)
+{
+  npcLookup.insert(std::make_pair(rec.id, npcs.size())); // first record wins, as linear lookups did
+  npcNames.add(rec.id, rec.name);
+  npcs.push_back(rec);
+}
+
+bool initNPCs()
+{
+  std::vector<QString> values(4);
+  bool ok = GAMEDATABASE.readTable("Creature", QStringList() << "ID" << "DisplayID1" << "CreatureTypeID" << "Name",
+                                   [&](const std::vector<std::string> & value)
+  {
+    if (atoi(value[1].c_str()) == 0)
+      return;
+
+    for (size_t i = 0; i < values.size(); i++)
+      values[i] = QString::fromStdString(value[i]);
+
+    addNPC(NPCRecord(values));
+  });
+
+  if (!ok || npcs.empty())
+    return false;
+
+  LOG_INFO << "Found" << npcs.size() << "NPCs";
+  return true;
+}
 
 
 // --
@@ -96,13 +133,57 @@ ItemDatabase::ItemDatabase()
 	items.push_back(all);
 }
 
-const ItemRecord& ItemDatabase::getById(int id)
+void ItemDatabase::add(const ItemRecord & rec)
+{
+  itemLookup.insert(std::make_pair(rec.id, items.size())); // first record wins, as linear lookups did
+  names.add(rec.id, rec.name);
+  items.push_back(rec);
+}
+
+bool ItemDatabase::init()
 {
-  for (std::vector<ItemRecord>::iterator it=items.begin();  it!=items.end(); ++it)
+  // same items as "Item LEFT JOIN ItemSparse WHERE Item.Type != 0 AND ItemSparse.Name != ''"
+  std::unordered_map<int, QString> names;
+  bool ok = GAMEDATABASE.readTable("ItemSparse", QStringList() << "ID" << "Name",
+                                   [&](const std::vector<std::string> & value)
   {
-    if(it->id == id)
-      return *it;
-  }
+    if (!value[1].empty())
+      names[atoi(value[0].c_str())] = QString::fromStdString(value[1]);
+  });
+
+  size_t nbItems = items.size();
+  std::vector<QString> values(6);
+  ok = ok && GAMEDATABASE.readTable("Item", QStringList() << "ID" << "Type" << "Class" << "SubClass" << "Sheath",
+                                    [&](const std::vector<std::string> & value)
+  {
+    if (atoi(value[1].c_str()) == 0)
+      return;
+
+    auto name = names.find(atoi(value[0].c_str()));
+    if (name == names.end())
+      return;
+
+    values[0] = QString::fromStdString(value[0]);
+    values[1] = name->second;
+    for (size_t i = 2; i < values.size(); i++)
+      values[i] = QString::fromStdString(value[i - 1]);
+
+    add(ItemRecord(values));
+  });
+
+  if (!ok || items.size() == nbItems)
+    return false;
+
+  LOG_INFO << "Found" << items.size() - nbItems << "items";
+  return true;
+}
+
+const ItemRecord& ItemDatabase::getById(int id)
+{
+  std::unordered_map<int, size_t>::const_iterator it = itemLookup.find(id);
+  if (it != itemLookup.end())
+    return items[it->second];
+
   return items[0];
 }
 
@@ -8,12 +8,15 @@
 // different objects need to access them at one point or another.
 
 // STL
+#include <unordered_map>
 #include <vector>
 #include <map>
 
 
 #include <QString>
 
+#include "SearchIndex.h"
+
 // wmv database
 class ItemDatabase;
 struct NPCRecord;
@@ -32,6 +35,14 @@ class ItemDatabase;
 
 _DATABASE_API_ extern ItemDatabase items;
 _DATABASE_API_ extern std::vector<NPCRecord> npcs;
+_DATABASE_API_ extern std::unordered_map<int, size_t> npcLookup; // npc id -> npcs index
+_DATABASE_API_ extern SearchIndex npcNames; // searched by npc id
+
+// adds npc to npcs, keeping lookup and search index up to date
+_DATABASE_API_ void addNPC(const NPCRecord &);
+
+// fills npcs from Creature game file, false if none found
+_DATABASE_API_ bool initNPCs();
 
 // ==============================================
 
@@ -55,7 +66,14 @@ public:
 	ItemDatabase();
 
 	std::vector<ItemRecord> items;
-	std::map<int, int> itemLookup;
+	std::unordered_map<int, size_t> itemLookup; // item id -> items index
+	SearchIndex names; // searched by item id
+
+	// adds item to items, keeping lookup and search index up to date
+	void add(const ItemRecord &);
+
+	// fills items from Item and ItemSparse game files, false if none found
+	bool init();
 
 	const ItemRecord& getById(int id);
 };
@@ -16,9 +16,23 @@
 #define WIP_DH_SUPPORT 1
 
 #ifdef _LINUX // Linux
+// headless builds have no GLX, entry points are resolved by the offscreen context library.
+// declared here as OSMesa / EGL headers can't be mixed with glew ones (see OffscreenContext)
+#if defined(GLEW_OSMESA)
+	extern "C" void (*OSMesaGetProcAddress(const char *funcName))(void);
+#elif defined(GLEW_EGL)
+	extern "C" void (*eglGetProcAddress(const char *procname))(void);
+#endif
+
 	void (*wglGetProcAddress(const char *function_name))(void)
 	{
+#if defined(GLEW_OSMESA)
+		return OSMesaGetProcAddress(function_name);
+#elif defined(GLEW_EGL)
+		return eglGetProcAddress(function_name);
+#else
 		return glXGetProcAddress((GLubyte*)function_name);
+#endif
 	}
 #endif
 
@@ -3,11 +3,14 @@
 #include "CASCFile.h"
 #include "Game.h"
 #include "WMOGroup.h"
+#include "WMOGroupLoader.h"
 
 #include "logger/Logger.h"
 
 #include <algorithm>
 
+#include <QElapsedTimer>
+
 
 using namespace std;
 
@@ -22,7 +25,8 @@ void WMO::flipcc(QString & cc)
 WMO::WMO(QString name) : 
   ManagedItem(name),
   maxCoord(), 
-  minCoord()
+  minCoord(),
+  m_groupLoader(0)
 {
   CASCFile f(name);
   f.open();
@@ -266,30 +270,36 @@ WMO::WMO(QString name) :
 	f.close();
   delete[] texbuf;
 
-	for (size_t i=0; i<nGroups; i++) groups[i].initDisplayList();
-
-  // compute min/max bounds based on groups
+  // compute min/max bounds based on groups bounding boxes from root file, as group
+  // files are loaded in background
   for (size_t i = 0; i < nGroups; i++)
   {
-    if (groups[i].vmin.x < minCoord.x)
-      minCoord.x = groups[i].vmin.x;
-    else if (groups[i].vmax.x > maxCoord.x)
-      maxCoord.x = groups[i].vmax.x;
-
-    if (groups[i].vmin.y < minCoord.y)
-      minCoord.y = groups[i].vmin.y;
-    else if (groups[i].vmax.y > maxCoord.y)
-      maxCoord.y = groups[i].vmax.y;
-
-    if (groups[i].vmin.z < minCoord.z)
-      minCoord.z = groups[i].vmin.z;
-    else if (groups[i].vmax.z > maxCoord.z)
-      maxCoord.z = groups[i].vmax.z;
+    Vec3D a = fixCoordSystem(groups[i].v1);
+    Vec3D b = fixCoordSystem(groups[i].v2);
+    Vec3D gmin(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    Vec3D gmax(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+
+    if (i == 0)
+    {
+      minCoord = gmin;
+      maxCoord = gmax;
+      continue;
+    }
+
+    minCoord = Vec3D(std::min(minCoord.x, gmin.x), std::min(minCoord.y, gmin.y), std::min(minCoord.z, gmin.z));
+    maxCoord = Vec3D(std::max(maxCoord.x, gmax.x), std::max(maxCoord.y, gmax.y), std::max(maxCoord.z, gmax.z));
   }
+
+  m_groupLoader = new WMOGroupLoader(this);
+  m_groupLoader->setFocus((minCoord + maxCoord) * 0.5f);
+  m_groupLoader->start();
 }
 
 WMO::~WMO()
 {
+	// workers use groups, stop them first
+	delete m_groupLoader;
+
 	if (ok) {
 		//gLog("Unloading WMO %s\n", name.c_str());
 	  delete[] groups;
@@ -319,14 +329,18 @@ WMO::~WMO()
 
 void WMO::loadGroup(int id)
 {
+	finishStreaming();
+
 	if (id==-1) {
     for (size_t i = 0; i < nGroups; i++) {
-      groups[i].initDisplayList();
+      if (!groups[i].ok)
+        groups[i].initDisplayList();
       groups[i].visible = true;
     }
 	}
 	else if (id>=0 && (unsigned int)id<nGroups) {
-		groups[id].initDisplayList();
+		if (!groups[id].ok)
+			groups[id].initDisplayList();
 		for (size_t i=0; i<nGroups; i++) {
 			groups[i].visible = ((int)i==id);
 			if ((int)i!=id) groups[i].cleanup();
@@ -343,32 +357,174 @@ void WMO::showDoodadSet(int id)
 
 void WMO::updateModels()
 {
-	// 1. look for visible models that aren't loaded
-	for (size_t i=0; i<nGroups; i++) if (groups[i].visible) groups[i].updateModels(true);
+	// models may be released below, drop batches referencing them
+	m_doodadBatches.clear();
+	m_modelsToLoad.clear();
+
+	// group visibility changes every frame with culling, so doodads follow loaded groups instead
+	// 1. look for models in loaded groups that aren't loaded, they are loaded in updateStreaming
+	for (size_t i=0; i<nGroups; i++) if (groups[i].ok) groups[i].updateModels(true);
 	// 2. unload unused models
-	for (size_t i=0; i<nGroups; i++) if (!groups[i].visible) groups[i].updateModels(false);
+	for (size_t i=0; i<nGroups; i++) if (!groups[i].ok) groups[i].updateModels(false);
+}
+
+void WMO::requestModel(short dd)
+{
+  m_modelsToLoad.push_back(dd);
+}
+
+bool WMO::isStreaming() const
+{
+  return !m_groupsToUpload.empty() || !m_modelsToLoad.empty() ||
+         (m_groupLoader && !m_groupLoader->isDone());
+}
+
+bool WMO::isAnimated() const
+{
+  if (skybox && skybox->animated)
+    return true;
+
+  // doodads are animated using global time, see WoWModel::animate
+  for (auto & it : m_doodadBatches)
+  {
+    if (it.first->animated)
+      return true;
+  }
+
+  return false;
+}
+
+void WMO::updateStreaming()
+{
+  if (!m_groupLoader)
+    return;
+
+  // last known camera position drives loading order
+  Vec3D eye = m_viewFrustum.eye;
+  m_groupLoader->setFocus(eye);
+  m_groupLoader->takeLoadedGroups(m_groupsToUpload);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // 1. upload parsed groups, nearest first
+  while (!m_groupsToUpload.empty() && timer.elapsed() < STREAMING_BUDGET_MS)
+  {
+    size_t best = 0;
+    float bestDist = -1.0f;
+    for (size_t i = 0; i < m_groupsToUpload.size(); i++)
+    {
+      WMOGroup & g = groups[m_groupsToUpload[i]];
+      float dist = ((g.vmin + g.vmax) * 0.5f - eye).lengthSquared();
+      if (bestDist < 0.0f || dist < bestDist)
+      {
+        best = i;
+        bestDist = dist;
+      }
+    }
+
+    uint32 id = m_groupsToUpload[best];
+    m_groupsToUpload[best] = m_groupsToUpload.back();
+    m_groupsToUpload.pop_back();
+
+    groups[id].upload();
+    if (doodadset >= 0)
+      groups[id].updateModels(true);
+  }
+
+  // 2. load doodads models, nearest first
+  while (!m_modelsToLoad.empty() && timer.elapsed() < STREAMING_BUDGET_MS)
+  {
+    size_t best = 0;
+    float bestDist = -1.0f;
+    for (size_t i = 0; i < m_modelsToLoad.size(); i++)
+    {
+      float dist = (modelis[m_modelsToLoad[i]].pos - eye).lengthSquared();
+      if (bestDist < 0.0f || dist < bestDist)
+      {
+        best = i;
+        bestDist = dist;
+      }
+    }
+
+    WMOModelInstance & mi = modelis[m_modelsToLoad[best]];
+    m_modelsToLoad[best] = m_modelsToLoad.back();
+    m_modelsToLoad.pop_back();
+
+    if (!mi.model)
+      mi.loadModel(loadedModels);
+  }
+}
+
+void WMO::finishStreaming()
+{
+  if (!m_groupLoader)
+    return;
+
+  m_groupLoader->waitForDone();
+  m_groupLoader->takeLoadedGroups(m_groupsToUpload);
+
+  for (auto id : m_groupsToUpload)
+    groups[id].upload();
+  m_groupsToUpload.clear();
 }
 
 void WMO::update(int dt)
 {
-	loadedModels.resetAnim();
+	// no need to reset animations: doodads are only re-animated when global time changes
 	loadedModels.updateEmitters(dt/1000.0f);
 }
 
+void WMO::drawDoodads()
+{
+  // keep vectors allocated from one frame to the other
+  for (auto & it : m_doodadBatches)
+    it.second.clear();
+
+  for (auto id : visibleGroups)
+    groups[id].collectDoodads(doodadset, m_viewFrustum, m_doodadBatches);
+
+  glColor4f(1, 1, 1, 1);
+
+  for (auto & it : m_doodadBatches)
+  {
+    std::vector<WMODoodadRef> & refs = it.second;
+    if (refs.empty())
+      continue;
+
+    it.first->drawInstances(refs.size(), [&refs](size_t i)
+    {
+      WMODoodadRef & ref = refs[i];
+      if (!ref.outdoorLights) {
+        glDisable(GL_LIGHT0);
+        WMOLight::setupOnce(GL_LIGHT2, ref.instance->ldir, ref.instance->lcol);
+      }
+      else {
+        glEnable(GL_LIGHT0);
+      }
+      ref.instance->setupTransform();
+    });
+  }
+
+  glDisable(GL_LIGHT2);
+  glColor4f(1, 1, 1, 1);
+}
+
 void WMO::draw()
 {
 	if (!ok) return;
-  
-	for (size_t i=0; i<nGroups; i++) {
-		groups[i].draw();
-	}
 
-	for (size_t i=0; i<nGroups; i++) {
-		groups[i].drawDoodads(doodadset);
+	updateStreaming();
+	updateVisibility();
+
+	for (auto id : visibleGroups) {
+		groups[id].draw();
 	}
 
-	for (size_t i=0; i<nGroups; i++) {
-		groups[i].drawLiquid();
+	drawDoodads();
+
+	for (auto id : visibleGroups) {
+		groups[id].drawLiquid();
 	}
 
 	/*
@@ -449,6 +605,131 @@ void WMO::draw()
 	drawPortals();
 }
 
+void WMO::updateVisibility()
+{
+  for (size_t i = 0; i < nGroups; i++)
+    groups[i].visible = false;
+  visibleGroups.clear();
+
+  // planes are expressed in WMO space, as current modelview already contains WMO placement
+  m_viewFrustum.fromGLMatrices();
+
+  int camGroup = findCameraGroup(m_viewFrustum.eye);
+  std::vector<bool> onPath(nGroups, false);
+
+  if (camGroup == -1)
+  {
+    // camera outside of the WMO: portals are meaningless, only rely on frustum
+    for (size_t i = 0; i < nGroups; i++)
+    {
+      if (groups[i].ok && m_viewFrustum.intersects(groups[i].vmin, groups[i].vmax))
+        markGroupVisible((uint32)i);
+    }
+    return;
+  }
+
+  traversePortals(camGroup, m_viewFrustum, onPath, 0);
+
+  // from an outdoor group, all other outdoor groups can be seen without going through a portal
+  if (!groups[camGroup].isIndoor())
+  {
+    for (size_t i = 0; i < nGroups; i++)
+    {
+      if (groups[i].ok && !groups[i].visible && groups[i].isOutdoor() &&
+          m_viewFrustum.intersects(groups[i].vmin, groups[i].vmax))
+        traversePortals((uint32)i, m_viewFrustum, onPath, 0);
+    }
+  }
+}
+
+int WMO::findCameraGroup(const Vec3D & eye)
+{
+  // several group boxes may contain camera : prefer indoor groups, then smallest one
+  int result = -1;
+  bool resultIndoor = false;
+  float resultVolume = 0.0f;
+
+  for (size_t i = 0; i < nGroups; i++)
+  {
+    WMOGroup & g = groups[i];
+    if (!g.ok)
+      continue;
+
+    if (eye.x < g.vmin.x || eye.y < g.vmin.y || eye.z < g.vmin.z ||
+        eye.x > g.vmax.x || eye.y > g.vmax.y || eye.z > g.vmax.z)
+      continue;
+
+    Vec3D size = g.vmax - g.vmin;
+    float volume = size.x * size.y * size.z;
+    bool indoor = g.isIndoor();
+
+    if (result == -1 || (indoor && !resultIndoor) ||
+        (indoor == resultIndoor && volume < resultVolume))
+    {
+      result = (int)i;
+      resultIndoor = indoor;
+      resultVolume = volume;
+    }
+  }
+
+  return result;
+}
+
+void WMO::markGroupVisible(uint32 id)
+{
+  if (groups[id].visible)
+    return;
+
+  groups[id].visible = true;
+  visibleGroups.push_back(id);
+}
+
+void WMO::traversePortals(uint32 id, const Frustum & frustum, std::vector<bool> & onPath, int depth)
+{
+  WMOGroup & g = groups[id];
+  if (!g.ok)
+    return;
+
+  markGroupVisible(id);
+
+  if (depth >= MAX_PORTAL_DEPTH)
+    return;
+
+  onPath[id] = true;
+
+  for (int i = g.portalStart; i < g.portalStart + g.portalCount; i++)
+  {
+    if (i < 0 || (size_t)i >= prs.size())
+      continue;
+
+    WMOPR & pr = prs[i];
+    if (pr.portal < 0 || (size_t)pr.portal >= pvs.size() ||
+        pr.group < 0 || (uint32)pr.group >= nGroups || onPath[pr.group])
+      continue;
+
+    WMOPV & pv = pvs[pr.portal];
+    Vec3D verts[4] = { pv.a, pv.b, pv.c, pv.d };
+
+    if (!frustum.intersects(verts, 4))
+      continue;
+
+    // narrow view to what can be seen through the portal, and through all portals leading to it
+    Frustum portalFrustum;
+    if (portalFrustum.fromPortal(m_viewFrustum.eye, verts, 4))
+    {
+      portalFrustum.clip(frustum);
+      if (portalFrustum.intersects(groups[pr.group].vmin, groups[pr.group].vmax))
+        traversePortals(pr.group, portalFrustum, onPath, depth + 1);
+    }
+    else // camera stands in portal plane, keep current view
+    {
+      traversePortals(pr.group, frustum, onPath, depth + 1);
+    }
+  }
+
+  onPath[id] = false;
+}
+
 void WMO::drawSkybox()
 {
 	if (skybox) {
@@ -7,6 +7,7 @@
 
 // Our headers
 #include "displayable.h"
+#include "Frustum.h"
 #include "manager.h"
 #include "ModelManager.h"
 #include "vec3d.h"
@@ -18,6 +19,7 @@
 
 class WMO;
 class WMOGroup;
+class WMOGroupLoader;
 
 class GameFile;
 
@@ -145,6 +147,10 @@ public:
 	void draw();
 	void drawSkybox();
 	void drawPortals();
+
+	// groups that passed frustum / portal culling during last draw, in traversal order
+	std::vector<uint32> visibleGroups;
+	void updateVisibility();
 	
 	void update(int dt);
 
@@ -152,8 +158,34 @@ public:
 	void showDoodadSet(int id);
 	void updateModels();
 
+	// groups are parsed in background and doodads loaded a few per frame, see updateStreaming
+	bool isStreaming() const;
+
+	// true if displayed content changes with global time (animated doodads, skybox)
+	bool isAnimated() const;
+	void requestModel(short dd);
+
   static void flipcc(QString &);
 
+private:
+  static const int MAX_PORTAL_DEPTH = 8;
+  static const int STREAMING_BUDGET_MS = 8; // time spent per frame uploading groups / loading doodads
+
+  WMOGroupLoader * m_groupLoader;
+  std::vector<uint32> m_groupsToUpload;
+  std::vector<short> m_modelsToLoad;
+
+  void updateStreaming();
+  void finishStreaming();
+
+  Frustum m_viewFrustum;
+  WMODoodadBatches m_doodadBatches;
+
+  void drawDoodads();
+
+  int findCameraGroup(const Vec3D & eye);
+  void markGroupVisible(uint32 id);
+  void traversePortals(uint32 id, const Frustum & frustum, std::vector<bool> & onPath, int depth);
 };
 
 #endif
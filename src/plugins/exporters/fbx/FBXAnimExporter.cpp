@@ -67,8 +67,29 @@
 
 void FBXAnimExporter::run()
 {
-  QMutexLocker locker(&m_mutex);
-  ModelAnimation curAnimation = l_model->anims[animID];
+  exportAnimation();
+
+  if (m_semaphore)
+    m_semaphore->release();
+}
+
+void FBXAnimExporter::setValues(FbxString fileVersion, QString fn, QString an, int aIndex,
+                                const FBXHeaders::SkeletonData & skeleton, const FBXHeaders::AnimationData & anim, bool uan)
+{
+  l_fileVersion = fileVersion;
+  srcfileName = fn;
+  animationName = an;
+  animIndex = aIndex;
+  m_skeleton = skeleton;
+  m_anim = anim;
+  useAltNaming = uan;
+}
+
+// Private methods
+//--------------------------------------------------------------------
+
+void FBXAnimExporter::exportAnimation()
+{
   if (srcfileName.isNull() || srcfileName.isEmpty())
   {
     LOG_ERROR << "Unable to get FBX Animation Source Filename.";
@@ -79,11 +100,11 @@ void FBXAnimExporter::run()
   srcfileName = srcfileName.mid(0, srcfileName.lastIndexOf(".fbx"));
   QString srcPath = srcfileName.mid(0, srcfileName.lastIndexOf(SLASH));
   QString justfileName = srcfileName.mid(srcfileName.lastIndexOf(SLASH) + 1);
-  QString anim_name = QString("%1 [%2]").arg(animationName).arg(curAnimation.Index);
-  QString file_name = QString("%1_%5/%2_%3_%4.fbx").arg(srcfileName).arg(justfileName).arg(animationName).arg(curAnimation.Index).arg(wxT("Animations"));
+  QString anim_name = QString("%1 [%2]").arg(animationName).arg(animIndex);
+  QString file_name = QString("%1_%5/%2_%3_%4.fbx").arg(srcfileName).arg(justfileName).arg(animationName).arg(animIndex).arg(wxT("Animations"));
   if (useAltNaming)
   {
-    file_name = QString("%1_%5/%2_%4_%3.fbx").arg(srcfileName).arg(justfileName).arg(animationName).arg(curAnimation.Index).arg(wxT("Animations"));
+    file_name = QString("%1_%5/%2_%4_%3.fbx").arg(srcfileName).arg(justfileName).arg(animationName).arg(animIndex).arg(wxT("Animations"));
   }
   LOG_INFO << "FBX Animation Filename: " << qPrintable(file_name);
   QDir dir(file_name.mid(0, file_name.lastIndexOf('/')));
@@ -131,18 +152,18 @@ void FBXAnimExporter::run()
 
   std::map<int, FbxNode*> l_boneNodes;
   FbxNode* l_skeletonNode = 0;
-  FBXHeaders::createSkeleton(l_model, l_animscene, l_skeletonNode, l_boneNodes);
+  FBXHeaders::createSkeleton(m_skeleton, l_animscene, l_skeletonNode, l_boneNodes);
   //LOG_INFO << "Skeleton created for animation...";
 
   FbxNode* root_node = l_animscene->GetRootNode();
   root_node->AddChild(l_skeletonNode);
   //LOG_INFO << "Skeleton added to root node...";
 
-  FBXHeaders::storeBindPose(l_animscene, l_boneClusters, l_meshNode);
+  FBXHeaders::storeBindPose(l_animscene, l_boneNodes);
   //LOG_INFO << "Skeleton successfully bound...";
 
   // Add this animation to our new FBX file.
-  FBXHeaders::createAnimation(l_model, l_animscene, anim_name, curAnimation, l_boneNodes);
+  FBXHeaders::createAnimation(m_anim, l_animscene, l_boneNodes);
   //LOG_INFO << "Animation successfully created...";
 
   if (!exporter->Export(l_animscene))
@@ -156,16 +177,3 @@ void FBXAnimExporter::run()
   if (lSdkManager)
     lSdkManager->Destroy();
 }
-
-void FBXAnimExporter::setValues(FbxString fileVersion, QString fn, QString an, WoWModel *m, std::vector<FbxCluster*> bc, FbxNode* &meshnode, int aID, bool uan)
-{
-  QMutexLocker locker(&m_mutex);
-  l_fileVersion = fileVersion;
-  srcfileName = fn;
-  animationName = an;
-  l_model = m;
-  l_boneClusters = bc;
-  l_meshNode = meshnode;
-  animID = aID;
-  useAltNaming = uan;
-}
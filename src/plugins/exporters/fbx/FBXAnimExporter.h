@@ -34,7 +34,7 @@
 // Qt
 #include <QString>
 #include <QRunnable>
-#include <QMutex>
+#include <QSemaphore>
 
 // Externals
 #include "fbxsdk.h"
@@ -43,10 +43,7 @@
 
 
 // Current library
-
-
-class WoWModel;
-struct ModelAnimation;
+#include "FBXHeaders.h"
 
 // Namespaces used
 //--------------------------------------------------------------------
@@ -54,6 +51,9 @@ struct ModelAnimation;
 
 // Class Declaration
 //--------------------------------------------------------------------
+// Export one animation in its own fbx file.
+// Each exporter owns its FBX manager / scene and only works on copied skeleton and
+// animation data, so several of them can run in parallel in a QThreadPool.
 class FBXAnimExporter : public QRunnable
 {
 
@@ -66,7 +66,11 @@ class FBXAnimExporter : public QRunnable
 
     // Methods
     void run() override;
-    void setValues(FbxString fileVersion, QString fn, QString an, WoWModel *m, std::vector<FbxCluster*> bc, FbxNode* &meshnode, int aID, bool uan = false);
+    void setValues(FbxString fileVersion, QString fn, QString an, int animIndex,
+                   const FBXHeaders::SkeletonData & skeleton, const FBXHeaders::AnimationData & anim, bool uan = false);
+
+    // released when run() ends, used to limit the number of animations sampled in advance
+    void setSemaphore(QSemaphore * semaphore) { m_semaphore = semaphore; }
 
     // Members
 
@@ -89,17 +93,17 @@ class FBXAnimExporter : public QRunnable
     // Destructors
 
     // Methods
+    void exportAnimation();
 
     // Members
     FbxString l_fileVersion;
     QString srcfileName;
     QString animationName;
-    WoWModel *l_model;
-    std::vector<FbxCluster*> l_boneClusters;
-    FbxNode *l_meshNode;
-    int animID;
+    int animIndex = 0;
+    FBXHeaders::SkeletonData m_skeleton;
+    FBXHeaders::AnimationData m_anim;
     bool useAltNaming = false;
-    mutable QMutex m_mutex;
+    QSemaphore * m_semaphore = 0;
 
     // friend class declarations
 
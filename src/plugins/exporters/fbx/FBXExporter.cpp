@@ -41,6 +41,7 @@
 #include "FBXHeaders.h"
 #include "FBXAnimExporter.h"
 #include "ModelRenderPass.h"
+#include "TextureExporter.h"
 #include "WoWModel.h"
 
 #include "util.h" // SLASH
@@ -337,37 +338,46 @@ void FBXExporter::createAnimations()
 bool FBXExporter::createAnimationFiles()
 {
   int maxThreads = QThread::idealThreadCount();   // Get the ideal number of threads we can run at once. This usually equals the total number of threads in a CPU.
+  if (maxThreads < 1)
+    maxThreads = 1;
   std::map<int, std::wstring> animsMap = m_p_model->getAnimsMap();
 
-  /**** NOTICE! ****//*
-
-  While the QThreadPool code DOES start the FBX animation exporting in threads, the FBX SDK itself is not thread-safe!
-
-  We will have to develop our own threaded wrapper for FBX, or copy the FBX data, or find some other method to make the SDK work in a thread-safe manner before we can re-enable multi-threaded animation exporting.
-  Without doing this, WMV will crash while exporting animations, as the data becomes cross-contaminated, and thus, invalidated.
-
-  *//****         ****/
-
   // If we allow users to set the number of threads WMV can use, we can limit it here. I would recommend using no more than 3/4ths of the total thread count! (Gotta leave some for normal CPU usage...)
   //int allocatedThreads = 5;
   //if (maxThreads > allocatedThreads)
   //  maxThreads = allocatedThreads;
 
-  //LOG_INFO << "Exporting animations with" << maxThreads << "threads...";
-  //QThreadPool::globalInstance()->setMaxThreadCount(maxThreads);   // Use to limit the number of threads we can run at once.
+  LOG_INFO << "Exporting animations with" << maxThreads << "threads...";
+
+  // The FBX SDK is not thread-safe: each FBXAnimExporter creates its own manager and scene,
+  // and works on skeleton / animation data sampled here (bone tracks depend on model state
+  // and global time, they must not be read from worker threads).
+  // Time mode is global to the SDK, so it is set once before starting any worker.
+  FbxTime::SetGlobalTimeMode(FbxTime::eFrames60);
+  FBXHeaders::SkeletonData skeleton = FBXHeaders::skeletonData(m_p_model);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(maxThreads);
+
+  // limit the number of animations sampled but not yet exported
+  QSemaphore pending(2 * maxThreads);
 
   for (auto it : m_animsToExport)
   {
-    QMutexLocker locker(&m_mutex);
     ModelAnimation curAnimation = m_p_model->anims[it];
+    QString animName = QString::fromWCharArray(animsMap[curAnimation.animID].c_str());
+
+    pending.acquire();
+
     FBXAnimExporter *exporter = new FBXAnimExporter();
-    exporter->setValues(m_fileVersion, QString::fromWCharArray(m_filename.c_str()), QString::fromWCharArray(animsMap[curAnimation.animID].c_str()), m_p_model, m_boneClusters, m_p_meshNode, it);
+    exporter->setValues(m_fileVersion, QString::fromWCharArray(m_filename.c_str()), animName, curAnimation.Index, skeleton,
+                        FBXHeaders::animationData(m_p_model, QString("%1 [%2]").arg(animName).arg(curAnimation.Index), curAnimation));
+    exporter->setSemaphore(&pending);
     exporter->setAutoDelete(true);
-    exporter->run();    // Remove this line before adding to the QThreadPool!
-    //QThreadPool::globalInstance()->start(exporter);   // Queue this exporter for threaded execution. Automatically starts the run() function of an FBXAnimExporter when a thread is free.
+    pool.start(exporter);   // Automatically starts the run() function of an FBXAnimExporter when a thread is free.
   }
 
-  //QThreadPool::globalInstance()->waitForDone();   // Don't finish until all the threads have been processed.
+  pool.waitForDone();   // Don't finish until all the threads have been processed.
   return true;
 }
 
@@ -473,8 +483,12 @@ void FBXExporter::createMaterials()
     }
   }
 
+  TextureExporter textures;
   for(auto it : m_texturesToExport)
-    exportGLTexture(it.second, it.first);
+    textures.add(it.second, it.first);
+
+  if (!textures.write())
+    LOG_ERROR << "Error while writing textures";
 }
 
 
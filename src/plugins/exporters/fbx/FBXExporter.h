@@ -118,7 +118,6 @@ class FBXExporter : public ExporterPlugin
     FbxNode           * m_p_skeletonNode;
     QList<WoWModel*>    m_p_attachedModels;
 
-    mutable QMutex m_mutex;
     bool useAltAnimNaming = false;
     FbxString m_fileVersion;
     std::wstring m_filename;
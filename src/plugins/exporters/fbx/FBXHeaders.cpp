@@ -183,23 +183,43 @@ FbxNode * FBXHeaders::createMesh(FbxManager* &l_manager, FbxScene* &l_scene, WoW
   return meshNode;
 }
 
+FBXHeaders::SkeletonData FBXHeaders::skeletonData(WoWModel * model)
+{
+  SkeletonData result;
+  result.name = model->name();
+  result.bones.resize(model->bones.size());
+
+  for (size_t i = 0; i < model->bones.size(); ++i)
+  {
+    result.bones[i].parent = model->bones[i].parent;
+    result.bones[i].pivot = model->bones[i].pivot;
+  }
+
+  return result;
+}
+
 void FBXHeaders::createSkeleton(WoWModel * l_model, FbxScene *& l_scene, FbxNode *& l_skeletonNode, std::map<int, FbxNode*>& l_boneNodes)
 {
-  l_skeletonNode = FbxNode::Create(l_scene, qPrintable(QString::fromWCharArray(wxT("%1_rig")).arg(l_model->name())));
+  createSkeleton(skeletonData(l_model), l_scene, l_skeletonNode, l_boneNodes);
+}
+
+void FBXHeaders::createSkeleton(const SkeletonData & skeleton, FbxScene *& l_scene, FbxNode *& l_skeletonNode, std::map<int, FbxNode*>& l_boneNodes)
+{
+  l_skeletonNode = FbxNode::Create(l_scene, qPrintable(QString::fromWCharArray(wxT("%1_rig")).arg(skeleton.name)));
   FbxSkeleton* bone_group_skeleton_attribute = FbxSkeleton::Create(l_scene, "");
   bone_group_skeleton_attribute->SetSkeletonType(FbxSkeleton::eRoot);
   bone_group_skeleton_attribute->Size.Set(10.0 * SCALE_FACTOR);
   l_skeletonNode->SetNodeAttribute(bone_group_skeleton_attribute);
 
   std::vector<FbxSkeleton::EType> bone_types;
-  size_t num_of_bones = l_model->bones.size();
+  size_t num_of_bones = skeleton.bones.size();
 
   // Set bone type.
   std::vector<bool> has_children;
   has_children.resize(num_of_bones);
   for (size_t i = 0; i < num_of_bones; ++i)
   {
-    Bone bone = l_model->bones[i];
+    const BoneData & bone = skeleton.bones[i];
     if (bone.parent != -1)
       has_children[bone.parent] = true;
   }
@@ -207,7 +227,7 @@ void FBXHeaders::createSkeleton(WoWModel * l_model, FbxScene *& l_scene, FbxNode
   bone_types.resize(num_of_bones);
   for (size_t i = 0; i < num_of_bones; ++i)
   {
-    Bone bone = l_model->bones[i];
+    const BoneData & bone = skeleton.bones[i];
 
     if (bone.parent == -1)
     {
@@ -226,14 +246,14 @@ void FBXHeaders::createSkeleton(WoWModel * l_model, FbxScene *& l_scene, FbxNode
   // Create bone.
   for (size_t i = 0; i < num_of_bones; ++i)
   {
-    Bone &bone = l_model->bones[i];
+    const BoneData & bone = skeleton.bones[i];
     Vec3D trans = bone.pivot;
 
     int pid = bone.parent;
     if (pid > -1)
-      trans -= l_model->bones[pid].pivot;
+      trans -= skeleton.bones[pid].pivot;
 
-    FbxString bone_name(qPrintable(l_model->name()));
+    FbxString bone_name(qPrintable(skeleton.name));
     bone_name += "_bone_";
     bone_name += static_cast<int>(i);
 
@@ -287,6 +307,17 @@ void FBXHeaders::storeBindPose(FbxScene* &l_scene, std::vector<FbxCluster*> l_bo
   l_scene->AddPose(pose);
 }
 
+void FBXHeaders::storeBindPose(FbxScene* &l_scene, std::map<int, FbxNode*> &l_boneNodes)
+{
+  FbxPose* pose = FbxPose::Create(l_scene, "Bind Pose");
+  pose->SetIsBindPose(true);
+
+  for (auto it : l_boneNodes)
+    pose->Add(it.second, it.second->EvaluateGlobalTransform());
+
+  l_scene->AddPose(pose);
+}
+
 void FBXHeaders::storeRestPose(FbxScene* &l_scene, FbxNode* &l_SkeletonRoot)
 {
   // Not ready yet...
@@ -339,18 +370,12 @@ void FBXHeaders::storeRestPose(FbxScene* &l_scene, FbxNode* &l_SkeletonRoot)
   l_scene->AddPose(pose);
 }
 
-void FBXHeaders::createAnimation(WoWModel * l_model, FbxScene *& l_scene, QString animName, ModelAnimation cur_anim, std::map<int, FbxNode*>& skeleton)
+FBXHeaders::AnimationData FBXHeaders::animationData(WoWModel * l_model, QString animName, const ModelAnimation & cur_anim)
 {
-  if (skeleton.empty())
-  {
-    LOG_ERROR << "No bones in skeleton, so animation will not be exported";
-    return;
-  }
+  AnimationData result;
+  result.name = animName;
 
-  // Animation stack and layer.
-  FbxAnimStack* anim_stack = FbxAnimStack::Create(l_scene, qPrintable(animName));
-  FbxAnimLayer* anim_layer = FbxAnimLayer::Create(l_scene, qPrintable(animName));
-  anim_stack->AddMember(anim_layer);
+  l_model->loadAnimation(cur_anim.Index);
 
   //LOG_INFO << "Animation length:" << cur_anim.length;
   float timeInc = cur_anim.length / 60;
@@ -358,34 +383,31 @@ void FBXHeaders::createAnimation(WoWModel * l_model, FbxScene *& l_scene, QStrin
   {
     timeInc = cur_anim.length;
   }
-  FbxTime::SetGlobalTimeMode(FbxTime::eFrames60);
-  //LOG_INFO << "Skeleton Bone count:" << skeleton.size();
 
-  //LOG_INFO << "Starting frame loop...";
   for (uint32 t = 0; t < cur_anim.length; t += timeInc)
+    result.times.push_back(t);
+
+  for (size_t b = 0; b < l_model->bones.size(); b++)
   {
-    //LOG_INFO << "Starting frame" << t;
-    FbxTime time;
-    time.SetSecondDouble((float)t / 1000.0);
+    Bone& bone = l_model->bones[b];
 
-    for (auto it : skeleton)
-    {
-      int b = it.first;
-      Bone& bone = l_model->bones[b];
+    BoneTrack track;
+    track.bone = (int)b;
+    track.rot = bone.rot.uses(cur_anim.Index);
+    track.scale = bone.scale.uses(cur_anim.Index);
+    track.trans = bone.trans.uses(cur_anim.Index);
 
-      bool rot = bone.rot.uses(cur_anim.Index);
-      bool scale = bone.scale.uses(cur_anim.Index);
-      bool trans = bone.trans.uses(cur_anim.Index);
+    if (!track.rot && !track.scale && !track.trans) // bone is not animated, skip it
+      continue;
 
-      if (!rot && !scale && !trans) // bone is not animated, skip it
-        continue;
+    track.transLinear = (bone.trans.type == INTERPOLATION_LINEAR);
+    track.rotLinear = (bone.rot.type == INTERPOLATION_LINEAR);
+    track.scaleLinear = (bone.scale.type == INTERPOLATION_LINEAR);
 
-      if (trans)
+    for (auto t : result.times)
+    {
+      if (track.trans)
       {
-        FbxAnimCurve* t_curve_x = skeleton[b]->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true);
-        FbxAnimCurve* t_curve_y = skeleton[b]->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true);
-        FbxAnimCurve* t_curve_z = skeleton[b]->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true);
-
         Vec3D v = bone.trans.getValue(cur_anim.Index, t);
 
         if (bone.parent != -1)
@@ -394,90 +416,97 @@ void FBXHeaders::createAnimation(WoWModel * l_model, FbxScene *& l_scene, QStrin
           v += (bone.pivot - parent_bone.pivot);
         }
 
-        t_curve_x->KeyModifyBegin();
-        int key_index = t_curve_x->KeyAdd(time);
-        t_curve_x->KeySetValue(key_index, v.x * SCALE_FACTOR);
-        t_curve_x->KeySetInterpolation(key_index, bone.trans.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        t_curve_x->KeyModifyEnd();
-
-        t_curve_y->KeyModifyBegin();
-        key_index = t_curve_y->KeyAdd(time);
-        t_curve_y->KeySetValue(key_index, v.y * SCALE_FACTOR);
-        t_curve_y->KeySetInterpolation(key_index, bone.trans.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        t_curve_y->KeyModifyEnd();
-
-        t_curve_z->KeyModifyBegin();
-        key_index = t_curve_z->KeyAdd(time);
-        t_curve_z->KeySetValue(key_index, v.z * SCALE_FACTOR);
-        t_curve_z->KeySetInterpolation(key_index, bone.trans.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        t_curve_z->KeyModifyEnd();
+        track.transKeys.push_back(v);
       }
 
-      if (rot)
+      if (track.rot)
       {
-        FbxAnimCurve* r_curve_x = skeleton[b]->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true);
-        FbxAnimCurve* r_curve_y = skeleton[b]->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true);
-        FbxAnimCurve* r_curve_z = skeleton[b]->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true);
-
-        float x, y, z;
-
         Quaternion q = bone.rot.getValue(cur_anim.Index, t);
         Quaternion tq;
         tq.x = q.w; tq.y = q.x; tq.z = q.y; tq.w = q.z;
 
         Vec3D rot = tq.toEulerXYZ();
-
-        x = rot.x * -(180.0f / PI);
-        y = rot.y * -(180.0f / PI);
-        z = rot.z * -(180.0f / PI);
-
-        r_curve_x->KeyModifyBegin();
-        int key_index = r_curve_x->KeyAdd(time);
-        r_curve_x->KeySetValue(key_index, x);
-        r_curve_x->KeySetInterpolation(key_index, bone.rot.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        r_curve_x->KeyModifyEnd();
-
-        r_curve_y->KeyModifyBegin();
-        key_index = r_curve_y->KeyAdd(time);
-        r_curve_y->KeySetValue(key_index, y);
-        r_curve_y->KeySetInterpolation(key_index, bone.rot.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        r_curve_y->KeyModifyEnd();
-
-        r_curve_z->KeyModifyBegin();
-        key_index = r_curve_z->KeyAdd(time);
-        r_curve_z->KeySetValue(key_index, z);
-        r_curve_z->KeySetInterpolation(key_index, bone.rot.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        r_curve_z->KeyModifyEnd();
+        track.rotKeys.push_back(rot * -(180.0f / PI));
       }
 
-      if (scale)
-      {
-        FbxAnimCurve* s_curve_x = skeleton[b]->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true);
-        FbxAnimCurve* s_curve_y = skeleton[b]->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true);
-        FbxAnimCurve* s_curve_z = skeleton[b]->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true);
-
-        Vec3D v = bone.scale.getValue(cur_anim.Index, t);
-
-        s_curve_x->KeyModifyBegin();
-        int key_index = s_curve_x->KeyAdd(time);
-        s_curve_x->KeySetValue(key_index, v.x);
-        s_curve_x->KeySetInterpolation(key_index, bone.scale.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        s_curve_x->KeyModifyEnd();
-
-        s_curve_y->KeyModifyBegin();
-        key_index = s_curve_y->KeyAdd(time);
-        s_curve_y->KeySetValue(key_index, v.y);
-        s_curve_y->KeySetInterpolation(key_index, bone.scale.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        s_curve_y->KeyModifyEnd();
-
-        s_curve_z->KeyModifyBegin();
-        key_index = s_curve_z->KeyAdd(time);
-        s_curve_z->KeySetValue(key_index, v.z);
-        s_curve_z->KeySetInterpolation(key_index, bone.scale.type == INTERPOLATION_LINEAR ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
-        s_curve_z->KeyModifyEnd();
-      }
+      if (track.scale)
+        track.scaleKeys.push_back(bone.scale.getValue(cur_anim.Index, t));
+    }
+
+    result.tracks.push_back(track);
+  }
+
+  return result;
+}
+
+void FBXHeaders::createAnimation(WoWModel * l_model, FbxScene *& l_scene, QString animName, ModelAnimation cur_anim, std::map<int, FbxNode*>& skeleton)
+{
+  createAnimation(animationData(l_model, animName, cur_anim), l_scene, skeleton);
+}
+
+namespace
+{
+  void addKeys(FbxAnimCurve * curve, const std::vector<uint32> & times, const std::vector<Vec3D> & values, size_t component, float factor, bool linear)
+  {
+    curve->KeyModifyBegin();
+    for (size_t i = 0; i < times.size() && i < values.size(); i++)
+    {
+      FbxTime time;
+      time.SetSecondDouble((float)times[i] / 1000.0);
+
+      const Vec3D & v = values[i];
+      float value = (component == 0) ? v.x : ((component == 1) ? v.y : v.z);
+
+      int key_index = curve->KeyAdd(time);
+      curve->KeySetValue(key_index, value * factor);
+      curve->KeySetInterpolation(key_index, linear ? FbxAnimCurveDef::eInterpolationLinear : FbxAnimCurveDef::eInterpolationCubic);
     }
+    curve->KeyModifyEnd();
+  }
+}
 
-    //LOG_INFO << "Ended frame" << t;
+void FBXHeaders::createAnimation(const AnimationData & anim, FbxScene *& l_scene, std::map<int, FbxNode*>& skeleton)
+{
+  if (skeleton.empty())
+  {
+    LOG_ERROR << "No bones in skeleton, so animation will not be exported";
+    return;
+  }
+
+  // Animation stack and layer.
+  FbxAnimStack* anim_stack = FbxAnimStack::Create(l_scene, qPrintable(anim.name));
+  FbxAnimLayer* anim_layer = FbxAnimLayer::Create(l_scene, qPrintable(anim.name));
+  anim_stack->AddMember(anim_layer);
+
+  // NOTE : FbxTime global time mode (eFrames60) is set once by FBXExporter
+  // before any export, it must not be changed from worker threads.
+  for (auto & track : anim.tracks)
+  {
+    auto it = skeleton.find(track.bone);
+    if (it == skeleton.end())
+      continue;
+
+    FbxNode * node = it->second;
+
+    if (track.trans)
+    {
+      addKeys(node->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true), anim.times, track.transKeys, 0, SCALE_FACTOR, track.transLinear);
+      addKeys(node->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true), anim.times, track.transKeys, 1, SCALE_FACTOR, track.transLinear);
+      addKeys(node->LclTranslation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true), anim.times, track.transKeys, 2, SCALE_FACTOR, track.transLinear);
+    }
+
+    if (track.rot)
+    {
+      addKeys(node->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true), anim.times, track.rotKeys, 0, 1.0f, track.rotLinear);
+      addKeys(node->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true), anim.times, track.rotKeys, 1, 1.0f, track.rotLinear);
+      addKeys(node->LclRotation.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true), anim.times, track.rotKeys, 2, 1.0f, track.rotLinear);
+    }
+
+    if (track.scale)
+    {
+      addKeys(node->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_X, true), anim.times, track.scaleKeys, 0, 1.0f, track.scaleLinear);
+      addKeys(node->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Y, true), anim.times, track.scaleKeys, 1, 1.0f, track.scaleLinear);
+      addKeys(node->LclScaling.GetCurve(anim_layer, FBXSDK_CURVENODE_COMPONENT_Z, true), anim.times, track.scaleKeys, 2, 1.0f, track.scaleLinear);
+    }
   }
-}
\ No newline at end of file
+}
@@ -29,6 +29,8 @@
 // Includes / class Declarations
 //--------------------------------------------------------------------
 // STL
+#include <map>
+#include <vector>
 
 // Qt
 #include <qmutex.h>
@@ -56,12 +58,49 @@
 
 namespace FBXHeaders
 {
+  // Plain copies of skeleton and sampled animation data.
+  // They don't reference the model anymore, so they can be used to build scenes from worker threads.
+  struct BoneData
+  {
+    int parent;
+    Vec3D pivot;
+  };
+
+  struct SkeletonData
+  {
+    QString name;
+    std::vector<BoneData> bones;
+  };
+
+  struct BoneTrack
+  {
+    int bone;
+    bool trans, rot, scale;
+    bool transLinear, rotLinear, scaleLinear;
+    std::vector<Vec3D> transKeys; // local translation, parent pivot offset included
+    std::vector<Vec3D> rotKeys;   // euler angles in degrees
+    std::vector<Vec3D> scaleKeys;
+  };
+
+  struct AnimationData
+  {
+    QString name;
+    std::vector<uint32> times; // in ms, one entry per key of each track
+    std::vector<BoneTrack> tracks;
+  };
+
+  SkeletonData skeletonData(WoWModel * model);
+  AnimationData animationData(WoWModel * model, QString animName, const ModelAnimation & cur_anim);
+
   bool createFBXHeaders(FbxString fileVersion, QString l_FileName, FbxManager* &l_Manager, FbxExporter* &l_Exporter, FbxScene* &l_Scene);
   FbxNode* createMesh(FbxManager* &l_manager, FbxScene* &l_scene, WoWModel* model, Matrix matix = Matrix::identity(), Vec3D offset = Vec3D());
   void createSkeleton(WoWModel* l_model, FbxScene* &l_scene, FbxNode* &l_skeletonNode, std::map<int, FbxNode*> &l_boneNodes);
+  void createSkeleton(const SkeletonData & skeleton, FbxScene* &l_scene, FbxNode* &l_skeletonNode, std::map<int, FbxNode*> &l_boneNodes);
   void storeBindPose(FbxScene* &l_scene, std::vector<FbxCluster*> l_boneClusters, FbxNode* l_meshNode);
+  void storeBindPose(FbxScene* &l_scene, std::map<int, FbxNode*> &l_boneNodes);
   void storeRestPose(FbxScene* &l_scene, FbxNode* &l_SkeletonRoot);
   void createAnimation(WoWModel *l_model, FbxScene *& l_scene, QString animName, ModelAnimation cur_anim, std::map<int, FbxNode*>& skeleton);
+  void createAnimation(const AnimationData & anim, FbxScene *& l_scene, std::map<int, FbxNode*>& skeleton);
 }
 
 // static members definition
@@ -0,0 +1,751 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * GLBExporter.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#define _GLBEXPORTER_CPP_
+#include "GLBExporter.h"
+#undef _GLBEXPORTER_CPP_
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+#include <algorithm>
+#include <cstddef>
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QtEndian>
+
+// Externals
+
+// Other libraries
+#include "AnimationBaker.h"
+#include "Bone.h"
+#include "ModelRenderPass.h"
+#include "TextureExporter.h"
+#include "WoWModel.h"
+
+#include "GlobalSettings.h"
+#include "logger/Logger.h"
+
+// Current library
+
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+// Beginning of implementation
+//--------------------------------------------------------------------
+namespace
+{
+  // glTF constants
+  const int GL_TARGET_ARRAY_BUFFER = 34962;
+  const int GL_TARGET_ELEMENT_ARRAY_BUFFER = 34963;
+  const int GL_TYPE_UNSIGNED_BYTE = 5121;
+  const int GL_TYPE_UNSIGNED_INT = 5125;
+  const int GL_TYPE_FLOAT = 5126;
+
+  const quint32 GLB_MAGIC = 0x46546C67; // "glTF"
+  const quint32 GLB_VERSION = 2;
+  const quint32 GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+  const quint32 GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+  // animations are resampled at this rate (samples per second)
+  const uint32 ANIMATION_SAMPLE_RATE = 30;
+
+  size_t align4(size_t value)
+  {
+    return (value + 3) & ~(size_t)3;
+  }
+
+  QJsonArray toJson(const Vec3D & v)
+  {
+    QJsonArray result;
+    result.append(v.x);
+    result.append(v.y);
+    result.append(v.z);
+    return result;
+  }
+
+  bool writeUInt32(QFile & file, quint32 value)
+  {
+    quint32 le = qToLittleEndian(value);
+    return file.write(reinterpret_cast<const char *>(&le), sizeof(le)) == sizeof(le);
+  }
+}
+
+// Constructors
+//--------------------------------------------------------------------
+GLBExporter::GLBExporter()
+{
+  m_canExportAnimation = true;
+  reset();
+}
+
+// Destructor
+//--------------------------------------------------------------------
+
+// Public methods
+//--------------------------------------------------------------------
+std::wstring GLBExporter::menuLabel() const
+{
+  return L"GLB...";
+}
+
+std::wstring GLBExporter::fileSaveTitle() const
+{
+  return L"Save GLB file";
+}
+
+std::wstring GLBExporter::fileSaveFilter() const
+{
+  return L"glTF binary files (*.glb)|*.glb";
+}
+
+bool GLBExporter::exportModel(Model * m, std::wstring target)
+{
+  WoWModel * model = dynamic_cast<WoWModel *>(m);
+
+  if(!model)
+    return false;
+
+  reset();
+  m_filename = QString::fromStdWString(target);
+
+  LOG_INFO << "Exporting" << model->modelname.c_str() << "in" << m_filename;
+
+  // model space is rotated the same way obj exporter does (model facing +z)
+  QJsonObject root;
+  root["name"] = QFileInfo(QString::fromStdString(model->modelname)).completeBaseName();
+  QJsonArray rotation;
+  rotation.append(0.0);
+  rotation.append(-0.70710678);
+  rotation.append(0.0);
+  rotation.append(0.70710678);
+  root["rotation"] = rotation;
+  m_rootNode = addNode(root);
+
+  const bool skinned = !model->bones.empty();
+
+  int mesh = exportMesh(model, skinned);
+  if (mesh == -1)
+  {
+    LOG_ERROR << "Nothing to export for model" << model->modelname.c_str();
+    return false;
+  }
+
+  QJsonObject meshNode;
+  meshNode["name"] = root["name"].toString() + "_mesh";
+  meshNode["mesh"] = mesh;
+  int meshNodeId = addNode(meshNode);
+  addChild(m_rootNode, meshNodeId);
+
+  if (skinned)
+    exportSkeleton(model, meshNodeId);
+
+  if (!GLOBALSETTINGS.bInitPoseOnlyExport)
+    exportAttachedItems(model);
+
+  if (skinned)
+    exportAnimations(model);
+
+  LOG_INFO << "nb textures to export :" << m_texturesToExport.size();
+
+  TextureExporter textures;
+  for (auto it : m_texturesToExport)
+    textures.add(it.second, it.first);
+
+  bool result = writeFile(m_filename);
+
+  if (!textures.write())
+    LOG_ERROR << "Error while writing textures";
+
+  // release json and sampled data
+  reset();
+
+  return result;
+}
+
+// Protected methods
+//--------------------------------------------------------------------
+
+// Private methods
+//--------------------------------------------------------------------
+void GLBExporter::reset()
+{
+  m_binary.clear();
+  m_binarySize = 0;
+  m_ownedData.clear();
+  m_nodes.clear();
+  m_rootNode = -1;
+  m_boneNodes.clear();
+  m_bufferViews = QJsonArray();
+  m_accessors = QJsonArray();
+  m_meshes = QJsonArray();
+  m_materials = QJsonArray();
+  m_textures = QJsonArray();
+  m_images = QJsonArray();
+  m_skins = QJsonArray();
+  m_animations = QJsonArray();
+  m_useUnlit = false;
+  m_materialIds.clear();
+  m_textureIds.clear();
+  m_texturesToExport.clear();
+}
+
+size_t GLBExporter::addBinary(const void * data, size_t size)
+{
+  BinarySegment segment;
+  segment.data = static_cast<const char *>(data);
+  segment.size = size;
+  segment.offset = align4(m_binarySize);
+  m_binary.push_back(segment);
+
+  m_binarySize = segment.offset + size;
+
+  return segment.offset;
+}
+
+size_t GLBExporter::addBinary(const std::vector<float> & data)
+{
+  m_ownedData.push_back(data);
+  return addBinary(m_ownedData.back().data(), data.size() * sizeof(float));
+}
+
+int GLBExporter::addBufferView(size_t offset, size_t length, size_t stride, int target)
+{
+  QJsonObject view;
+  view["buffer"] = 0;
+  view["byteOffset"] = (double)offset;
+  view["byteLength"] = (double)length;
+  if (stride)
+    view["byteStride"] = (double)stride;
+  if (target)
+    view["target"] = target;
+
+  m_bufferViews.append(view);
+  return m_bufferViews.size() - 1;
+}
+
+int GLBExporter::addAccessor(int bufferView, size_t offset, int componentType, size_t count, const QString & type,
+                             bool normalized, const QJsonArray & min, const QJsonArray & max)
+{
+  QJsonObject accessor;
+  accessor["bufferView"] = bufferView;
+  if (offset)
+    accessor["byteOffset"] = (double)offset;
+  accessor["componentType"] = componentType;
+  if (normalized)
+    accessor["normalized"] = true;
+  accessor["count"] = (double)count;
+  accessor["type"] = type;
+  if (!min.isEmpty())
+    accessor["min"] = min;
+  if (!max.isEmpty())
+    accessor["max"] = max;
+
+  m_accessors.append(accessor);
+  return m_accessors.size() - 1;
+}
+
+int GLBExporter::addNode(const QJsonObject & node)
+{
+  m_nodes.push_back(node);
+  return (int)m_nodes.size() - 1;
+}
+
+void GLBExporter::addChild(int parent, int child)
+{
+  QJsonArray children = m_nodes[parent]["children"].toArray();
+  children.append(child);
+  m_nodes[parent]["children"] = children;
+}
+
+int GLBExporter::exportMesh(WoWModel * model, bool skinned)
+{
+  static_assert(sizeof(ModelVertex) % 4 == 0, "vertex stride must be a multiple of 4 bytes");
+
+  const size_t nbVertices = model->origVertices.size();
+  const size_t nbIndices = model->indices.size();
+
+  if (nbVertices == 0 || nbIndices == 0)
+    return -1;
+
+  // vertices and indices are referenced in place: one interleaved buffer view over
+  // model vertices, one over model indices shared by all primitives
+  const size_t vertexSize = nbVertices * sizeof(ModelVertex);
+  int vertexView = addBufferView(addBinary(model->origVertices.data(), vertexSize), vertexSize,
+                                 sizeof(ModelVertex), GL_TARGET_ARRAY_BUFFER);
+
+  const size_t indexSize = nbIndices * sizeof(uint32);
+  int indexView = addBufferView(addBinary(model->indices.data(), indexSize), indexSize,
+                                0, GL_TARGET_ELEMENT_ARRAY_BUFFER);
+
+  Vec3D min = model->origVertices[0].pos;
+  Vec3D max = min;
+  for (auto & v : model->origVertices)
+  {
+    min.x = std::min(min.x, v.pos.x); max.x = std::max(max.x, v.pos.x);
+    min.y = std::min(min.y, v.pos.y); max.y = std::max(max.y, v.pos.y);
+    min.z = std::min(min.z, v.pos.z); max.z = std::max(max.z, v.pos.z);
+  }
+
+  QJsonObject attributes;
+  attributes["POSITION"] = addAccessor(vertexView, offsetof(ModelVertex, pos), GL_TYPE_FLOAT, nbVertices, "VEC3",
+                                       false, toJson(min), toJson(max));
+  attributes["NORMAL"] = addAccessor(vertexView, offsetof(ModelVertex, normal), GL_TYPE_FLOAT, nbVertices, "VEC3");
+  attributes["TEXCOORD_0"] = addAccessor(vertexView, offsetof(ModelVertex, texcoords), GL_TYPE_FLOAT, nbVertices, "VEC2");
+  if (skinned)
+  {
+    attributes["JOINTS_0"] = addAccessor(vertexView, offsetof(ModelVertex, bones), GL_TYPE_UNSIGNED_BYTE, nbVertices, "VEC4");
+    attributes["WEIGHTS_0"] = addAccessor(vertexView, offsetof(ModelVertex, weights), GL_TYPE_UNSIGNED_BYTE, nbVertices, "VEC4", true);
+  }
+
+  QJsonArray primitives;
+  for (size_t i=0; i<model->passes.size(); i++)
+  {
+    ModelRenderPass * p = model->passes[i];
+
+    if (!p->init())
+      continue;
+
+    ModelGeosetHD * geoset = model->geosets[p->geoIndex];
+    if (geoset->icount == 0)
+      continue;
+
+    QJsonObject primitive;
+    primitive["attributes"] = attributes;
+    primitive["indices"] = addAccessor(indexView, geoset->istart * sizeof(uint32), GL_TYPE_UNSIGNED_INT, geoset->icount, "SCALAR");
+    primitive["material"] = exportMaterial(model, p);
+    primitives.append(primitive);
+  }
+
+  if (primitives.isEmpty())
+    return -1;
+
+  QJsonObject mesh;
+  mesh["name"] = QString::fromStdString(model->modelname);
+  mesh["primitives"] = primitives;
+
+  m_meshes.append(mesh);
+  return m_meshes.size() - 1;
+}
+
+int GLBExporter::exportMaterial(WoWModel * model, ModelRenderPass * p)
+{
+  QString val;
+  val.sprintf("Geoset_%03i", model->geosets[p->geoIndex]->id);
+  QString name = QString(model->modelname.c_str()) + "_" + val;
+  name.replace("\\","_");
+
+  // passes only differing by geoset share their material
+  QString key = QString("%1_%2_%3_%4_%5").arg(model->getGLTexture(p->tex)).arg(p->blendmode).arg(p->cull).arg(p->unlit).arg((quintptr)model);
+  auto it = m_materialIds.find(key);
+  if (it != m_materialIds.end())
+    return it->second;
+
+  QJsonObject pbr;
+  QJsonArray color;
+  color.append(p->ocol.x);
+  color.append(p->ocol.y);
+  color.append(p->ocol.z);
+  color.append(1.0);
+  if (p->ocol.x != 0.0f || p->ocol.y != 0.0f || p->ocol.z != 0.0f)
+    pbr["baseColorFactor"] = color;
+  pbr["metallicFactor"] = 0.0;
+  pbr["roughnessFactor"] = 1.0;
+
+  int texture = exportTexture(model, p);
+  if (texture != -1)
+  {
+    QJsonObject textureInfo;
+    textureInfo["index"] = texture;
+    pbr["baseColorTexture"] = textureInfo;
+  }
+
+  QJsonObject material;
+  material["name"] = name;
+  material["pbrMetallicRoughness"] = pbr;
+
+  if (!p->cull)
+    material["doubleSided"] = true;
+
+  if (p->blendmode == 1) // alpha key
+  {
+    material["alphaMode"] = QString("MASK");
+    material["alphaCutoff"] = 0.5;
+  }
+  else if (p->blendmode > 1)
+  {
+    material["alphaMode"] = QString("BLEND");
+  }
+
+  if (p->unlit)
+  {
+    QJsonObject extensions;
+    extensions["KHR_materials_unlit"] = QJsonObject();
+    material["extensions"] = extensions;
+    m_useUnlit = true;
+  }
+
+  m_materials.append(material);
+  m_materialIds[key] = m_materials.size() - 1;
+
+  return m_materials.size() - 1;
+}
+
+int GLBExporter::exportTexture(WoWModel * model, ModelRenderPass * p)
+{
+  GLuint id = model->getGLTexture(p->tex);
+  if (id == 0)
+    return -1;
+
+  auto it = m_textureIds.find(id);
+  if (it != m_textureIds.end())
+    return it->second;
+
+  // textures are written as png files next to glb file, the same way other exporters do
+  QString texfile = QFileInfo(model->getNameForTex(p->tex)).completeBaseName();
+  QString tex = QFileInfo(m_filename).completeBaseName() + "_" + texfile + ".png";
+  m_texturesToExport[(QFileInfo(m_filename).absolutePath() + "/" + tex).toStdWString()] = id;
+
+  QJsonObject image;
+  image["uri"] = tex;
+  m_images.append(image);
+
+  QJsonObject texture;
+  texture["source"] = m_images.size() - 1;
+  m_textures.append(texture);
+
+  m_textureIds[id] = m_textures.size() - 1;
+
+  return m_textures.size() - 1;
+}
+
+void GLBExporter::exportSkeleton(WoWModel * model, int meshNode)
+{
+  const size_t nbBones = model->bones.size();
+
+  // bones are expressed relative to their parent, rest pose being the pivot position
+  // inverse bind matrix is then a translation by -pivot (column major)
+  std::vector<float> inverseBindMatrices(nbBones * 16, 0.0f);
+  QJsonArray joints;
+
+  for (size_t b = 0; b < nbBones; b++)
+  {
+    Bone & bone = model->bones[b];
+
+    Vec3D translation = bone.pivot;
+    if (bone.parent != -1)
+      translation -= model->bones[bone.parent].pivot;
+
+    QJsonObject node;
+    node["name"] = QString("bone_%1").arg(b);
+    node["translation"] = toJson(translation);
+
+    int nodeId = addNode(node);
+    m_boneNodes.push_back(nodeId);
+    joints.append(nodeId);
+
+    float * mat = &inverseBindMatrices[b * 16];
+    mat[0] = mat[5] = mat[10] = mat[15] = 1.0f;
+    mat[12] = -bone.pivot.x;
+    mat[13] = -bone.pivot.y;
+    mat[14] = -bone.pivot.z;
+  }
+
+  for (size_t b = 0; b < nbBones; b++)
+  {
+    int16 parent = model->bones[b].parent;
+    if (parent >= 0 && (size_t)parent < nbBones)
+      addChild(m_boneNodes[parent], m_boneNodes[b]);
+    else
+      addChild(m_rootNode, m_boneNodes[b]);
+  }
+
+  const size_t size = inverseBindMatrices.size() * sizeof(float);
+  int view = addBufferView(addBinary(inverseBindMatrices), size);
+
+  QJsonObject skin;
+  skin["joints"] = joints;
+  skin["inverseBindMatrices"] = addAccessor(view, 0, GL_TYPE_FLOAT, nbBones, "MAT4");
+  m_skins.append(skin);
+
+  m_nodes[meshNode]["skin"] = m_skins.size() - 1;
+}
+
+void GLBExporter::exportAttachedItems(WoWModel * model)
+{
+  for(WoWModel::iterator it = model->begin();
+      it != model->end();
+      ++it)
+  {
+    std::map<POSITION_SLOTS, WoWModel *> itemModels = (*it)->models();
+    for (auto itemIt : itemModels)
+    {
+      WoWModel * itemModel = itemIt.second;
+      LOG_INFO << "Exporting attached item" << itemModel->modelname.c_str();
+
+      // items are rigid meshes attached to the bone of their attachment point
+      int mesh = exportMesh(itemModel, false);
+      if (mesh == -1)
+        continue;
+
+      int parent = m_rootNode;
+      Vec3D pos;
+
+      int l = model->attLookup[itemIt.first];
+      if (l > -1)
+      {
+        const ModelAttachment & att = model->atts[l];
+        pos = att.pos;
+        if (att.bone >= 0 && (size_t)att.bone < m_boneNodes.size())
+        {
+          parent = m_boneNodes[att.bone];
+          pos -= model->bones[att.bone].pivot;
+        }
+      }
+
+      QJsonObject node;
+      node["name"] = QFileInfo(QString::fromStdString(itemModel->modelname)).completeBaseName();
+      node["mesh"] = mesh;
+      node["translation"] = toJson(pos);
+
+      addChild(parent, addNode(node));
+    }
+  }
+}
+
+void GLBExporter::exportAnimations(WoWModel * model)
+{
+  LOG_INFO << "Num animations to export:" << m_animsToExport.size();
+
+  std::map<int, std::wstring> animsMap = model->getAnimsMap();
+
+  std::vector<AnimationBaker::BakedAnimationPtr> bakedAnims =
+    AnimationBaker::instance().bake(model, m_animsToExport, ANIMATION_SAMPLE_RATE);
+
+  for (auto baked : bakedAnims)
+  {
+    if (!baked)
+      continue;
+
+    const BakedAnimation & anim = *baked;
+    const size_t nbFrames = anim.nbFrames();
+
+    std::vector<float> seconds;
+    seconds.reserve(nbFrames);
+    for (auto t : anim.times)
+      seconds.push_back(t / 1000.0f);
+
+    QJsonArray samplers, channels;
+    int timeAccessor = -1;
+
+    auto addChannel = [&](const std::vector<float> & values, const QString & type, size_t bone, const QString & path)
+    {
+      if (timeAccessor == -1)
+      {
+        QJsonArray min, max;
+        min.append(seconds.front());
+        max.append(seconds.back());
+        const size_t size = seconds.size() * sizeof(float);
+        timeAccessor = addAccessor(addBufferView(addBinary(seconds), size), 0, GL_TYPE_FLOAT, seconds.size(), "SCALAR",
+                                   false, min, max);
+      }
+
+      const size_t size = values.size() * sizeof(float);
+      QJsonObject sampler;
+      sampler["input"] = timeAccessor;
+      sampler["output"] = addAccessor(addBufferView(addBinary(values), size), 0, GL_TYPE_FLOAT, nbFrames, type);
+      sampler["interpolation"] = QString("LINEAR");
+      samplers.append(sampler);
+
+      QJsonObject target;
+      target["node"] = m_boneNodes[bone];
+      target["path"] = path;
+
+      QJsonObject channel;
+      channel["sampler"] = samplers.size() - 1;
+      channel["target"] = target;
+      channels.append(channel);
+    };
+
+    for (size_t b = 0; b < anim.bones.size() && b < m_boneNodes.size(); b++)
+    {
+      const BakedAnimation::BoneInfo & bone = anim.bones[b];
+
+      if (bone.trans)
+      {
+        std::vector<float> values;
+        values.reserve(nbFrames * 3);
+        for (size_t f = 0; f < nbFrames; f++)
+        {
+          const Vec3D & v = anim.translations[anim.index(f, b)];
+          values.push_back(v.x);
+          values.push_back(v.y);
+          values.push_back(v.z);
+        }
+        addChannel(values, "VEC3", b, "translation");
+      }
+
+      if (bone.rot)
+      {
+        // wow matrices are built from the conjugate of animated quaternion
+        std::vector<float> values;
+        values.reserve(nbFrames * 4);
+        for (size_t f = 0; f < nbFrames; f++)
+        {
+          const Quaternion & q = anim.rotations[anim.index(f, b)];
+          values.push_back(-q.x);
+          values.push_back(-q.y);
+          values.push_back(-q.z);
+          values.push_back(q.w);
+        }
+        addChannel(values, "VEC4", b, "rotation");
+      }
+
+      if (bone.scale)
+      {
+        std::vector<float> values;
+        values.reserve(nbFrames * 3);
+        for (size_t f = 0; f < nbFrames; f++)
+        {
+          const Vec3D & v = anim.scales[anim.index(f, b)];
+          values.push_back(v.x);
+          values.push_back(v.y);
+          values.push_back(v.z);
+        }
+        addChannel(values, "VEC3", b, "scale");
+      }
+    }
+
+    if (channels.isEmpty())
+      continue;
+
+    const ModelAnimation & modelAnim = model->anims[anim.anim];
+
+    QJsonObject animation;
+    animation["name"] = QString("%1 [%2]").arg(QString::fromWCharArray(animsMap[modelAnim.animID].c_str())).arg(modelAnim.Index);
+    animation["samplers"] = samplers;
+    animation["channels"] = channels;
+    m_animations.append(animation);
+  }
+}
+
+bool GLBExporter::writeFile(const QString & target) const
+{
+  QJsonObject asset;
+  asset["version"] = QString("2.0");
+  asset["generator"] = QString::fromStdWString(GLOBALSETTINGS.appName()) + " " + QString::fromStdWString(GLOBALSETTINGS.appVersion());
+
+  QJsonArray nodes;
+  for (auto & node : m_nodes)
+    nodes.append(node);
+
+  QJsonArray sceneNodes;
+  sceneNodes.append(m_rootNode);
+  QJsonObject scene;
+  scene["nodes"] = sceneNodes;
+  QJsonArray scenes;
+  scenes.append(scene);
+
+  QJsonObject buffer;
+  buffer["byteLength"] = (double)m_binarySize;
+  QJsonArray buffers;
+  buffers.append(buffer);
+
+  QJsonObject gltf;
+  gltf["asset"] = asset;
+  gltf["scene"] = 0;
+  gltf["scenes"] = scenes;
+  gltf["nodes"] = nodes;
+  gltf["meshes"] = m_meshes;
+  gltf["buffers"] = buffers;
+  gltf["bufferViews"] = m_bufferViews;
+  gltf["accessors"] = m_accessors;
+  if (!m_materials.isEmpty())
+    gltf["materials"] = m_materials;
+  if (!m_textures.isEmpty())
+  {
+    gltf["textures"] = m_textures;
+    gltf["images"] = m_images;
+  }
+  if (!m_skins.isEmpty())
+    gltf["skins"] = m_skins;
+  if (!m_animations.isEmpty())
+    gltf["animations"] = m_animations;
+  if (m_useUnlit)
+  {
+    QJsonArray extensions;
+    extensions.append(QString("KHR_materials_unlit"));
+    gltf["extensionsUsed"] = extensions;
+  }
+
+  QByteArray json = QJsonDocument(gltf).toJson(QJsonDocument::Compact);
+  while (json.size() % 4)
+    json.append(' ');
+
+  const size_t binLength = align4(m_binarySize);
+  const size_t totalLength = 12 + 8 + json.size() + 8 + binLength;
+
+  QFile file(target);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    LOG_ERROR << "Unable to open" << target;
+    return false;
+  }
+
+  bool ok = writeUInt32(file, GLB_MAGIC) &&
+            writeUInt32(file, GLB_VERSION) &&
+            writeUInt32(file, (quint32)totalLength) &&
+            writeUInt32(file, (quint32)json.size()) &&
+            writeUInt32(file, GLB_CHUNK_JSON) &&
+            file.write(json) == json.size() &&
+            writeUInt32(file, (quint32)binLength) &&
+            writeUInt32(file, GLB_CHUNK_BIN);
+
+  // binary chunk is written straight from referenced memory, zero padded between segments
+  static const char padding[4] = { 0, 0, 0, 0 };
+  size_t pos = 0;
+  for (auto it = m_binary.begin(); ok && it != m_binary.end(); ++it)
+  {
+    if (it->offset > pos)
+      ok = file.write(padding, it->offset - pos) == (qint64)(it->offset - pos);
+    ok = ok && file.write(it->data, it->size) == (qint64)it->size;
+    pos = it->offset + it->size;
+  }
+
+  if (ok && binLength > pos)
+    ok = file.write(padding, binLength - pos) == (qint64)(binLength - pos);
+
+  if (!ok)
+    LOG_ERROR << "Error while writing" << target;
+
+  file.close();
+
+  return ok;
+}
@@ -0,0 +1,167 @@
+/*----------------------------------------------------------------------*\
+| This file is part of WoW Model Viewer                                  |
+|                                                                        |
+| WoW Model Viewer is free software: you can redistribute it and/or      |
+| modify it under the terms of the GNU General Public License as         |
+| published by the Free Software Foundation, either version 3 of the     |
+| License, or (at your option) any later version.                        |
+|                                                                        |
+| WoW Model Viewer is distributed in the hope that it will be useful,    |
+| but WITHOUT ANY WARRANTY; without even the implied warranty of         |
+| MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          |
+| GNU General Public License for more details.                           |
+|                                                                        |
+| You should have received a copy of the GNU General Public License      |
+| along with WoW Model Viewer.                                           |
+| If not, see <http://www.gnu.org/licenses/>.                            |
+\*----------------------------------------------------------------------*/
+
+
+/*
+ * GLBExporter.h
+ *
+ *  Created on: 19 oct. 2026
+ *   Copyright: 2026 , WoW Model Viewer (http://wowmodelviewer.net)
+ */
+
+#ifndef _GLBEXPORTER_H_
+#define _GLBEXPORTER_H_
+
+// Includes / class Declarations
+//--------------------------------------------------------------------
+// STL
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Qt
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtPlugin>
+
+// Externals
+class ModelRenderPass;
+class WoWModel;
+
+// Other libraries
+#define _EXPORTERPLUGIN_CPP_ // to define interface
+#include "ExporterPlugin.h"
+#undef _EXPORTERPLUGIN_CPP_
+
+// Current library
+
+
+// Namespaces used
+//--------------------------------------------------------------------
+
+
+// Class Declaration
+//--------------------------------------------------------------------
+class GLBExporter : public ExporterPlugin
+{
+    Q_INTERFACES(ExporterPlugin)
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "wowmodelviewer.exporters.GLBExporter" FILE "glbexporter.json")
+
+  public :
+    // Constants / Enums
+
+    // Constructors
+    GLBExporter();
+
+    // Destructors
+    ~GLBExporter() {}
+
+    // Methods
+   std::wstring menuLabel() const;
+
+   std::wstring fileSaveTitle() const;
+   std::wstring fileSaveFilter() const;
+
+   bool exportModel(Model *, std::wstring file);
+
+    // Members
+
+  protected :
+    // Constants / Enums
+
+    // Constructors
+
+    // Destructors
+
+    // Methods
+
+    // Members
+
+  private :
+    // Constants / Enums
+
+    // Constructors
+
+    // Destructors
+
+    // Methods
+    void reset();
+
+    // reference size bytes of data to be written as is in the binary chunk,
+    // memory must stay valid until file is written. Returns offset in binary chunk
+    size_t addBinary(const void * data, size_t size);
+    // same, but data is first copied in a buffer owned by exporter
+    size_t addBinary(const std::vector<float> & data);
+
+    int addBufferView(size_t offset, size_t length, size_t stride = 0, int target = 0);
+    int addAccessor(int bufferView, size_t offset, int componentType, size_t count, const QString & type,
+                    bool normalized = false, const QJsonArray & min = QJsonArray(), const QJsonArray & max = QJsonArray());
+    int addNode(const QJsonObject & node);
+    void addChild(int parent, int child);
+
+    int exportMesh(WoWModel * model, bool skinned);
+    int exportMaterial(WoWModel * model, ModelRenderPass * pass);
+    int exportTexture(WoWModel * model, ModelRenderPass * pass);
+    void exportSkeleton(WoWModel * model, int meshNode);
+    void exportAttachedItems(WoWModel * model);
+    void exportAnimations(WoWModel * model);
+
+    bool writeFile(const QString & file) const;
+
+    // Members
+    struct BinarySegment
+    {
+      const char * data;
+      size_t size;
+      size_t offset;
+    };
+
+    std::vector<BinarySegment> m_binary;
+    size_t m_binarySize;
+    std::list<std::vector<float> > m_ownedData;
+
+    std::vector<QJsonObject> m_nodes;
+    int m_rootNode;
+    std::vector<int> m_boneNodes;
+    QJsonArray m_bufferViews;
+    QJsonArray m_accessors;
+    QJsonArray m_meshes;
+    QJsonArray m_materials;
+    QJsonArray m_textures;
+    QJsonArray m_images;
+    QJsonArray m_skins;
+    QJsonArray m_animations;
+    bool m_useUnlit;
+
+    std::map<QString, int> m_materialIds;
+    std::map<GLuint, int> m_textureIds;
+    std::map<std::wstring, GLuint> m_texturesToExport;
+    QString m_filename;
+
+    // friend class declarations
+
+};
+
+// static members definition
+#ifdef _GLBEXPORTER_CPP_
+
+#endif
+
+#endif /* _GLBEXPORTER_H_ */
@@ -30,6 +30,11 @@
 // Includes / class Declarations
 //--------------------------------------------------------------------
 // STL
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // Qt
 #include <QFileInfo>
@@ -39,6 +44,7 @@
 // Other libraries
 #include "Bone.h"
 #include "ModelRenderPass.h"
+#include "TextureExporter.h"
 #include "WoWModel.h"
 
 #include "GlobalSettings.h"
@@ -52,6 +58,241 @@
 
 // Beginning of implementation
 //--------------------------------------------------------------------
+namespace
+{
+  // powers of ten covering float range and the extra digits asked for
+  const int POW10_MIN = -60;
+  const int POW10_MAX = 60;
+
+  struct Pow10Table
+  {
+    Pow10Table()
+    {
+      for (int i = POW10_MIN; i <= POW10_MAX; i++)
+        values[i - POW10_MIN] = pow(10.0, i);
+    }
+
+    double values[POW10_MAX - POW10_MIN + 1];
+  };
+
+  double powerOf10(int e)
+  {
+    static const Pow10Table table;
+    return table.values[e - POW10_MIN];
+  }
+
+  char * formatUInt(char * out, uint64_t v)
+  {
+    char tmp[24];
+    int n = 0;
+    do
+    {
+      tmp[n++] = '0' + (v % 10);
+      v /= 10;
+    } while (v);
+
+    while (n)
+      *out++ = tmp[--n];
+
+    return out;
+  }
+
+  // Locale free formatting of a float, using the shortest decimal
+  // representation that reads back to the same float (at most 9 digits).
+  // Fixed notation is used unless value is really small or really big.
+  char * formatFloat(char * out, float f)
+  {
+    if (f != f || f == 0.0f || std::isinf(f)) // nothing meaningful to write for nan / inf in obj
+    {
+      *out++ = '0';
+      return out;
+    }
+
+    if (f < 0.0f)
+    {
+      *out++ = '-';
+      f = -f;
+    }
+
+    const double v = f;
+    int e10 = (int)floor(log10(v));
+    if (v < powerOf10(e10))
+      e10--;
+    else if (v >= powerOf10(e10 + 1))
+      e10++;
+
+    uint64_t mantissa = 0;
+    int p = 1;
+    for (; p <= 9; p++)
+    {
+      double m = floor(v * powerOf10(p - 1 - e10) + 0.5);
+      mantissa = (uint64_t)m;
+      if (p == 9 || (float)(m * powerOf10(e10 - p + 1)) == f)
+        break;
+    }
+
+    char digits[24];
+    int nbDigits = (int)(formatUInt(digits, mantissa) - digits);
+
+    // exponent of first digit, rounding may have added one (9.99 -> 10.0)
+    const int exp = e10 + (nbDigits - p);
+
+    while (nbDigits > 1 && digits[nbDigits - 1] == '0')
+      nbDigits--;
+
+    if (exp < -5 || exp > 15)
+    {
+      *out++ = digits[0];
+      if (nbDigits > 1)
+      {
+        *out++ = '.';
+        memcpy(out, digits + 1, nbDigits - 1);
+        out += nbDigits - 1;
+      }
+      *out++ = 'e';
+      if (exp < 0)
+        *out++ = '-';
+      return formatUInt(out, (exp < 0) ? -exp : exp);
+    }
+
+    if (exp < 0)
+    {
+      *out++ = '0';
+      *out++ = '.';
+      for (int i = -1; i > exp; i--)
+        *out++ = '0';
+      memcpy(out, digits, nbDigits);
+      return out + nbDigits;
+    }
+
+    for (int i = 0; i <= exp; i++)
+      *out++ = (i < nbDigits) ? digits[i] : '0';
+
+    if (nbDigits > exp + 1)
+    {
+      *out++ = '.';
+      memcpy(out, digits + exp + 1, nbDigits - exp - 1);
+      out += nbDigits - exp - 1;
+    }
+
+    return out;
+  }
+
+  // bit exact keys used to share identical obj elements
+  struct Vec3DKey
+  {
+    Vec3DKey(const Vec3D & v) : x(v.x), y(v.y), z(v.z) {}
+    bool operator==(const Vec3DKey & o) const { return memcmp(this, &o, sizeof(Vec3DKey)) == 0; }
+    float x, y, z;
+  };
+
+  struct Vec2DKey
+  {
+    Vec2DKey(const Vec2D & v) : x(v.x), y(v.y) {}
+    bool operator==(const Vec2DKey & o) const { return memcmp(this, &o, sizeof(Vec2DKey)) == 0; }
+    float x, y;
+  };
+
+  template <class T>
+  struct KeyHash
+  {
+    size_t operator()(const T & k) const
+    {
+      const uint32_t * p = reinterpret_cast<const uint32_t *>(&k);
+      size_t h = 2166136261u;
+      for (size_t i = 0; i < sizeof(T) / sizeof(uint32_t); i++)
+        h = (h ^ p[i]) * 16777619u;
+      return h;
+    }
+  };
+
+  // index of value in list, adding it if needed
+  template <class K, class V>
+  int uniqueIndex(std::unordered_map<K, int, KeyHash<K> > & indexes, std::vector<V> & values, const V & v)
+  {
+    auto it = indexes.insert(std::make_pair(K(v), (int)values.size()));
+    if (it.second)
+      values.push_back(v);
+    return it.first->second;
+  }
+}
+
+// buffered output of obj text, flushed to device by big blocks
+class OBJWriter
+{
+  public:
+    explicit OBJWriter(QIODevice & device) : m_device(device), m_ok(true)
+    {
+      m_buffer.reserve(BUFFER_SIZE + 256);
+    }
+
+    ~OBJWriter()
+    {
+      flush();
+    }
+
+    OBJWriter & operator<<(const char * s)
+    {
+      m_buffer.append(s);
+      return check();
+    }
+
+    OBJWriter & operator<<(const QString & s)
+    {
+      m_buffer.append(s.toUtf8().constData());
+      return check();
+    }
+
+    OBJWriter & operator<<(int v)
+    {
+      char tmp[24];
+      char * end = tmp;
+      if (v < 0)
+      {
+        *end++ = '-';
+        end = formatUInt(end, -(int64_t)v);
+      }
+      else
+      {
+        end = formatUInt(end, v);
+      }
+      m_buffer.append(tmp, end - tmp);
+      return check();
+    }
+
+    OBJWriter & operator<<(float v)
+    {
+      char tmp[32];
+      m_buffer.append(tmp, formatFloat(tmp, v) - tmp);
+      return check();
+    }
+
+    bool flush()
+    {
+      if (!m_buffer.empty())
+      {
+        if (m_device.write(m_buffer.data(), m_buffer.size()) != (qint64)m_buffer.size())
+          m_ok = false;
+        m_buffer.clear();
+      }
+      return m_ok;
+    }
+
+  private:
+    static const size_t BUFFER_SIZE = 4 * 1024 * 1024;
+
+    OBJWriter & check()
+    {
+      if (m_buffer.size() >= BUFFER_SIZE)
+        flush();
+      return *this;
+    }
+
+    QIODevice & m_device;
+    std::string m_buffer;
+    bool m_ok;
+};
+
 
 
 // Constructors
@@ -125,7 +366,7 @@ bool OBJExporter::exportModel(Model * m, std::wstring target)
     return false;
   }
 
-  QTextStream obj(&file);
+  OBJWriter obj(file);
   QTextStream mtl(&matFile);
 
   obj << "# Wavefront OBJ exported by " << QString::fromStdWString(GLOBALSETTINGS.appName()) << " " << QString::fromStdWString(GLOBALSETTINGS.appVersion()) << "\n";
@@ -139,16 +380,17 @@ bool OBJExporter::exportModel(Model * m, std::wstring target)
   mtl << "#" << "\n";
   mtl << "\n";
 
-  int counter=1;
+  IndexCounters counters;
+  TextureExporter textures;
 
   // export main model
-  if(!exportModelVertices(model, obj, counter))
+  if(!exportModelVertices(model, obj, counters))
   {
     LOG_ERROR << "Error during obj export for model" << model->modelname.c_str();
     return false;
   }
 
-  if(!exportModelMaterials(model, mtl, matFilename))
+  if(!exportModelMaterials(model, mtl, matFilename, textures))
   {
     LOG_ERROR << "Error during materials export for model" << model->modelname.c_str();
     return false;
@@ -185,13 +427,13 @@ bool OBJExporter::exportModel(Model * m, std::wstring target)
             pos = model->atts[l].pos;
           }
 
-          if(!exportModelVertices(itemModel, obj, counter, m, pos))
+          if(!exportModelVertices(itemModel, obj, counters, m, pos))
           {
             LOG_ERROR << "Error during obj export for model" << itemModel->modelname.c_str();
             return false;
           }
 
-          if(!exportModelMaterials(itemModel, mtl, matFilename))
+          if(!exportModelMaterials(itemModel, mtl, matFilename, textures))
           {
             LOG_ERROR << "Error during materials export for model" << itemModel->modelname.c_str();
             return false;
@@ -201,6 +443,16 @@ bool OBJExporter::exportModel(Model * m, std::wstring target)
     }
   }
 
+  if (!obj.flush())
+  {
+    LOG_ERROR << "Error while writing" << targetFile;
+    return false;
+  }
+
+  // textures shared by main model and items are only written once
+  if (!textures.write())
+    LOG_ERROR << "Error while writing textures";
+
   file.close();
   matFile.close();
 
@@ -212,96 +464,70 @@ bool OBJExporter::exportModel(Model * m, std::wstring target)
 
 // Private methods
 //--------------------------------------------------------------------
-bool OBJExporter::exportModelVertices(WoWModel * model, QTextStream & file, int & counter, Matrix mat, Vec3D pos) const
+bool OBJExporter::exportModelVertices(WoWModel * model, OBJWriter & file, IndexCounters & counters, Matrix mat, Vec3D pos) const
 {
-  bool vertMsg = false;
-  // output all the vertice data
-  int vertics = 0;
+  const bool useAnimatedVertices = (model->animated == true) && (model->vertices) && !GLOBALSETTINGS.bInitPoseOnlyExport;
+  if (useAnimatedVertices)
+    LOG_INFO << "Using Verticies";
+  else
+    LOG_INFO << "Using Original Verticies";
+
+  // each model vertex used by exported passes gets its position / texture coordinate / normal
+  // index, identical values being shared between vertices (seams, several passes on same geoset...)
+  const size_t nbModelVertices = model->origVertices.size();
+  std::vector<int> vertIndex(nbModelVertices, -1), texIndex(nbModelVertices, -1), normalIndex(nbModelVertices, -1);
+
+  std::vector<Vec3D> vertices, normals;
+  std::vector<Vec2D> texcoords;
+  std::unordered_map<Vec3DKey, int, KeyHash<Vec3DKey> > vertLookup, normalLookup;
+  std::unordered_map<Vec2DKey, int, KeyHash<Vec2DKey> > texLookup;
+
   for (size_t i=0; i<model->passes.size(); i++)
   {
     ModelRenderPass * p = model->passes[i];
 
-    if (p->init())
-    {
-      ModelGeosetHD * geoset = model->geosets[p->geoIndex];
-      for (size_t k=0, b=geoset->istart; k<geoset->icount; k++,b++)
-      {
-        uint32 a = model->indices[b];
-        Vec3D vert;
-        if ((model->animated == true) && (model->vertices) && !GLOBALSETTINGS.bInitPoseOnlyExport)
-        {
-          if (vertMsg == false)
-          {
-            LOG_INFO << "Using Verticies";
-            vertMsg = true;
-          }
-          vert = mat * (model->vertices[a] + pos);
-        }
-        else
-        {
-          if (vertMsg == false)
-          {
-            LOG_INFO << "Using Original Verticies";
-            vertMsg = true;
-          }
-          vert = mat * (model->origVertices[a].pos + pos);
-        }
-        MakeModelFaceForwards(vert);
-        vert *= 1.0;
-        QString val;
-        val.sprintf("v %.06f %.06f %.06f",vert.x, vert.y, vert.z);
-        file << val << "\n";
+    if (!p->init())
+      continue;
 
-        vertics ++;
-      }
+    ModelGeosetHD * geoset = model->geosets[p->geoIndex];
+    for (size_t k=0, b=geoset->istart; k<geoset->icount; k++,b++)
+    {
+      uint32 a = model->indices[b];
+      if (vertIndex[a] != -1)
+        continue;
+
+      Vec3D vert;
+      if (useAnimatedVertices)
+        vert = mat * (model->vertices[a] + pos);
+      else
+        vert = mat * (model->origVertices[a].pos + pos);
+      MakeModelFaceForwards(vert);
+
+      Vec2D tc = model->origVertices[a].texcoords;
+      tc.y = 1 - tc.y;
+
+      vertIndex[a] = uniqueIndex(vertLookup, vertices, vert);
+      texIndex[a] = uniqueIndex(texLookup, texcoords, tc);
+      normalIndex[a] = uniqueIndex(normalLookup, normals, model->origVertices[a].normal);
     }
   }
 
-  file << "# " << vertics << " vertices" << "\n" << "\n";
+  // output all the vertice data
+  for (auto & it : vertices)
+    file << "v " << it.x << " " << it.y << " " << it.z << "\n";
+
+  file << "# " << (int)vertices.size() << " vertices" << "\n" << "\n";
   file << "\n";
+
   // output all the texture coordinate data
-  int textures = 0;
-  for (size_t i=0; i<model->passes.size(); i++)
-  {
-    ModelRenderPass * p = model->passes[i];
-    // we don't want to render completely transparent parts
-    if (p->init())
-    {
-      ModelGeosetHD * geoset = model->geosets[p->geoIndex];
-      for (size_t k=0, b=geoset->istart; k<geoset->icount; k++,b++)
-      {
-        uint32 a = model->indices[b];
-        Vec2D tc =  model->origVertices[a].texcoords;
-        QString val;
-        val.sprintf("vt %.06f %.06f", tc.x, 1-tc.y);
-        file << val << "\n";
-        textures ++;
-      }
-    }
-  }
+  for (auto & it : texcoords)
+    file << "vt " << it.x << " " << it.y << "\n";
 
   // output all the vertice normals data
-  int normals = 0;
-  for (size_t i=0; i<model->passes.size(); i++)
-  {
-    ModelRenderPass * p = model->passes[i];
-    if (p->init())
-    {
-      ModelGeosetHD * geoset = model->geosets[p->geoIndex];
-      for (size_t k=0, b=geoset->istart; k<geoset->icount; k++,b++)
-      {
-        uint16 a = model->indices[b];
-        Vec3D n = model->origVertices[a].normal;
-        QString val;
-        val.sprintf("vn %.06f %.06f %.06f", n.x, n.y, n.z);
-        file << val << "\n";
-        normals ++;
-      }
-    }
-  }
+  for (auto & it : normals)
+    file << "vn " << it.x << " " << it.y << " " << it.z << "\n";
 
   file << "\n";
-  uint32 pointnum = 0;
   // Polygon Data
   int triangles_total = 0;
   for (size_t i=0; i<model->passes.size(); i++)
@@ -311,10 +537,6 @@ bool OBJExporter::exportModelVertices(WoWModel * model, QTextStream & file, int
     if (p->init())
     {
       ModelGeosetHD * geoset = model->geosets[p->geoIndex];
-      // Build Vert2Point DB
-      uint16 *Vert2Point = new uint16[geoset->vstart + geoset->vcount];
-      for (uint16 v = geoset->vstart; v<(geoset->vstart + geoset->vcount); v++, pointnum++)
-        Vert2Point[v] = pointnum;
 
       int g = geoset->id;
 
@@ -342,15 +564,17 @@ bool OBJExporter::exportModelVertices(WoWModel * model, QTextStream & file, int
       file << "usemtl " << matName << "\n";
       file << "s 1" << "\n";
       int triangles = 0;
-      for (size_t k=0; k<geoset->icount; k+=3)
+      for (size_t k=0, b=geoset->istart; k+2<geoset->icount; k+=3, b+=3)
       {
-        file << "f ";
-        file << QString("%1/%1/%1 ").arg(counter);
-        counter ++;
-        file << QString("%1/%1/%1 ").arg(counter);
-        counter ++;
-        file << QString("%1/%1/%1\n").arg(counter);
-        counter ++;
+        file << "f";
+        for (size_t v = 0; v < 3; v++)
+        {
+          uint32 a = model->indices[b + v];
+          file << " " << counters.vertex + vertIndex[a]
+               << "/" << counters.texcoord + texIndex[a]
+               << "/" << counters.normal + normalIndex[a];
+        }
+        file << "\n";
         triangles ++;
       }
       file << "# " << triangles << " triangles in group" << "\n" << "\n";
@@ -358,12 +582,16 @@ bool OBJExporter::exportModelVertices(WoWModel * model, QTextStream & file, int
     }
   }
   file << "# " << triangles_total << " triangles total" << "\n" << "\n";
+
+  counters.vertex += vertices.size();
+  counters.texcoord += texcoords.size();
+  counters.normal += normals.size();
+
   return true;
 }
 
-bool OBJExporter::exportModelMaterials(WoWModel * model, QTextStream & file, QString mtlFile) const
+bool OBJExporter::exportModelMaterials(WoWModel * model, QTextStream & file, QString mtlFile, TextureExporter & textures) const
 {
-  std::map<std::wstring, GLuint> texToExport;
 
   for (size_t i=0; i<model->passes.size(); i++)
   {
@@ -410,14 +638,9 @@ bool OBJExporter::exportModelMaterials(WoWModel * model, QTextStream & file, QSt
 
       file << "map_Kd " << tex << "\n";
       tex = QFileInfo(mtlFile).absolutePath() + "\\" + tex;
-      texToExport[tex.toStdWString()] = model->getGLTexture(p->tex);
+      textures.add(model->getGLTexture(p->tex), tex.toStdWString());
     }
   }
 
-  LOG_INFO << "nb textures to export :" << texToExport.size();
-
-  for(auto it : texToExport)
-      exportGLTexture(it.second, it.first);
-
   return true;
 }
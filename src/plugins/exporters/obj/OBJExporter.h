@@ -44,6 +44,8 @@ class WoWModel;
 #undef _EXPORTERPLUGIN_CPP_
 
 // Current library
+class OBJWriter;
+class TextureExporter;
 
 
 // Namespaces used
@@ -97,8 +99,17 @@ class OBJExporter : public ExporterPlugin
 
     // Methods
 
-     bool exportModelVertices(WoWModel * model, QTextStream & file, int & counter, Matrix m = Matrix::identity(), Vec3D pos = Vec3D::nullVec()) const;
-     bool exportModelMaterials(WoWModel * model, QTextStream & file, QString mtlFile) const;
+    // next index (1 based) for each kind of obj element, shared by all exported models
+    struct IndexCounters
+    {
+      IndexCounters() : vertex(1), texcoord(1), normal(1) {}
+      int vertex;
+      int texcoord;
+      int normal;
+    };
+
+     bool exportModelVertices(WoWModel * model, OBJWriter & file, IndexCounters & counters, Matrix m = Matrix::identity(), Vec3D pos = Vec3D::nullVec()) const;
+     bool exportModelMaterials(WoWModel * model, QTextStream & file, QString mtlFile, TextureExporter & textures) const;
 
 
     // Members
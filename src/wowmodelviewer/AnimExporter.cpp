@@ -1,9 +1,20 @@
 
 #include "AnimExporter.h"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include "Attachment.h"
 #include "enums.h"
+#include "FrameSequenceWriter.h"
 #include "globalvars.h"
 #include "Quantize.h"
 
@@ -11,6 +22,8 @@
 
 #include "ximage.h"
 #include "ximagif.h"
+#include "xiofile.h"
+#include "xmemfile.h"
 
 
 IMPLEMENT_CLASS(CAnimationExporter, wxFrame)
@@ -26,6 +39,227 @@ BEGIN_EVENT_TABLE(CAnimationExporter, wxFrame)
 	EVT_CHECKBOX(ID_PNGSEQ,	CAnimationExporter::OnCheck)
 END_EVENT_TABLE()
 
+namespace
+{
+  // gives access to CxImageGIF block encoders, so that frames can be encoded
+  // separately and appended to the file as soon as they are ready
+  class GifBlockEncoder : public CxImageGIF
+  {
+    public:
+      void EncodeStart(CxFile * fp, CxImage * first, const char * comment)
+      {
+        Ghost(first);
+        EncodeHeader(fp);
+        SetLoops(0); // loop indefinitely
+        EncodeLoopExtension(fp);
+        SetComment(comment);
+        EncodeComment(fp);
+      }
+
+      void EncodeFrame(CxFile * fp, CxImage * frame, BYTE disposal)
+      {
+        Ghost(frame);
+        SetDisposalMethod(disposal);
+        EncodeExtension(fp);
+        EncodeBody(fp);
+      }
+  };
+
+  struct GifSettings
+  {
+    size_t width, height;
+    size_t newWidth, newHeight;
+    bool shrink, greyscale, diffuse, transparent;
+    DWORD delay;
+  };
+
+  struct GifFrame
+  {
+    std::vector<unsigned char> pixels; // BGRA, as read back from GL
+    std::vector<BYTE> data;            // encoded GIF blocks
+    bool done;
+  };
+
+  // Writes animated gif frames as they come: first frame gives the global palette and
+  // is handled on caller thread, next ones are quantized and compressed by worker threads
+  // then appended to the file in order. Number of frames in flight is bounded, so memory
+  // used does not depend on animation length.
+  class GifStreamWriter
+  {
+    public:
+      explicit GifStreamWriter(const GifSettings & settings)
+        : m_settings(settings), m_file(0), m_nbFrames(0)
+      {
+        m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+        m_maxFramesInFlight = 2 * m_pool.maxThreadCount();
+      }
+
+      ~GifStreamWriter()
+      {
+        close();
+      }
+
+      bool open(const wxString & filename)
+      {
+#if	defined(_WINDOWS)
+        fopen_s(&m_file, filename.mb_str(), "wb");
+#else
+        m_file = fopen(filename.mb_str(), "wb");
+#endif
+        return m_file != 0;
+      }
+
+      void addFrame(const unsigned char * pixels)
+      {
+        if (m_nbFrames++ == 0)
+        {
+          writeFirstFrame(pixels);
+          return;
+        }
+
+        std::shared_ptr<GifFrame> frame = std::make_shared<GifFrame>();
+        frame->pixels.assign(pixels, pixels + 4 * m_settings.width * m_settings.height);
+        frame->done = false;
+
+        // wait for oldest frame to be written before queuing more
+        if (m_frames.size() >= m_maxFramesInFlight)
+          writeFrames(true);
+
+        m_frames.push_back(frame);
+        m_pool.start(new FrameJob(*this, frame));
+
+        writeFrames(false);
+      }
+
+      void close()
+      {
+        if (!m_file)
+          return;
+
+        m_pool.waitForDone();
+        while (!m_frames.empty())
+          writeFrames(true);
+
+        fputc(';', m_file); // GIF file terminator
+        fclose(m_file);
+        m_file = 0;
+      }
+
+    private:
+      class FrameJob : public QRunnable
+      {
+        public:
+          FrameJob(GifStreamWriter & writer, std::shared_ptr<GifFrame> frame)
+            : m_writer(writer), m_frame(frame) {}
+
+          void run()
+          {
+            CxImage image(0);
+            m_writer.convert(image, &m_frame->pixels[0]);
+            std::vector<unsigned char>().swap(m_frame->pixels);
+
+            CxMemFile mem;
+            mem.Open();
+            GifBlockEncoder encoder;
+            encoder.EncodeFrame(&mem, &image, m_writer.disposal());
+            m_frame->data.assign(mem.GetBuffer(false), mem.GetBuffer(false) + mem.Size());
+
+            QMutexLocker lock(&m_writer.m_mutex);
+            m_frame->done = true;
+            m_writer.m_frameDone.wakeAll();
+          }
+
+        private:
+          GifStreamWriter & m_writer;
+          std::shared_ptr<GifFrame> m_frame;
+      };
+
+      BYTE disposal() const
+      {
+        return m_settings.transparent ? 2 : 0;
+      }
+
+      void resize(CxImage & image, const unsigned char * pixels)
+      {
+        image.CreateFromArray((BYTE *)pixels, (DWORD)m_settings.width, (DWORD)m_settings.height, 32, (DWORD)(m_settings.width * 4), false);
+
+#ifdef _WINDOWS
+        if (m_settings.greyscale)
+          image.GrayScale();
+#endif //_WINDOWS
+
+        if (m_settings.shrink && m_settings.newWidth != m_settings.width && m_settings.newHeight != m_settings.height)
+          image.Resample((long)m_settings.newWidth, (long)m_settings.newHeight, 2);
+      }
+
+      void quantize(CxImage & image)
+      {
+        image.DecreaseBpp(8, m_settings.diffuse, m_palette, 256);
+        image.SetCodecOption(2); // for LZW compression
+
+        if (m_settings.transparent)
+          image.SetTransIndex(image.GetPixelIndex(0, 0));
+
+        image.SetFrameDelay(m_settings.delay);
+      }
+
+      void convert(CxImage & image, const unsigned char * pixels)
+      {
+        resize(image, pixels);
+        quantize(image);
+      }
+
+      void writeFirstFrame(const unsigned char * pixels)
+      {
+        CxImage image(0);
+        resize(image, pixels);
+
+        // global colour palette is optimised for first frame
+        CQuantizer q(256, 8);
+        q.ProcessImage((HANDLE)image.GetDIB());
+        q.SetColorTable(m_palette);
+
+        quantize(image);
+
+        CxIOFile file(m_file);
+        GifBlockEncoder encoder;
+        encoder.EncodeStart(&file, &image, "Exported from WoW Model Viewer");
+        encoder.EncodeFrame(&file, &image, disposal());
+      }
+
+      // append finished frames to the file, in order
+      void writeFrames(bool waitForFirst)
+      {
+        while (!m_frames.empty())
+        {
+          std::shared_ptr<GifFrame> frame = m_frames.front();
+          {
+            QMutexLocker lock(&m_mutex);
+            while (waitForFirst && !frame->done)
+              m_frameDone.wait(&m_mutex);
+            if (!frame->done)
+              return;
+          }
+
+          fwrite(&frame->data[0], 1, frame->data.size(), m_file);
+          m_frames.pop_front();
+          waitForFirst = false;
+        }
+      }
+
+      GifSettings m_settings;
+      RGBQUAD m_palette[256];
+      FILE * m_file;
+      size_t m_nbFrames;
+
+      QThreadPool m_pool;
+      size_t m_maxFramesInFlight;
+      std::deque<std::shared_ptr<GifFrame> > m_frames;
+      QMutex m_mutex;
+      QWaitCondition m_frameDone;
+  };
+}
+
 // This creates our frame and all our objects
 CAnimationExporter::CAnimationExporter(wxWindow* parent, wxWindowID id, const wxString& title, const wxPoint& pos, const wxSize& size, long style)
 {
@@ -69,7 +303,6 @@ void CAnimationExporter::Init(const wxString fn)
 	if (!g_canvas)
 		return;
 
-	m_pPal = NULL;
 	m_fAnimSpeed = 0.0f;
 
 	m_bTransparent = false;
@@ -124,8 +357,6 @@ void CAnimationExporter::CreateGif()
 		return;
 	}
 
-	CxImage **gifImages = NULL;		// Our pointer array of images
-
 	// Reset the state of our GUI objects
 	btnStart->Enable(false);
 	btnCancel->Enable(false);
@@ -210,60 +441,92 @@ void CAnimationExporter::CreateGif()
 	// Size of our buffer to hold the pixel data
 	m_iSize = m_iWidth*m_iHeight*4;	// (width*height*bytesPerPixel)	
 
-	// Create one frame to make our optimal colour palette from.
 	unsigned char *buffer = new unsigned char[m_iSize];
-	gifImages = new CxImage*[m_iTotalFrames];
-
-	for(unsigned int i=0; i<m_iTotalFrames && !m_bPng; i++) {
-		lblCurFrame->SetLabel(wxString::Format(wxT("Current Frame: %i"), i));
-
-		this->Refresh();
-		this->Update();
-
-		CxImage *newImage = new CxImage(0);
-
-		g_canvas->RenderToBuffer();
-
-		glReadPixels(0, 0, (GLsizei)m_iWidth, (GLsizei)m_iHeight, GL_BGRA_EXT, GL_UNSIGNED_BYTE, buffer);
-		newImage->CreateFromArray(buffer, (DWORD)m_iWidth, (DWORD)m_iHeight, 32, (DWORD)(m_iWidth*4), false);
-
-		// not needed due to the code just below, which fixes the issue with particles
-		//g_canvas->model()->animManager->SetTimeDiff(m_iTimeStep);
-		//g_canvas->model()->animManager->Tick(m_iTimeStep);
-
-		if (g_canvas->root)
-			g_canvas->root->tick((float)m_iTimeStep);
-		if (g_canvas->sky)
-			g_canvas->sky->tick((float)m_iTimeStep);
-		
 
-		#ifdef _WINDOWS
-		if (m_bGreyscale)
-			newImage->GrayScale();
-		#endif //_WINDOWS
+	if (!m_bPng) {
+		GifSettings settings;
+		settings.width = m_iWidth;
+		settings.height = m_iHeight;
+		settings.newWidth = m_iNewWidth;
+		settings.newHeight = m_iNewHeight;
+		settings.shrink = m_bShrink;
+		settings.greyscale = m_bGreyscale;
+		settings.diffuse = m_bDiffuse;
+		settings.transparent = m_bTransparent;
+		settings.delay = (DWORD)m_iDelay;
+
+		// Append GIF extension
+		wxString filen = m_strFilename;
+		filen << wxT(".gif");
 
-		if(m_bShrink && m_iNewWidth!=m_iWidth && m_iNewHeight!=m_iHeight)
-			newImage->Resample((long)m_iNewWidth, (long)m_iNewHeight, 2);
+		GifStreamWriter gif(settings);
+		if (!gif.open(filen)) {
+			LOG_ERROR << "Unable to open" << QString::fromWCharArray(filen.c_str()) << "for writing";
+			m_iTotalFrames = 0;
+		}
 
-		// if (Optimise) {
-		if (!m_pPal) {
-			CQuantizer q(256, 8);
-			q.ProcessImage((HANDLE)newImage->GetDIB());
-			m_pPal = (RGBQUAD*) calloc(256*sizeof(RGBQUAD), 1); //This creates our gifs optimised global colour palette
-			q.SetColorTable(m_pPal);
+		// frame N is read back in a pixel buffer while frame N+1 is rendered
+		// (pixel buffers belong to canvas context, pbuffers have their own one)
+		const bool asyncRead = GLEW_ARB_pixel_buffer_object && video.supportFBO;
+		GLuint pbo[2] = { 0, 0 };
+		if (asyncRead) {
+			glGenBuffersARB(2, pbo);
+			for (size_t i = 0; i < 2; i++) {
+				glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[i]);
+				glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, m_iSize, 0, GL_STREAM_READ_ARB);
+			}
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
 		}
 
-		newImage->DecreaseBpp(8, m_bDiffuse, m_pPal, 256);
-		newImage->SetCodecOption(2); // for LZW compression
+		for(unsigned int i=0; i<=m_iTotalFrames; i++) {
+			if (i < m_iTotalFrames) {
+				lblCurFrame->SetLabel(wxString::Format(wxT("Current Frame: %i"), i));
+
+				this->Refresh();
+				this->Update();
+
+				g_canvas->RenderToBuffer();
+
+				if (asyncRead) {
+					glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[i % 2]);
+					glReadPixels(0, 0, (GLsizei)m_iWidth, (GLsizei)m_iHeight, GL_BGRA_EXT, GL_UNSIGNED_BYTE, 0);
+					glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+				} else {
+					glReadPixels(0, 0, (GLsizei)m_iWidth, (GLsizei)m_iHeight, GL_BGRA_EXT, GL_UNSIGNED_BYTE, buffer);
+				}
+
+				// not needed due to the code just below, which fixes the issue with particles
+				//g_canvas->model()->animManager->SetTimeDiff(m_iTimeStep);
+				//g_canvas->model()->animManager->Tick(m_iTimeStep);
+
+				if (g_canvas->root)
+					g_canvas->root->tick((float)m_iTimeStep);
+				if (g_canvas->sky)
+					g_canvas->sky->tick((float)m_iTimeStep);
+
+				if (!asyncRead)
+					gif.addFrame(buffer);
+			}
+
+			// previous frame is ready to be mapped
+			if (asyncRead && i > 0) {
+				glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[(i - 1) % 2]);
+				const unsigned char * pixels = (const unsigned char *)glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+				if (pixels) {
+					gif.addFrame(pixels);
+					glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+				} else {
+					LOG_ERROR << "Unable to read pixels of gif frame" << i - 1;
+				}
+				glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+			}
+		}
 
-		if(m_bTransparent)
-			newImage->SetTransIndex(newImage->GetPixelIndex(0,0));
+		if (asyncRead)
+			glDeleteBuffersARB(2, pbo);
 
-		newImage->SetFrameDelay((DWORD)m_iDelay);
-		
-		gifImages[i] = newImage;
-		
-		// All the memory that we allocate for newImage gets cleared at the end
+		// wait for last frames and finish the file
+		gif.close();
 	}
 
 	//PNG Sequence Exporter, use if Checkbox is true
@@ -318,10 +581,11 @@ void CAnimationExporter::CreateGif()
 		filen << wxT("_") << i << wxT(".png");
 		// @TODO : to repair
 	//	newImage->Save(filen.mb_str(), CXIMAGE_FORMAT_PNG);
-		
-		//gifImages must not be empty
-		gifImages[i] = newImage;
-		// All the memory that we allocate for newImage gets cleared at the end
+
+		// frames are not kept once written
+		wxDELETE(newImage2);
+		newImage->Destroy();
+		wxDELETE(newImage);
 	}
 	wxDELETEA(buffer);
 
@@ -334,56 +598,6 @@ void CAnimationExporter::CreateGif()
 		wxDELETE(g_canvas->rt);
 	}
 #endif
-	if(!m_bPng){
-	// CREATE THE ACTUAL MULTI-IMAGE GIF ANIMATION
-	// ------------------------------------------------------
-	// Create the file and write all the data
-	// Open/Create the file that were going to save to
-
-	// Append GIF extension
-	wxString filen = m_strFilename;
-	filen << wxT(".gif");
-
-	FILE *hFile = NULL;
-#if	defined(_WINDOWS)
-	fopen_s(&hFile, filen.mb_str(), "wb");
-#else
-	hFile = fopen(filen.mb_str(), "wb");
-#endif
-
-	// Set gif options
-	CxImageGIF multiImage;
-	multiImage.SetComment("Exported from WoW Model Viewer");
-	if (m_bTransparent)
-		multiImage.SetDisposalMethod(2);
-	else
-		multiImage.SetDisposalMethod(0);
-	
-	multiImage.SetFrameDelay((DWORD)m_iDelay);
-	multiImage.SetCodecOption(2); // LZW
-	multiImage.SetLoops(0);		// Set the animation to loop indefinately.
-
-	// Create/Compose the animated gif
-	multiImage.Encode(hFile, gifImages, (int)m_iTotalFrames, false);
-
-	// ALL DONE, START THE CLEAN UP
-	// --------------------------------------------------------
-	// Close file
-	fclose(hFile);
-	}
-
-	// Free the memory used by all the images to create the GIF
-	for(unsigned int i=0; i<m_iTotalFrames; i++) {
-		gifImages[i]->Destroy();
-		wxDELETE(gifImages[i]);
-	}
-	wxDELETEA(gifImages);
-
-	// Free memory used by the colour palette
-	if (m_pPal) {
-		free(m_pPal);
-		m_pPal = NULL;
-	}
 
 	LOG_INFO << "GIF Animation successfully created.";
 
@@ -433,7 +647,6 @@ void CAnimationExporter::OnCheck(wxCommandEvent &event)
 	}
 }
 
-#if defined(_WINDOWS)
 void CAnimationExporter::CreateAvi(wxString fn)
 {
 
@@ -467,9 +680,7 @@ void CAnimationExporter::CreateAvi(wxString fn)
 		m_iWidth = g_canvas->rt->nWidth;
 		m_iHeight = g_canvas->rt->nHeight;
 
-		//canvas->rt->BeginRender();
-		//canvas->RenderToBuffer();
-		//rt->BindTexture(); 
+		g_canvas->rt->BeginRender();
 	} else {
 		glReadBuffer(GL_BACK);
 		int screenSize[4];
@@ -486,42 +697,30 @@ void CAnimationExporter::CreateAvi(wxString fn)
 	}
 
 	const ssize_t timeStep = (m_iTotalAnimFrames / m_iTotalFrames);
-	const ssize_t bufSize = m_iWidth*m_iHeight*3;	// (width*height*bytesPerPixel - only 3 for RGB, no alpha)	
-
-	CAVIGenerator AviGen;
-
-	BITMAPINFOHEADER bmHeader;
-	bmHeader.biWidth = (LONG)m_iWidth;
-	bmHeader.biHeight = (LONG)m_iHeight;
-	bmHeader.biSize = sizeof(BITMAPINFOHEADER);
-	bmHeader.biPlanes = 1;
-	bmHeader.biBitCount = 24;
-	bmHeader.biSizeImage = bufSize; 
-	bmHeader.biCompression = BI_RGB;		//BI_RGB means BRG in reality
-	bmHeader.biClrUsed = 0;
-	bmHeader.biClrImportant = 0;
-	bmHeader.biXPelsPerMeter = 0;
-	bmHeader.biYPelsPerMeter = 0;
-	
-	// set our avi config
-	AviGen.SetRate(25);						// set 25fps
-	AviGen.SetBitmapHeader(bmHeader);
-	AviGen.SetFileName(fn.fn_str());
+	const size_t bufSize = m_iWidth*m_iHeight*4;	// (width*height*bytesPerPixel)
+
+	// avi, y4m or png sequence depending on file extension, frames are converted
+	// and written by encoder threads while next ones are rendered
+	QString file = QString::fromWCharArray(fn.c_str());
+	if (!FrameSequenceWriter::canWrite(file))
+		file += ".avi";
 
-	AviGen.InitEngineForWrite((HWND)this->GetParent()->GetHandle());
+	FrameSequenceWriter writer(file, (int)m_iWidth, (int)m_iHeight, 25); // 25fps
+	if (!writer.open())
+		m_iTotalFrames = 0;
 	
 	// Stop our animation
 	g_canvas->model()->animManager->Pause(true);
 	g_canvas->model()->animManager->Stop();
 
-	// Create one frame to make our optimal colour palette from.
 	unsigned char *buffer = new unsigned char[bufSize];
 
-	// Iterate through the frames saving the image to a buffer then writing it to the AVI
+	// Iterate through the frames saving the image to a buffer then queuing it for the writer
 	for(unsigned int i=0; i<m_iTotalFrames; i++) {
 		g_canvas->RenderToBuffer();
-		glReadPixels(0, 0, (GLsizei)m_iWidth, (GLsizei)m_iHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, buffer);
-		AviGen.AddFrame(buffer);
+		glReadPixels(0, 0, (GLsizei)m_iWidth, (GLsizei)m_iHeight, GL_BGRA_EXT, GL_UNSIGNED_BYTE, buffer);
+		if (!writer.addFrame(buffer))
+			break;
 
 		// not needed due to the code just below
 		//g_canvas->model()->animManager->SetTimeDiff(timeStep);
@@ -529,13 +728,16 @@ void CAnimationExporter::CreateAvi(wxString fn)
 
 		// Animate particles
 		if (g_canvas->root)
-			g_canvas->root->tick((float)m_iTimeStep);
+			g_canvas->root->tick((float)timeStep);
 		if (g_canvas->sky)
-			g_canvas->sky->tick((float)m_iTimeStep);
+			g_canvas->sky->tick((float)timeStep);
 	}
 
-	// Release our Avi writing object
-	AviGen.ReleaseEngine();
+	// Wait for encoders and finish the file
+	if (writer.close())
+		LOG_INFO << "Animation successfully exported to" << file << ":" << writer.frameCount() << "frames";
+	else
+		LOG_ERROR << "Unable to export animation to" << file;
 
 	// Clear our pixel data buffer.
 	wxDELETEA(buffer);
@@ -554,11 +756,6 @@ void CAnimationExporter::CreateAvi(wxString fn)
 	video.render = true;
 	g_canvas->InitView();
 }
-#else
-void CAnimationExporter::CreateAvi(wxString)
-{
-}
-#endif
 
 // --
 
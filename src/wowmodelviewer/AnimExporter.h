@@ -4,9 +4,6 @@
 #include <wx/wx.h>
 
 #include "modelcanvas.h"
-#if defined(_WINDOWS)
-#include "AVIGenerator.h"
-#endif
 
 #include "ximage.h" // RGBQUAD
 
@@ -36,7 +33,6 @@ private:
 
 	float m_fAnimSpeed;					// Animation Speed
 	ssize_t m_iTimeStep;				// frame difference between each frame
-	RGBQUAD *m_pPal;
 
 	wxString m_strFilename;				// Filename to save our animated gif into.
 
@@ -63,7 +59,7 @@ public:
 	void CreateGif();
 
 
-	// avi export functions
+	// video export functions (avi, y4m or png sequence)
 	// ------------------------------------------
 	void CreateAvi(wxString fn);
 
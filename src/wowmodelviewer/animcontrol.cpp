@@ -481,28 +481,44 @@ bool AnimControl::UpdateCreatureModel(WoWModel *m)
   // see if this model has skins
   LOG_INFO << "Searching skins for" << m->itemName();
 
-  QString query;
-
-  if (GAMEDIRECTORY.version().contains("7.3"))
-  { 
-    query = QString("SELECT Texture1, Texture2, Texture3, ParticleColorID, "
-                    "CreatureDisplayInfo.ID, CreatureGeosetData FROM CreatureDisplayInfo "
-                    "LEFT JOIN CreatureModelData "
-                    "ON CreatureDisplayInfo.ModelID = CreatureModelData.ID "
-                    "WHERE CreatureModelData.FileID = %1")
-                    .arg( m->gamefile->fileDataId());
-  } 
-  else // BfA:
-  {
-    query = QString("SELECT Texture1, Texture2, Texture3, ParticleColorID, "
-                    "CreatureDisplayInfo.ID FROM CreatureDisplayInfo "
-                    "LEFT JOIN CreatureModelData "
-                    "ON CreatureDisplayInfo.ModelID = CreatureModelData.ID "
-                    "WHERE CreatureModelData.FileID = %1")
-                    .arg( m->gamefile->fileDataId());
-  }
+  // all displays of the model, with their particle colors (columns 5 to 14), in one query
+  bool legion = GAMEDIRECTORY.version().contains("7.3");
+  QString query = QString("SELECT Texture1, Texture2, Texture3, ParticleColorID, CreatureDisplayInfo.ID, "
+                          "ParticleColor.ID, StartColor1, MidColor1, EndColor1, StartColor2, MidColor2, EndColor2, "
+                          "StartColor3, MidColor3, EndColor3%1 FROM CreatureDisplayInfo "
+                          "LEFT JOIN CreatureModelData "
+                          "ON CreatureDisplayInfo.ModelID = CreatureModelData.ID "
+                          "LEFT JOIN ParticleColor "
+                          "ON CreatureDisplayInfo.ParticleColorID = ParticleColor.ID "
+                          "WHERE CreatureModelData.FileID = %2")
+                          .arg(legion ? ", CreatureGeosetData" : "")
+                          .arg( m->gamefile->fileDataId());
 
   sqlResult r = GAMEDATABASE.sqlQuery(query);
+
+  // BfA: geosets of all displays, in one query too
+  std::map<int, std::set<GeosetNum> > displayGeosets;
+  if (!legion && r.valid && !r.values.empty())
+  {
+    QString query2 = QString("SELECT DisplayID, GeosetType, GeosetID "
+                             "FROM CreatureDisplayInfoGeosetData "
+                             "WHERE DisplayID IN (SELECT CreatureDisplayInfo.ID FROM CreatureDisplayInfo "
+                             "LEFT JOIN CreatureModelData "
+                             "ON CreatureDisplayInfo.ModelID = CreatureModelData.ID "
+                             "WHERE CreatureModelData.FileID = %1)")
+                             .arg( m->gamefile->fileDataId());
+    sqlResult r2 = GAMEDATABASE.sqlQuery(query2);
+    if(r2.valid)
+    {
+      for(size_t j = 0 ; j < r2.values.size() ; j++)
+      {
+        int geotype = 100 * (r2.values[j][1].toInt() + 1);
+        int geoid = r2.values[j][2].toInt();
+        if (geoid > 0)
+          displayGeosets[r2.values[j][0].toInt()].insert(geotype + geoid);
+      }
+    }
+  }
   PCRList.clear();
   if(r.valid && !r.values.empty())
   {
@@ -528,14 +544,14 @@ bool AnimControl::UpdateCreatureModel(WoWModel *m)
       // Configure geosets that are switched on only for certain displayIDs.
       // This is handled differently in BfA (has its own table) compared
       // to Legion (compressed into a single integer in CreatureDisplayInfo) :
-      if (GAMEDIRECTORY.version().contains("7.3"))
+      if (legion)
       {
         // Geoset data is compressed into a single integer.
         // The position of the hex digit (from right) represents
         // the group number, and the value of the four bits at
         // that position represents the geoset. So 0x00200000
         // means geoset 2 of group 600, therefore 602.
-        int cgd = r.values[i][5].toInt();
+        int cgd = r.values[i][15].toInt();
         for (int i = 0; i < 8; i++)
         {
           int geotype = 100 * (i + 1);
@@ -546,37 +562,21 @@ bool AnimControl::UpdateCreatureModel(WoWModel *m)
       }
       else // BfA:
       {
-        QString query2 = QString("SELECT GeosetType, GeosetID "
-                                 "FROM CreatureDisplayInfoGeosetData "
-                                 "WHERE DisplayID = %1")
-                                .arg( cdi );
-        sqlResult r2 = GAMEDATABASE.sqlQuery(query2);
-        if(r2.valid && !r2.values.empty())
-        {
-          for(size_t j = 0 ; j < r2.values.size() ; j++)
-          {
-            int geotype = 100 * (r2.values[j][0].toInt() + 1);
-            int geoid = r2.values[j][1].toInt();
-            if (geoid > 0)
-              grp.creatureGeosetData.insert(geotype + geoid);
-          }
-        }
+        std::map<int, std::set<GeosetNum> >::iterator it = displayGeosets.find(cdi);
+        if (it != displayGeosets.end())
+          grp.creatureGeosetData = it->second;
       }
 
       int pci = r.values[i][3].toInt(); // particleColorIndex, for replacing particle color
       if (pci)
       {
         grp.particleColInd = pci;
-        QString pciquery = QString("SELECT StartColor1, MidColor1, EndColor1, "
-        "StartColor2, MidColor2, EndColor2, StartColor3, MidColor3, EndColor3 FROM ParticleColor "
-        "WHERE ID = %1;").arg(pci);
-        sqlResult pcir = GAMEDATABASE.sqlQuery(pciquery);
-        if(pcir.valid && !pcir.empty())
+        if(!r.values[i][5].isEmpty()) // ParticleColor record found
         {
           std::vector<Vec4D> cols;
-          for (size_t j = 0; j < pcir.values[0].size(); j++)
+          for (size_t j = 6; j < 15; j++)
           {
-            cols.push_back(fromARGB(pcir.values[0][j].toInt()));
+            cols.push_back(fromARGB(r.values[i][j].toInt()));
           }
           PCRList.push_back({ {cols[0],cols[1],cols[2]}, {cols[3],cols[4],cols[5]}, {cols[6],cols[7],cols[8]} });
           grp.PCRIndex = numPCRs;
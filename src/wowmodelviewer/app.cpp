@@ -264,6 +264,12 @@ bool WowModelViewApp::OnInit()
       core::Game::instance().init(new wow::WoWFolder(QString::fromWCharArray(gamePath.c_str())), new wow::WoWDatabase());
       GAMEDATABASE.setFastMode();
     }
+    else if (cmd == "-profilequeries") {
+      LOG_INFO << "Database query profiling requested";
+      if (!core::Game::instance().initDone())
+        core::Game::instance().init(new wow::WoWFolder(QString::fromWCharArray(gamePath.c_str())), new wow::WoWDatabase());
+      GAMEDATABASE.setProfiling(true);
+    }
     else if (cmd == "-console") {
       LOG_INFO << "Displaying console requested";
       displayConsole = true;
@@ -338,6 +344,9 @@ int WowModelViewApp::OnExit()
 {
   SaveSettings();
 
+  if (core::Game::instance().initDone() && GAMEDATABASE.profiling())
+    GAMEDATABASE.logProfilingReport();
+
   CleanUp();
 
   //_CrtMemDumpAllObjectsSince( NULL );
@@ -360,6 +369,18 @@ throw;
 }
 */
 
+// any user action (mouse, keyboard, controls) may change what the canvas displays
+int WowModelViewApp::FilterEvent(wxEvent& event)
+{
+  if (event.GetEventType() == wxEVT_MOTION && !((wxMouseEvent&)event).Dragging())
+    return Event_Skip;
+
+  if (event.GetEventCategory() == wxEVT_CATEGORY_USER_INPUT && g_modelViewer && g_modelViewer->canvas)
+    g_modelViewer->canvas->RequestRender();
+
+  return Event_Skip;
+}
+
 void WowModelViewApp::OnUnhandledException()
 {
   LOG_ERROR << __FUNCTION__;
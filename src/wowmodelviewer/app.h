@@ -51,6 +51,7 @@ public:
 	virtual int OnExit();
 	virtual void OnUnhandledException();
 	virtual void OnFatalException();
+	virtual int FilterEvent(wxEvent& event);
 	void setInterfaceLocale();
 
 	//virtual bool OnExceptionInMainLoop();
@@ -524,10 +524,17 @@ void CharControl::selectItem(ssize_t type, ssize_t slot, const wxChar *caption)
     }
   }
 
+  FilteredChoiceDialog * dialog;
   if (subclassesFound.size() > 1)
-    itemDialog = new CategoryChoiceDialog(this, type, g_modelViewer, wxT("Choose an item"), caption, choices, cats, catnames, &quality, false);
+    dialog = new CategoryChoiceDialog(this, type, g_modelViewer, wxT("Choose an item"), caption, choices, cats, catnames, &quality, false);
   else
-    itemDialog = new FilteredChoiceDialog(this, type, g_modelViewer, wxT("Choose an item"), caption, choices, &quality);
+    dialog = new FilteredChoiceDialog(this, type, g_modelViewer, wxT("Choose an item"), caption, choices, &quality);
+
+  // search item database index, unless displayed names differ from item names
+  if (displayItemAndNPCId == 0)
+    dialog->SetSearchIndex(&items.names, numbers);
+
+  itemDialog = dialog;
 
   wxSize s = itemDialog->GetSize();
   const int w = 250;
@@ -743,10 +750,17 @@ void CharControl::selectNPC(ssize_t type)
     }
   }
 
+  FilteredChoiceDialog * dialog;
   if (typesFound.size() > 1)
-    itemDialog = new CategoryChoiceDialog(this, (int)type, g_modelViewer, _("Select an NPC"), _("NPC Models"), choices, cats, catnames, &quality, false, true);
+    dialog = new CategoryChoiceDialog(this, (int)type, g_modelViewer, _("Select an NPC"), _("NPC Models"), choices, cats, catnames, &quality, false, true);
   else
-    itemDialog = new FilteredChoiceDialog(this, (int)type, g_modelViewer, _("Select an NPC"), _("NPC Models"), choices, &quality, false);
+    dialog = new FilteredChoiceDialog(this, (int)type, g_modelViewer, _("Select an NPC"), _("NPC Models"), choices, &quality, false);
+
+  // search npc database index, unless displayed names differ from npc names
+  if (displayItemAndNPCId == 0)
+    dialog->SetSearchIndex(&npcNames, numbers);
+
+  itemDialog = dialog;
 
   itemDialog->SetSelection(0);
 
@@ -10,6 +10,7 @@
 #include "Game.h"
 #include "globalvars.h"
 #include "logger/Logger.h"
+#include "ModelManager.h"
 #include "modelviewer.h"
 #include "Texture.h"
 
@@ -245,9 +246,9 @@ wxString FileControl::ExportPNG(wxString val)
 	if (fn.GetExt().Lower() != wxT("blp"))
 		return _T("");
 
-  TextureID temptex = TEXTUREMANAGER.add(GAMEDIRECTORY.getFile(QString::fromWCharArray(val.c_str())));
-	Texture &tex = *((Texture*)TEXTUREMANAGER.items[temptex]);
-	if (tex.w == 0 || tex.h == 0)
+  // decoded on CPU, no need to go through a GL texture
+  QImage image = Texture::decode(GAMEDIRECTORY.getFile(QString::fromWCharArray(val.c_str())));
+	if (image.isNull())
 		return _T("");
 
 	wxString filename;
@@ -257,13 +258,8 @@ wxString FileControl::ExportPNG(wxString val)
 		filename = wxGetCwd()+SLASH+wxT("Export")+SLASH+fn.GetName()+wxT(".png");
 	}
 
-	unsigned char *tempbuf = (unsigned char*)malloc(tex.w*tex.h*4);
-	tex.getPixels(tempbuf, GL_BGRA_EXT);
+  image.save(QString::fromWCharArray(filename.c_str()));
 
-	QImage PNGFile(tempbuf, tex.w, tex.h, QImage::Format_RGBA8888);
-  PNGFile.save(QString::fromWCharArray(filename.c_str()));
-
-	free(tempbuf);
 	return filename;
 }
 
@@ -323,6 +319,9 @@ void FileControl::OnTreeMenu(wxTreeEvent &event)
 
 void FileControl::ClearCanvas()
 {
+	// a model still loading in background would replace whatever is displayed next
+	modelviewer->canvas->modelLoader.cancel();
+
 	if (!modelviewer->isModel && !modelviewer->isWMO && !modelviewer->isADT)
 		return;
 
@@ -331,6 +330,9 @@ void FileControl::ClearCanvas()
 		//canvas->clearAttachments();
 		wxDELETE(modelviewer->canvas->wmo);
 		modelviewer->canvas->wmo = NULL;
+
+		LOG_INFO << "Retained models :" << ModelManager::nbRetained() << "(" << ModelManager::retainedSize() / (1024 * 1024)
+		         << "MB), hit rate" << (int)(ModelManager::hitRate() * 100) << "%";
 	} else if (modelviewer->isModel) {
 		modelviewer->canvas->clearAttachments();
 
@@ -366,8 +368,8 @@ void FileControl::ClearCanvas()
 		LOG_ERROR << "An OpenGL error occured." << err;
 	LOG_INFO << "Clearing textures from previous model...";
 #endif
-	// Texture clearing and debugging
-	TEXTUREMANAGER.clear();
+	// Texture clearing and debugging, textures of retained models are kept for their reuse
+	TEXTUREMANAGER.clear(ModelManager::retainedTextures());
 
 #ifdef _DEBUG
 	err = glGetError();
@@ -486,6 +488,10 @@ void FileControl::OnTreeSelect(wxTreeEvent &event)
 		if (modelviewer->canvas->model() && !modelviewer->canvas->model()->name().isEmpty() && modelviewer->canvas->model()->name().toStdWString() == std::wstring(rootfn.c_str()))
 			return; // clicked on the same model thats currently loaded, no need to load it again - exit
 
+		// or the one being loaded
+		if (modelviewer->canvas->modelLoader.pendingFile() == data->file)
+			return;
+
 		ClearCanvas();
     LOG_INFO << "Selecting model in tree selector:" << QString::fromWCharArray(rootfn.c_str());
 
@@ -496,9 +502,8 @@ void FileControl::OnTreeSelect(wxTreeEvent &event)
 		//if (wxGetKeyState(WXK_SHIFT)) 
 		//	canvas->AddModel(rootfn);
 		//else
-    modelviewer->LoadModel(GAMEDIRECTORY.getFile(QString::fromWCharArray(rootfn.c_str())));	// Load the model.
-
-		UpdateInterface();
+    // Load the model, in background so that browsing through models never blocks on file reading
+    modelviewer->LoadModelInBackground(GAMEDIRECTORY.getFile(QString::fromWCharArray(rootfn.c_str())), [this]() { UpdateInterface(); });
 	} else if (filterMode == FILE_FILTER_WMO) {
 		ClearCanvas();
 
@@ -1,8 +1,11 @@
 
 #include "imagecontrol.h"
 
+#include <QFileInfo>
+
 #include "logger/Logger.h"
 #include "enums.h"
+#include "ImageStripWriter.h"
 
 IMPLEMENT_CLASS(ImageControl, wxWindow)
 
@@ -68,13 +71,13 @@ void ImageControl::OnShow(wxAuiManager *m)
 
 	glGetIntegerv(GL_MAX_TEXTURE_SIZE, (GLint*)&maxSize); 
 
-	maxsize->SetLabel(wxString::Format(wxT("Max Size: %i"), maxSize));
+	maxsize->SetLabel(wxString::Format(wxT("Tiled Above: %i"), maxSize));
 
 	aspect = ((float)screenSize[2] / (float)screenSize[3]);
 
 	wxString tmp = wxT("screenshot_");
 	tmp << ssCounter;
-	wxFileDialog dialog(this, wxT("Save screenshot"), wxEmptyString, tmp, wxT("Bitmap Images (*.bmp)|*.bmp|TGA Images (*.tga)|*.tga|JPEG Images (*.jpg)|*.jpg|PNG Images (*.png)|*.png"), wxFD_SAVE|wxFD_OVERWRITE_PROMPT);
+	wxFileDialog dialog(this, wxT("Save screenshot"), wxEmptyString, tmp, wxT("Bitmap Images (*.bmp)|*.bmp|TGA Images (*.tga)|*.tga|JPEG Images (*.jpg)|*.jpg|PNG Images (*.png)|*.png|TIFF Images (*.tif)|*.tif"), wxFD_SAVE|wxFD_OVERWRITE_PROMPT);
 	dialog.SetFilterIndex(imgFormat);
 
 	if (dialog.ShowModal()==wxID_OK) {
@@ -102,7 +105,24 @@ void ImageControl::OnButton(wxCommandEvent &event)
 		video.render = false;
 		manager->GetPane(this).Show(false);
 		manager->Update();
-		cc->Screenshot(filename->GetValue(), x ,y);
+		long value = 0;
+		if (canvasWidth->GetValue().ToLong(&value) && value > 0)
+			x = value;
+		if (canvasHeight->GetValue().ToLong(&value) && value > 0)
+			y = value;
+
+		// sizes over GL limits are rendered by tiles, streamed to a png or tiff file
+		if (x > maxSize || y > maxSize) {
+			QString file = QString::fromWCharArray(filename->GetValue().c_str());
+			if (!ImageStripWriter::canWrite(file)) {
+				QFileInfo info(file);
+				file = info.path() + "/" + info.completeBaseName() + ".png";
+				LOG_INFO << "Image too big for selected format, saving it as" << file;
+			}
+			cc->ScreenshotTiled(file.toStdWString(), x, y);
+		} else {
+			cc->Screenshot(filename->GetValue(), x ,y);
+		}
 		ssCounter++;
 		cc->InitView();
 		video.render = true;
@@ -145,13 +165,4 @@ void ImageControl::OnText(wxCommandEvent &event)
 		x = value;
 		canvasWidth->SetValue(wxString::Format(wxT("%li"), value));
 	}
-
-	if (x > maxSize) {
-		x = maxSize;
-		canvasWidth->SetValue(wxString::Format(wxT("%i"), x));
-	}
-	if (y > maxSize) {
-		y = maxSize;
-		canvasHeight->SetValue(wxString::Format(wxT("%i"), x));
-	}
 }
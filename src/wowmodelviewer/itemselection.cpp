@@ -2,8 +2,6 @@
 
 #include <QString>
 
-#include <wx/listctrl.h>
-
 #include "globalvars.h"
 #include "Game.h"
 #include "charcontrol.h"
@@ -48,12 +46,45 @@ wxColour ItemQualityColour(int quality)
 	return c;
 }
 
+ChoiceListCtrl::ChoiceListCtrl(wxWindow *parent, wxWindowID id, const wxArrayString *choices)
+	: wxListView(parent, id, wxDefaultPosition, wxSize(200,200), wxLC_REPORT|wxLC_SINGLE_SEL|wxLC_NO_HEADER|wxLC_VIRTUAL),
+	  m_choices(choices), m_indices(NULL)
+{
+	m_evenAttr.SetBackgroundColour(*wxWHITE);
+	m_oddAttr.SetBackgroundColour(wxColour(237,243,254));
+
+	InsertColumn(0, wxT("Item"), wxLIST_FORMAT_LEFT, 195);
+	SetItemCount((long)m_choices->GetCount());
+}
+
+void ChoiceListCtrl::SetIndices(const std::vector<int> *indices)
+{
+	// rows now show other choices, forget previous selection
+	long sel = GetFirstSelected();
+	if (sel != -1)
+		Select(sel, false);
+
+	m_indices = indices;
+	SetItemCount(m_indices ? (long)m_indices->size() : (long)m_choices->GetCount());
+	Refresh();
+}
+
+wxString ChoiceListCtrl::OnGetItemText(long item, long) const
+{
+	return m_choices->Item(m_indices ? (*m_indices)[item] : item);
+}
+
+wxListItemAttr *ChoiceListCtrl::OnGetItemAttr(long item) const
+{
+	return ((item%2)==0) ? &m_evenAttr : &m_oddAttr;
+}
+
 ChoiceDialog::ChoiceDialog(CharControl *dest, int type,
 	                       wxWindow *parent,
                            const wxString& message,
                            const wxString& caption,
                            const wxArrayString& choices)
-    : wxSingleChoiceDialog(parent, message, caption, choices, (char**)NULL, wxCHOICEDLG_STYLE & ~wxCANCEL & ~wxCENTER, wxDefaultPosition)
+    : wxSingleChoiceDialog(parent, message, caption, wxArrayString(), (char**)NULL, wxCHOICEDLG_STYLE & ~wxCANCEL & ~wxCENTER, wxDefaultPosition)
 {
 	cc = dest;
 	this->type = type;
@@ -63,48 +94,8 @@ ChoiceDialog::ChoiceDialog(CharControl *dest, int type,
 	// New Item Selection stuff
 	// Objective is to change over from a wxListBox to a wxListCtrl
 	// which supports different text colours
-	wxCArrayString chs(choices);
-	m_listctrl = new wxListView(this, wxID_LISTCTRL, wxDefaultPosition, wxSize(200,200), wxLC_REPORT|wxLC_SINGLE_SEL|wxLC_NO_HEADER); 
-	
-	m_listctrl->InsertColumn(0, wxT("Item"), wxLIST_FORMAT_LEFT, 195);
-	//m_listctrl->SetColumnWidth(0, wxLIST_AUTOSIZE);
-
-	wxListItem item;
-	for (size_t i = 0; i < chs.GetCount(); i++) {
-		item.SetText(choices[i]);
-		item.SetId((long)i);
-/*
-		if (item.GetText() == "Death Knight")
-			item.SetTextColour(wxColour(196, 30, 59));
-		else if (item.GetText() == "Druid")
-			item.SetTextColour(wxColour(255, 125, 10));
-		else if (item.GetText() == "Hunter")
-			item.SetTextColour(wxColour(171, 212, 115));
-		else if (item.GetText() == "Mage")
-			item.SetTextColour(wxColour(105, 204, 240));
-		else if (item.GetText() == "Paladin")
-			item.SetTextColour(wxColour(245, 140, 186));
-		else if (item.GetText() == "Priest")
-			item.SetTextColour(wxColour(255, 255, 255));
-		else if (item.GetText() == "Rogue")
-			item.SetTextColour(wxColour(255, 245, 105));
-		else if (item.GetText() == "Shaman")
-			item.SetTextColour(wxColour(36, 89, 255));
-		else if (item.GetText() == "Warlock")
-			item.SetTextColour(wxColour(148, 130, 201));
-		else if (item.GetText() == "Warrior")
-			item.SetTextColour(wxColour(199, 156, 110));
-		else
-			item.SetTextColour(*wxBLACK);
-*/
-		if ((i%2)==0)
-			item.SetBackgroundColour(*wxWHITE);
-		else
-			item.SetBackgroundColour(wxColour(237,243,254));
-
-		m_listctrl->InsertItem(item);
-		//m_listctrl->InsertItem(i, choices[i]);
-	}
+	// (choices are only shown by m_listctrl, wx list box stays empty and hidden)
+	m_listctrl = new ChoiceListCtrl(this, wxID_LISTCTRL, &choices);
 
 	wxBoxSizer *frameSizer = (wxBoxSizer*)this->GetSizer();
 	if (frameSizer) {
@@ -166,6 +157,7 @@ FilteredChoiceDialog::FilteredChoiceDialog(CharControl *dest, int type, wxWindow
 {
 	keepFirst = keepfirst;
     m_choices = &choices;
+    m_index = NULL;
     m_indices.resize(m_choices->GetCount());
     for(size_t i=0; i<m_choices->GetCount(); ++i) 
 		m_indices[i]=(int)i;
@@ -200,27 +192,7 @@ FilteredChoiceDialog::FilteredChoiceDialog(CharControl *dest, int type, wxWindow
     topsizer->Fit( this );
     
 
-	m_listctrl->DeleteAllItems();
-
-	wxListItem item; 
-	for(unsigned int i=0; i<choices.Count(); i++) {
-		//item.m_mask=wxLIST_MASK_TEXT; 
-		item.SetId(i); 
-		//item.m_col=col; 
-		item.SetText(choices[i]);
-		/*
-		if (quality) {
-			item.SetTextColour(ItemQualityColour(quality->at(i)));
-		}
-		*/
-		if ((i%2)==0)
-			item.SetBackgroundColour(*wxWHITE);
-		else
-			item.SetBackgroundColour(wxColour(237,243,254));
-
-		// m_listbox doesn't support wxListItem, try wxListCtrl
-		m_listctrl->InsertItem(item);
-	}
+	m_listctrl->SetIndices(&m_indices);
 }
 
 void FilteredChoiceDialog::OnFilter(wxCommandEvent& event){
@@ -234,19 +206,16 @@ void FilteredChoiceDialog::OnImportNPC(wxCommandEvent& event){
 	if ( dlg->ShowModal() == wxID_OK ) {
 		int modelid = dlg->getImportedId();
 		if(modelid != -1) {
-			int id = 0;
-			bool found = false;
-			for (std::vector<NPCRecord>::iterator it=npcs.begin();  it!=npcs.end(); ++it, id++) {
-				if(it->id == modelid) {
-					found = true;
-					break;
-				}
-			}
+			int id = (int)npcs.size();
+			std::unordered_map<int, size_t>::const_iterator it = npcLookup.find(modelid);
+			bool found = (it != npcLookup.end());
+			if (found)
+				id = (int)it->second;
 
 			if(!found) { // npc is not present in current database
 				NPCRecord rec(dlg->getNPCLine());
 				if (rec.model > 0) {
-					npcs.push_back(rec);
+					addNPC(rec);
 					id = npcs.size()-1;
 					QString query = QString("INSERT INTO Creature(ID,CreatureTypeID,DisplayID1,Name) VALUES (%1,%2,%3,\"%4\")").arg(modelid).arg(rec.type).arg(rec.model).arg(rec.name);
 					GAMEDATABASE.sqlQuery(query);
@@ -265,18 +234,11 @@ void FilteredChoiceDialog::OnImportItem(wxCommandEvent& event){
 	if ( dlg->ShowModal() == wxID_OK ){
 		ItemRecord rec = dlg->getImportedItem();
 		if(rec.id != 0) {
-			bool found = false;
-
-			for (std::vector<ItemRecord>::iterator it=items.items.begin();  it!=items.items.end(); ++it) {
-				if(it->id == rec.id) {
-					found = true;
-					break;
-				}
-			}
+			bool found = (items.itemLookup.find(rec.id) != items.itemLookup.end());
 
 			if(!found) { // item is not present in current database
 				if (rec.model > 0) {
-					items.items.push_back(rec);
+					items.add(rec);
 				}
 			}
 
@@ -287,36 +249,66 @@ void FilteredChoiceDialog::OnImportItem(wxCommandEvent& event){
 	dlg->Destroy();
 }
 
+void FilteredChoiceDialog::SetSearchIndex(const SearchIndex* index, const std::vector<int> &ids)
+{
+	m_index = index;
+	m_idToChoice.clear();
+	for (size_t i=0; i<ids.size(); ++i)
+		m_idToChoice.insert(std::make_pair(ids[i], (int)i));
+}
+
 void FilteredChoiceDialog::DoFilter()
 {
 	m_indices.clear();
 
-	m_listctrl->DeleteAllItems();
+	wxString pattern = m_pattern->GetValue();
+	int count = (int)m_choices->GetCount();
 
-	wxListItem item; 
-	for(int i=0; i<(int)m_choices->GetCount(); ++i)
+	if (keepFirst && count > 0)
+		m_indices.push_back(0);
+
+	if (pattern.IsEmpty())
 	{
-		if (FilterFunc(i))
+		for(int i=0; i<count; ++i)
 		{
-			item.SetId(i); 
-			item.SetText(m_choices->Item(i));
-			m_indices.push_back((int)i);
-			if ((i%2)==0)
-				item.SetBackgroundColour(*wxWHITE);
-			else
-				item.SetBackgroundColour(wxColour(237,243,254));
-
-			m_listctrl->InsertItem(item);
+			if ((i != 0 || !keepFirst) && FilterFunc(i))
+				m_indices.push_back(i);
 		}
 	}
+	else
+	{
+		if (!m_index)
+		{
+			for(int i=0; i<count; ++i)
+				m_ownIndex.add(i, QString::fromStdWString(m_choices->Item(i).ToStdWstring()));
+			m_index = &m_ownIndex;
+		}
+
+		// results are ranked, best matches first
+		std::vector<int> found = m_index->search(QString::fromStdWString(pattern.ToStdWstring()));
+		for (size_t r=0; r<found.size(); ++r)
+		{
+			int i = found[r];
+			if (m_index != &m_ownIndex)
+			{
+				std::unordered_map<int, int>::const_iterator it = m_idToChoice.find(found[r]);
+				if (it == m_idToChoice.end()) // not part of this list
+					continue;
+				i = it->second;
+			}
+
+			if ((i != 0 || !keepFirst) && FilterFunc(i))
+				m_indices.push_back(i);
+		}
+	}
+
+	m_listctrl->SetIndices(&m_indices);
 }
 
-bool FilteredChoiceDialog::FilterFunc(int index)
+bool FilteredChoiceDialog::FilterFunc(int)
 {
-	if (index==0 && keepFirst) 
-		return true;
-
-	return m_choices->Item(index).Lower().Matches(_T("*") + m_pattern->GetValue().Lower() + _T("*"));
+	// name filtering is done through search index, see DoFilter
+	return true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
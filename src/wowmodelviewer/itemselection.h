@@ -8,15 +8,36 @@
 
 // wx
 #include <wx/choicdlg.h>
+#include <wx/listctrl.h>
 class wxListEvent;
-class wxListView;
 
 // stl
 #include <map>
+#include <unordered_map>
 #include <vector>
 
+#include "SearchIndex.h"
+
 wxColour ItemQualityColour(int quality);
 
+// Virtual list control displaying choices[indices[i]] for each row (all choices when
+// there is no index list), so that long lists are shown without inserting any item.
+class ChoiceListCtrl : public wxListView {
+public:
+	ChoiceListCtrl(wxWindow *parent, wxWindowID id, const wxArrayString *choices);
+
+	void SetIndices(const std::vector<int> *indices);
+
+protected:
+	virtual wxString OnGetItemText(long item, long column) const;
+	virtual wxListItemAttr *OnGetItemAttr(long item) const;
+
+private:
+	const wxArrayString *m_choices;
+	const std::vector<int> *m_indices;
+	mutable wxListItemAttr m_evenAttr, m_oddAttr;
+};
+
 class CharControl;
 
 class ChoiceDialog : public wxSingleChoiceDialog {
@@ -26,7 +47,7 @@ class ChoiceDialog : public wxSingleChoiceDialog {
 
 public:
 	CharControl *cc;
-	wxListView *m_listctrl;
+	ChoiceListCtrl *m_listctrl;
 	ChoiceDialog(CharControl *dest, int type,
 	                       wxWindow *parent,
                            const wxString& message,
@@ -36,6 +57,7 @@ public:
 	virtual void OnClick(wxCommandEvent &event);
 	void OnSelect(wxListEvent &event);
   virtual int GetSelection() const { return m_selection; }
+	void SetSelection(int sel) { m_selection = sel; } // wx list box is empty, see constructor
 	void EndModal(int retCode) { SetReturnCode(retCode); Hide(); }
 	virtual void DoFilter() { };
 	virtual void Check(int index, bool state) { };
@@ -49,6 +71,12 @@ protected:
     wxTextCtrl* m_pattern;
     const wxArrayString* m_choices;
     std::vector<int> m_indices; // filtered index -> orig inndex
+
+    // search index used by filter, over choices (m_ownIndex, built on first search)
+    // or over a whole catalogue (items, npcs...) whose ids are mapped back to choices
+    const SearchIndex* m_index;
+    SearchIndex m_ownIndex;
+    std::unordered_map<int, int> m_idToChoice; // catalogue id -> orig index
     
     DECLARE_EVENT_TABLE()
 
@@ -77,6 +105,10 @@ public:
   virtual int GetSelection() const { return m_indices[m_selection]; }
   virtual bool FilterFunc(int index);
   virtual void DoFilter();
+
+  // search catalogue index instead of choices, ids[i] being catalogue id of choice i
+  // (displayed choices must then be catalogue names)
+  void SetSearchIndex(const SearchIndex* index, const std::vector<int> &ids);
 };
 
 
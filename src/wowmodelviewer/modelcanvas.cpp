@@ -1,9 +1,11 @@
 #include "modelcanvas.h"
 
-#include "ximage.h"
+#include <algorithm>
+
 #include <QImage>
 #include <QImageWriter>
 #include <QImageReader>
+#include <QRunnable>
 
 #include <wx/display.h>
 #include <wx/file.h>
@@ -13,8 +15,11 @@
 #include "animcontrol.h"
 #include "Attachment.h"
 #include "globalvars.h"
+#include "ImageStripWriter.h"
+#include "ModelManager.h"
 #include "modelviewer.h"
 #include "shaders.h"
+#include "TextureExporter.h"
 #include "video.h"
 #include "WMOGroup.h"
 
@@ -154,6 +159,24 @@ ModelCanvas::ModelCanvas(wxWindow *parent, VideoCaps *caps)
 
   m_p_cameraCtrl = 0;
   m_useNewCamera = false;
+
+  m_needRender = true;
+  m_lastRenderModel = 0;
+  m_effectsTicked = false;
+
+  m_screenshotRT = 0;
+  m_screenshotRTWidth = m_screenshotRTHeight = 0;
+  for (size_t i = 0; i < SCREENSHOT_BUFFERS; i++)
+  {
+    m_screenshots[i].pbo = 0;
+    m_screenshots[i].size = 0;
+    m_screenshots[i].width = m_screenshots[i].height = 0;
+    m_screenshots[i].pending = false;
+  }
+  m_nextScreenshot = 0;
+  m_tile.active = false;
+  // one encoder thread keeps files written in capture order
+  m_screenshotEncoder.setMaxThreadCount(1);
 }
 
 ModelCanvas::~ModelCanvas()
@@ -163,7 +186,17 @@ ModelCanvas::~ModelCanvas()
 	cAvi.ReleaseEngine();
 #endif
 
-	// Clear remaining textures.
+	// Write screenshots still pending
+	FlushScreenshots(true);
+
+	for (size_t i = 0; i < SCREENSHOT_BUFFERS; i++)
+	{
+		if (m_screenshots[i].pbo)
+			glDeleteBuffersARB(1, &m_screenshots[i].pbo);
+	}
+
+	// Clear models retained for reuse and remaining textures.
+  ModelManager::flushRetained();
   TEXTUREMANAGER.clear();
 
 	// Uninitialise shaders
@@ -182,6 +215,10 @@ ModelCanvas::~ModelCanvas()
 		rt->Shutdown();
 		wxDELETE(rt);
 	}
+	if (m_screenshotRT) {
+		m_screenshotRT->Shutdown();
+		wxDELETE(m_screenshotRT);
+	}
 #endif
   delete m_p_cameraCtrl;
 }
@@ -198,6 +235,8 @@ void ModelCanvas::OnSize(wxSizeEvent& event)
 	if (init) 
 		InitView();
 
+	RequestRender();
+
 	if(g_modelViewer)
 	  g_modelViewer->UpdateCanvasStatus();
 }
@@ -322,12 +361,16 @@ Attachment* ModelCanvas::AddModel(const char *fn)
 #endif
 
 Attachment* ModelCanvas::LoadModel(GameFile * file)
+{
+	return LoadModel(modelLoader.loadNow(file));
+}
+
+Attachment* ModelCanvas::LoadModel(WoWModel * m)
 {
 	clearAttachments();
 	root->setModel(0);
 	delete wmo;
 	wmo = NULL;
-  WoWModel * m = new WoWModel(file, true);
   setModel(m);
 
 	if (!model()->ok)
@@ -345,14 +388,17 @@ Attachment* ModelCanvas::LoadModel(GameFile * file)
 }
 
 Attachment* ModelCanvas::LoadCharModel(GameFile * file)
+{
+	return LoadCharModel(modelLoader.loadNow(file));
+}
+
+Attachment* ModelCanvas::LoadCharModel(WoWModel * m)
 {
 	clearAttachments();
 	root->setModel(0);
 	delete wmo;
 	wmo = NULL;
 
-	// Create new one
-	WoWModel * m = new WoWModel(file, true);
   setModel(m);
 	if (!model()->ok)
 	{
@@ -397,6 +443,8 @@ void ModelCanvas::LoadWMO(wxString fn)
     if (m_useNewCamera)
       arcCamera.autofit(wmo->minCoord, wmo->maxCoord, video.fov);
 	}
+
+	RequestRender();
 }
 
 
@@ -407,6 +455,8 @@ void ModelCanvas::clearAttachments()
 
 	if (sky)
 		sky->delChildren();
+
+	RequestRender();
 }
 
 void ModelCanvas::Zoom(float f, bool rel)
@@ -644,6 +694,15 @@ void ModelCanvas::OnPaint(wxPaintEvent& WXUNUSED(event))
 			RenderADT();
 		else
 			Render();
+
+		// remember what is displayed, see NeedsRender
+		m_needRender = false;
+		m_lastRenderModel = model();
+		if (model())
+		{
+			m_lastRenderPos = model()->pos;
+			m_lastRenderRot = model()->rot;
+		}
 	}
 }
 
@@ -845,11 +904,20 @@ inline void ModelCanvas::RenderBackground()
 
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
+	// tiles only show their part of the background
+	float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+	if (m_tile.active) {
+		u0 = (float)m_tile.x / m_tile.fullWidth;
+		u1 = (float)(m_tile.x + m_tile.width) / m_tile.fullWidth;
+		v0 = (float)m_tile.y / m_tile.fullHeight;
+		v1 = (float)(m_tile.y + m_tile.height) / m_tile.fullHeight;
+	}
+
 	glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f); glVertex2f(0, 0);
-		glTexCoord2f(1.0f, 0.0f); glVertex2f(1, 0);
-		glTexCoord2f(1.0f, 1.0f); glVertex2f(1, 1);
-		glTexCoord2f(0.0f, 1.0f); glVertex2f(0, 1);
+		glTexCoord2f(u0, v0); glVertex2f(0, 0);
+		glTexCoord2f(u1, v0); glVertex2f(1, 0);
+		glTexCoord2f(u1, v1); glVertex2f(1, 1);
+		glTexCoord2f(u0, v1); glVertex2f(0, 1);
 	glEnd();
 
 	// ModelView
@@ -1431,6 +1499,9 @@ void ModelCanvas::RenderToBuffer()
 	{
 		glPushAttrib(GL_VIEWPORT_BIT);
 		video.ResizeGLScene(rt->nWidth, rt->nHeight);
+
+		if (m_tile.active)
+			SetupTileProjection(video.fov, 0.1, 1280 * 5); // same as VideoSettings::ResizeGLScene
 	}
 
 	// Sets the "clear" colour.  Without this you get the "ghosting" effecting 
@@ -1506,6 +1577,10 @@ void ModelCanvas::RenderToBuffer()
 		if (useCamera && model()->hasCamera) {
       WoWModel * m = const_cast<WoWModel *>(model());
 			m->cam[0].setup();
+
+			// camera loads its own full view projection, restrict it to current tile
+			if (m_tile.active)
+				SetupTileProjection(m->cam[0].fov * 34.5f, m->cam[0].nearclip, m->cam[0].farclip * 5);
 		} else {
 			// TODO: Possibly move this into the Model/Attachment/Displayable::draw() routine?
 			glTranslatef(model()->pos.x, model()->pos.y, -model()->pos.z);
@@ -1552,11 +1627,90 @@ void ModelCanvas::RenderToBuffer()
 
 void ModelCanvas::OnTimer(wxTimerEvent& event)
 {
+	// screenshots read back during previous tick are ready now
+	FlushScreenshots();
+
+	modelLoader.update();
+
 	if (video.render && init) {
 		CheckMovement();
 		tick();
-		Refresh(false);
+		if (NeedsRender())
+			Refresh(false);
+	}
+}
+
+void ModelCanvas::RequestRender()
+{
+	m_needRender = true;
+}
+
+// true if a model of the attachment tree changes with global time
+static bool hasGlobalSequences(Attachment *att)
+{
+	WoWModel *m = dynamic_cast<WoWModel *>(att->model());
+	if (m && m->animated && m->hasGlobalSequences())
+		return true;
+
+	for (auto it : att->children)
+	{
+		if (hasGlobalSequences(it))
+			return true;
 	}
+
+	return false;
+}
+
+// true if a model of the attachment tree has particles, ribbons or lights
+static bool hasEffects(Attachment *att)
+{
+	WoWModel *m = dynamic_cast<WoWModel *>(att->model());
+	if (m && (m->hasEmitters() || m->nbLights() > 0))
+		return true;
+
+	for (auto it : att->children)
+	{
+		if (hasEffects(it))
+			return true;
+	}
+
+	return false;
+}
+
+bool ModelCanvas::NeedsRender()
+{
+	if (m_needRender)
+		return true;
+
+	// WMO keeps rendering while groups / doodads are streamed in and while doodads are animated
+	if (wmo)
+		return wmo->isStreaming() || wmo->isAnimated();
+
+	if (adt || (drawSky && skyModel) || drawAVIBackground)
+		return true;
+
+	// particles, ribbons and lights keep moving while time flows for them, even on a model
+	// without animation (static models are never paused)
+	if (m_effectsTicked)
+		return true;
+
+	if (model() != m_lastRenderModel)
+		return true;
+
+	if (model())
+	{
+		if (!(model()->pos == m_lastRenderPos) || !(model()->rot == m_lastRenderRot))
+			return true;
+
+		// animation time moves, or global sequences do even when paused
+		if (model()->animManager && !model()->animManager->IsPaused())
+			return true;
+
+		if (hasGlobalSequences(root))
+			return true;
+	}
+
+	return false;
 }
 
 void ModelCanvas::tick()
@@ -1584,6 +1738,8 @@ void ModelCanvas::tick()
 		root->tick(ddt);
 	}
 
+	m_effectsTicked = model() && (ddt != 0) && hasEffects(root);
+
 	if (drawSky && sky && skyModel) {
 		sky->tick(ddt);
 	}
@@ -1845,6 +2001,28 @@ void ModelCanvas::CheckMovement()
 	// --
 }
 
+namespace
+{
+  class ScreenshotEncoder : public QRunnable
+  {
+    public:
+      ScreenshotEncoder(const QImage & image, const QString & file)
+        : m_image(image), m_file(file)
+      {}
+
+      void run()
+      {
+        // GL rows are bottom to top
+        if (!TextureExporter::save(m_image.mirrored(), m_file))
+          LOG_ERROR << "Unable to save screenshot" << m_file;
+      }
+
+    private:
+      QImage m_image;
+      QString m_file;
+  };
+}
+
 // Our screenshot function which supports both PBO and FBO aswell as traditional older cards, eventually.
 void ModelCanvas::Screenshot(const wxString fn, int x, int y)
 {
@@ -1853,23 +2031,21 @@ void ModelCanvas::Screenshot(const wxString fn, int x, int y)
 	delete rt;
 	rt = 0;
 
-	wxFileName temp(fn, wxPATH_NATIVE);
-	
+	QString file = QString::fromWCharArray(fn.c_str());
+
 	int screenSize[4];
 	glGetIntegerv(GL_VIEWPORT, screenSize);
 
 	// Setup out buffers for offscreen rendering
 	if (video.supportPBO || video.supportFBO)
 	{
-	  rt = new (std::nothrow) RenderTexture();
-
-	  if(!rt)
+	  rt = ScreenshotTarget(x, y);
+	  if (!rt)
 	  {
-	    LOG_ERROR << "Unable to initialise render texture to make screenshot";
+	    glPixelStorei(GL_PACK_ALIGNMENT, 4);
 	    return;
 	  }
 
-	  rt->Init(x, y, video.supportFBO);
 	  screenSize[2] = rt->nWidth;
 
 	  screenSize[3] = rt->nHeight;
@@ -1889,46 +2065,246 @@ void ModelCanvas::Screenshot(const wxString fn, int x, int y)
       RenderToBuffer();
 	}
 
-  LOG_INFO << "Saving screenshot in : " << QString::fromWCharArray(fn.c_str());
+  LOG_INFO << "Saving screenshot in : " << file;
 
-	if(temp.GetExt() == wxT("tga")) // QT does not support tga writing
-	{
-	  // Make the BYTE array, factor of 3 because it's RBG.
-	  BYTE* pixels = new BYTE[ 4 * screenSize[2] * screenSize[3]];
+  const int width = screenSize[2];
+  const int height = screenSize[3];
 
-	  glReadPixels(0, 0, screenSize[2], screenSize[3], GL_BGRA_EXT, GL_UNSIGNED_BYTE, pixels);
+  // pixel pack buffers belong to canvas context, pbuffers have their own one
+  if (GLEW_ARB_pixel_buffer_object && (!rt || video.supportFBO))
+  {
+    PendingScreenshot & screenshot = m_screenshots[m_nextScreenshot];
+    m_nextScreenshot = (m_nextScreenshot + 1) % SCREENSHOT_BUFFERS;
 
-	  CxImage newImage;
-	  // deactivate alpha layr for now, need to rewrite RenderTexture class
-	  //newImage.AlphaCreate();  // Create the alpha layer
-	  newImage.IncreaseBpp(32);  // set image to 32bit
-	  newImage.CreateFromArray(pixels, screenSize[2], screenSize[3], 32, (screenSize[2]*4), false);
-	  newImage.Save(fn.fn_str(), CXIMAGE_FORMAT_TGA);
-	  newImage.Destroy();
+    // ring is full, oldest capture has to be mapped now
+    if (screenshot.pending)
+      ReadScreenshot(screenshot);
+
+    const size_t size = 4 * width * height;
+
+    if (!screenshot.pbo)
+      glGenBuffersARB(1, &screenshot.pbo);
+
+    glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, screenshot.pbo);
+    if (screenshot.size != size)
+    {
+      glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, size, 0, GL_STREAM_READ_ARB);
+      screenshot.size = size;
+    }
+
+    // returns immediately, copy is done by the driver
+    glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, 0);
+    glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    screenshot.width = width;
+    screenshot.height = height;
+    screenshot.file = file;
+    screenshot.pending = true;
+  }
+  else
+  {
+    QImage image(width, height, QImage::Format_RGB32);
+    glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, image.bits());
+    EncodeScreenshot(image, file);
+  }
 
-	  // free the memory
-	  wxDELETEA(pixels);
-	}
-	else // other formats, let Qt do the job
-	{
-	  QImage image(screenSize[2],  screenSize[3], QImage::Format_RGB32);
-	  glReadPixels(0, 0, screenSize[2], screenSize[3], GL_BGRA_EXT, GL_UNSIGNED_BYTE, image.bits());
-    image.mirrored().save(QString::fromWCharArray(fn.c_str()));
-	}
-	
 	if (rt)
 	{
 	  rt->ReleaseTexture();
 	  rt->EndRender();
-	  rt->Shutdown();
-	  delete rt;
 	  rt = 0;
+
+	  // pbuffers are not kept, they own a GL context
+	  if (!video.supportFBO)
+	  {
+	    m_screenshotRT->Shutdown();
+	    delete m_screenshotRT;
+	    m_screenshotRT = 0;
+	  }
 	}
 
 	// Set back to normal
 	glPixelStorei(GL_PACK_ALIGNMENT, 4);
 }
 
+void ModelCanvas::ScreenshotTiled(const wxString fn, int width, int height, int tileSize)
+{
+  if (!video.supportFBO)
+  {
+    LOG_ERROR << "Tiled screenshots need frame buffer objects support";
+    return;
+  }
+
+  if (tileSize <= 0)
+  {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    tileSize = std::min((int)maxSize, 1024);
+  }
+
+  QString file = QString::fromWCharArray(fn.c_str());
+
+  // image is streamed strip by strip, one strip being one row of tiles
+  ImageStripWriter writer(file, width, height, tileSize);
+  if (!writer.open())
+    return;
+
+  delete rt;
+  rt = ScreenshotTarget(tileSize, tileSize);
+  if (!rt)
+    return;
+
+  LOG_INFO << "Saving" << width << "x" << height << "screenshot in" << file << "using tiles of" << tileSize << "pixels";
+
+  // tiles are read directly at their place in the strip
+  std::vector<unsigned char> strip(4 * (size_t)width * tileSize);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glPixelStorei(GL_PACK_ROW_LENGTH, width);
+
+  rt->BeginRender();
+
+  m_tile.active = true;
+  m_tile.fullWidth = width;
+  m_tile.fullHeight = height;
+
+  bool ok = true;
+  for (int top = 0; top < height && ok; top += tileSize)
+  {
+    m_tile.height = std::min(tileSize, height - top);
+    m_tile.y = height - top - m_tile.height;
+
+    for (int x = 0; x < width; x += tileSize)
+    {
+      m_tile.x = x;
+      m_tile.width = std::min(tileSize, width - x);
+
+      if (model())
+        RenderToBuffer();
+
+      glReadPixels(0, 0, m_tile.width, m_tile.height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, &strip[4 * x]);
+    }
+
+    // GL rows are bottom up, image strips top down
+    ok = writer.writeRows(&strip[4 * (size_t)width * (m_tile.height - 1)], m_tile.height, -4 * width);
+  }
+
+  m_tile.active = false;
+
+  rt->EndRender();
+  rt = 0;
+
+  if (!writer.close())
+    LOG_ERROR << "Unable to write screenshot" << file;
+
+  // Set back to normal
+  glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+void ModelCanvas::SetupTileProjection(double fovY, double zNear, double zFar)
+{
+  glViewport(0, 0, m_tile.width, m_tile.height);
+
+  const double top = zNear * tan(fovY * PI / 360.0);
+  const double right = top * m_tile.fullWidth / m_tile.fullHeight;
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glFrustum(-right + 2.0 * right * m_tile.x / m_tile.fullWidth,
+            -right + 2.0 * right * (m_tile.x + m_tile.width) / m_tile.fullWidth,
+            -top + 2.0 * top * m_tile.y / m_tile.fullHeight,
+            -top + 2.0 * top * (m_tile.y + m_tile.height) / m_tile.fullHeight,
+            zNear, zFar);
+  glMatrixMode(GL_MODELVIEW);
+}
+
+RenderTexture * ModelCanvas::ScreenshotTarget(int width, int height)
+{
+  // no size means current viewport size (as in RenderTexture::Init), which changes with canvas size
+  if (width == 0 || height == 0)
+  {
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    width = viewport[2];
+    height = viewport[3];
+  }
+
+  // FBO render target is reused by next captures of the same size
+  if (m_screenshotRT && (m_screenshotRTWidth != width || m_screenshotRTHeight != height))
+  {
+    m_screenshotRT->Shutdown();
+    delete m_screenshotRT;
+    m_screenshotRT = 0;
+  }
+
+  if (!m_screenshotRT)
+  {
+    m_screenshotRT = new (std::nothrow) RenderTexture();
+
+    if(!m_screenshotRT)
+    {
+      LOG_ERROR << "Unable to initialise render texture to make screenshot";
+      return 0;
+    }
+
+    m_screenshotRT->Init(width, height, video.supportFBO);
+    m_screenshotRTWidth = width;
+    m_screenshotRTHeight = height;
+  }
+
+  return m_screenshotRT;
+}
+
+void ModelCanvas::FlushScreenshots(bool wait)
+{
+  bool pending = false;
+  for (size_t i = 0; i < SCREENSHOT_BUFFERS; i++)
+    pending = pending || m_screenshots[i].pending;
+
+  if (pending)
+  {
+    SetCurrent();
+
+    // oldest first
+    for (size_t i = 0; i < SCREENSHOT_BUFFERS; i++)
+    {
+      PendingScreenshot & screenshot = m_screenshots[(m_nextScreenshot + i) % SCREENSHOT_BUFFERS];
+      if (screenshot.pending)
+        ReadScreenshot(screenshot);
+    }
+  }
+
+  if (wait)
+    m_screenshotEncoder.waitForDone();
+}
+
+void ModelCanvas::ReadScreenshot(PendingScreenshot & screenshot)
+{
+  screenshot.pending = false;
+
+  glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, screenshot.pbo);
+  const unsigned char * pixels = (const unsigned char *)glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+
+  if (pixels)
+  {
+    QImage image(screenshot.width, screenshot.height, QImage::Format_RGB32);
+    memcpy(image.bits(), pixels, 4 * screenshot.width * screenshot.height);
+    glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+    EncodeScreenshot(image, screenshot.file);
+  }
+  else
+  {
+    LOG_ERROR << "Unable to read screenshot pixels for" << screenshot.file;
+  }
+
+  glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+}
+
+void ModelCanvas::EncodeScreenshot(const QImage & image, const QString & file)
+{
+  m_screenshotEncoder.start(new ScreenshotEncoder(image, file));
+}
+
 // Save the scene state,  currently this is just position/rotation/field of view
 void ModelCanvas::SaveSceneState(int id)
 {
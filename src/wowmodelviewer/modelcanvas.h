@@ -16,6 +16,10 @@
 // stl
 #include <string>
 
+// Qt
+#include <QString>
+#include <QThreadPool>
+
 // our headers
 #include "AnimExporter.h"
 #include "ArcBallCamera.h"
@@ -26,6 +30,7 @@
 #include "camera.h"
 #include "lightcontrol.h"
 #include "maptile.h"
+#include "ModelLoader.h"
 #include "RenderTexture.h"
 #include "util.h"
 #include "wmo.h"
@@ -89,6 +94,9 @@ public:
 	void tick();
 	wxTimer timer;
 
+	// ask for a new frame on next timer tick (frames are only rendered when something changed)
+	void RequestRender();
+
 	// OGL related functions
 	void InitGL();
 	void InitView();
@@ -115,6 +123,12 @@ public:
 	//void GenerateShadowMap();
 
 	void Screenshot(const wxString fn, int x=0, int y=0);
+	// map screenshots still in pixel buffers and queue their encoding,
+	// optionally waiting for all screenshot files to be written
+	void FlushScreenshots(bool wait = false);
+	// render an image bigger than GL limits as a grid of tiles streamed to a png / tiff file,
+	// tileSize <= 0 picks it from GL max texture size
+	void ScreenshotTiled(const wxString fn, int width, int height, int tileSize = 0);
 	void SaveSceneState(int id);
 	void LoadSceneState(int id);
 
@@ -131,6 +145,12 @@ public:
 	
 	Attachment* LoadModel(GameFile *);
 	Attachment* LoadCharModel(GameFile *);
+	// same, with a model already built (see modelLoader)
+	Attachment* LoadModel(WoWModel *);
+	Attachment* LoadCharModel(WoWModel *);
+
+	// models loaded in background are built on timer ticks, GL context being current
+	ModelLoader modelLoader;
 #if 0
 	Attachment* AddModel(const char *fn);
 #endif
@@ -185,6 +205,48 @@ private:
 
   bool fxBlur, fxGlow, fxFog;
 
+  // render on demand: state displayed by last frame
+  bool NeedsRender();
+  bool m_needRender;
+  const WoWModel * m_lastRenderModel;
+  Vec3D m_lastRenderPos, m_lastRenderRot;
+  bool m_effectsTicked; // emitters or lights moved by last tick
+
+  // screenshots: render target is kept between captures of the same size, pixels are
+  // read into a ring of pixel pack buffers mapped on next tick, and encoded in background
+  struct PendingScreenshot
+  {
+    GLuint pbo;
+    size_t size;
+    int width, height;
+    QString file;
+    bool pending;
+  };
+
+  static const size_t SCREENSHOT_BUFFERS = 2;
+
+  RenderTexture * ScreenshotTarget(int width, int height);
+  void ReadScreenshot(PendingScreenshot & screenshot);
+  void EncodeScreenshot(const QImage & image, const QString & file);
+
+  // tiled screenshots: part of the full image currently rendered, in pixels (bottom up)
+  struct ScreenshotTile
+  {
+    bool active;
+    int x, y, width, height;
+    int fullWidth, fullHeight;
+  };
+
+  // perspective of the full image (vertical fov in degrees), restricted to current tile
+  void SetupTileProjection(double fovY, double zNear, double zFar);
+
+  RenderTexture * m_screenshotRT;
+  int m_screenshotRTWidth, m_screenshotRTHeight;
+  PendingScreenshot m_screenshots[SCREENSHOT_BUFFERS];
+  size_t m_nextScreenshot;
+  QThreadPool m_screenshotEncoder;
+  ScreenshotTile m_tile;
+
   bool m_useNewCamera;
   ArcBallCameraControl * m_p_cameraCtrl;
   ArcBallCamera arcCamera;
@@ -14,7 +14,9 @@
 #include "Bone.h"
 #include "CASCFile.h"
 #include "CASCFolder.h"
+#include "CatalogueLoader.h"
 #include "CharInfos.h"
+#include "CharSectionsTable.h"
 #include "ExporterPlugin.h"
 #include "Game.h"
 #include "GlobalSettings.h"
@@ -22,6 +24,7 @@
 #include "ImporterPlugin.h"
 #include "MemoryUtils.h"
 #include "ModelRenderPass.h"
+#include "OutfitLoader.h"
 #include "PluginManager.h"
 #include "RaceInfos.h"
 #include "SettingsControl.h"
@@ -606,6 +609,12 @@ void ModelViewer::InitDatabase()
   wxWindowDisabler disableAll;
   wxBusyInfo info(_T("Please wait during game database analysis..."), this);
 
+  // startup catalogues (texture regions, races, items, npcs) are read straight from
+  // game files, while sql database is being built
+  CatalogueLoader catalogues;
+  if (GAMEDATABASE.readStructure("database.xml"))
+    catalogues.start();
+
   if (!GAMEDATABASE.initFromXML("database.xml"))
   {
     initDB = false;
@@ -618,57 +627,15 @@ void ModelViewer::InitDatabase()
     LOG_INFO << "Initializing succeeded.";
   }
 
-  // init texture regions
-  CharTexture::initRegions();
-  
-  // init Race informations
-  RaceInfos::init();
+  // init character customization tables
+  CharSectionsTable::init();
   
   LOG_INFO << "Initializing Databases...";
   SetStatusText(wxT("Initializing Databases..."));
-  initDB = true;
-
-  {
-    sqlResult npc = GAMEDATABASE.sqlQuery("SELECT ID, DisplayID1, CreatureTypeID, Name From Creature;");
+  initDB = catalogues.wait();
 
-    if (npc.valid && !npc.empty())
-    {
-      LOG_INFO << "Found" << npc.values.size() << "NPCs";
-      for (int i = 0, imax = npc.values.size(); i < imax; i++)
-      {
-        NPCRecord rec(npc.values[i]);
-        if (rec.model != 0)
-          npcs.push_back(rec);
-      }
-    }
-    else
-    {
-      initDB = false;
-      LOG_ERROR << "Error during NPC detection from database.";
-      return;
-    }
-
-  }
-  
-  {
-    sqlResult item = GAMEDATABASE.sqlQuery("SELECT Item.ID, ItemSparse.Name, Item.Type, Item.Class, Item.SubClass, Item.Sheath FROM Item LEFT JOIN ItemSparse ON Item.ID = ItemSparse.ID WHERE Item.Type !=0 AND ItemSparse.Name != \"\"");
-
-    if (item.valid && !item.empty())
-    {
-      LOG_INFO << "Found" << item.values.size() << "items";
-      for (int i = 0, imax = item.values.size(); i < imax; i++)
-      {
-        ItemRecord rec(item.values[i]);
-        items.items.push_back(rec);
-      }
-    }
-    else
-    {
-      initDB = false;
-      LOG_ERROR << "Error during Item detection from database.";
-      return;
-    }
-  }
+  if (!initDB)
+    return;
 
   LOG_INFO << "Finished initiating database files.";
   SetStatusText(wxT("Finished initiating database files."));;
@@ -961,6 +928,36 @@ void ModelViewer::LoadModel(GameFile * file)
   if (!canvas || !file)
     return;
 
+  DisplayModel(file, canvas->modelLoader.loadNow(file));
+}
+
+void ModelViewer::LoadModelInBackground(GameFile * file, std::function<void()> onLoaded)
+{
+  if (!canvas || !file)
+    return;
+
+  canvas->modelLoader.load(file,
+    [this, file, onLoaded](WoWModel * model)
+    {
+      if (model)
+        DisplayModel(file, model);
+      else
+        LOG_ERROR << "Failed to load the model" << file->fullname();
+
+      if (onLoaded)
+        onLoaded();
+    },
+    [this](const ModelLoader::Request & request)
+    {
+      QString status = QString("Loading %1 : %2").arg(request.file()->fullname()).arg(ModelLoader::stageName(request.stage()));
+      if (request.nbFiles())
+        status += QString(" (%1/%2 files)").arg(request.nbFilesRead()).arg(request.nbFiles());
+      SetStatusText(status.toStdWString());
+    });
+}
+
+void ModelViewer::DisplayModel(GameFile * file, WoWModel * model)
+{
   isModel = true;
 
   // check if this is a character model
@@ -969,7 +966,7 @@ void ModelViewer::LoadModel(GameFile * file)
 
   if (isChar)
   {
-    modelAtt = canvas->LoadCharModel(file);
+    modelAtt = canvas->LoadCharModel(model);
     // error check
     if (!modelAtt)
     {
@@ -998,7 +995,7 @@ void ModelViewer::LoadModel(GameFile * file)
   }
   else
   {
-    modelAtt = canvas->LoadCharModel(file); //  change it from LoadModel, don't sure it's right or not.
+    modelAtt = canvas->LoadCharModel(model); //  change it from LoadModel, don't sure it's right or not.
 
     // error check
     if (!modelAtt)
@@ -1151,12 +1148,10 @@ void ModelViewer::LoadNPC(unsigned int modelid)
       {
         static map<int, CharSlots> ItemTypeToInternal = { { 0, CS_HEAD }, { 1, CS_SHOULDER }, { 2, CS_SHIRT }, { 3, CS_CHEST }, { 4, CS_BELT }, { 5, CS_PANTS },
         { 6, CS_BOOTS }, { 7, CS_BRACERS }, { 8, CS_GLOVES }, { 9, CS_TABARD }, { 10, CS_CAPE } };
+        OutfitLoader outfit(g_charControl->model);
         for (uint i = 0; i < r.values.size(); i++)
-        {
-          WoWItem * item = g_charControl->model->getItem(ItemTypeToInternal[r.values[i][1].toInt()]);
-          if (item)
-            item->setDisplayId(r.values[i][0].toInt());
-        }
+          outfit.setDisplay(ItemTypeToInternal[r.values[i][1].toInt()], r.values[i][0].toInt());
+        outfit.apply();
       }
 
       g_charControl->model->cd.isNPC = true;
@@ -1946,7 +1941,7 @@ void ModelViewer::OnSave(wxCommandEvent &event)
       return;
     }
 
-    wxFileDialog dialog(this, wxT("Save AVI"), dir.GetPath(wxPATH_GET_VOLUME), wxT("animation.avi"), wxT("animation (*.avi)|*.avi"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT, wxDefaultPosition);
+    wxFileDialog dialog(this, wxT("Save AVI"), dir.GetPath(wxPATH_GET_VOLUME), wxT("animation.avi"), wxT("AVI animation (*.avi)|*.avi|YUV4MPEG2 animation (*.y4m)|*.y4m|PNG sequence (*.png)|*.png"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT, wxDefaultPosition);
 
     if (dialog.ShowModal() == wxID_OK) {
       animExporter->CreateAvi(dialog.GetPath());
@@ -2159,13 +2154,13 @@ void ModelViewer::LoadChar(QString fn, bool equipmentOnly /* = false */)
       CharSlots legacySlots[15] = { CS_HEAD, NUM_CHAR_SLOTS, CS_SHOULDER, CS_BOOTS, CS_BELT, CS_SHIRT, CS_PANTS, CS_CHEST, CS_BRACERS, CS_GLOVES, CS_HAND_RIGHT,
         CS_HAND_LEFT, CS_CAPE, CS_TABARD, NUM_CHAR_SLOTS };
 
+      OutfitLoader outfit(charControl->model);
       for (unsigned int i = 0; i < 15 && lineIndex < values.size(); i++, lineIndex++)
       {
         LOG_INFO << "item" << i << "=>" << values[lineIndex].toInt();
-        WoWItem * item = charControl->model->getItem(legacySlots[i]);
-        if (item)
-          item->setId(values[lineIndex].toInt());
+        outfit.setItem(legacySlots[i], values[lineIndex].toInt());
       }
+      outfit.apply();
 
       // read tabard customization (if needed)
       if (lineIndex < values.size())
@@ -2502,12 +2497,10 @@ void ModelViewer::ImportArmoury(wxString strURL)
       g_charControl->model->td.Background = result->Background;
     }
 
+    OutfitLoader outfit(g_charControl->model);
     for (unsigned int i = 0; i < NUM_CHAR_SLOTS; i++)
-    {
-      WoWItem * item = g_charControl->model->getItem((CharSlots)i);
-      if (item)
-        item->setId(result->equipment[i]);
-    }
+      outfit.setItem((CharSlots)i, result->equipment[i]);
+    outfit.apply();
 
     g_charControl->RefreshModel();
     g_charControl->RefreshEquipment();
@@ -97,6 +97,9 @@ public:
 	void SaveChar(QString fn, bool equipmentOnly = false);
 
 	void LoadModel(GameFile * f);
+	// loads model in background (see ModelLoader), onLoaded being called once model is displayed
+	void LoadModelInBackground(GameFile * f, std::function<void()> onLoaded = std::function<void()>());
+	void DisplayModel(GameFile * f, WoWModel * model);
 	void LoadItem(unsigned int displayID);
 	void LoadNPC(unsigned int modelid);
 